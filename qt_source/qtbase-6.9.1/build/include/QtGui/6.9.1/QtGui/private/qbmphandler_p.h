@@ -100,6 +100,9 @@ private:
     BMP_FILEHDR fileHeader;
     BMP_INFOHDR infoHeader;
     qint64 startpos;
+    bool memoryMapping;
+    QRect clipRect;
+    QSize scaledSize;
 };
 
 QT_END_NAMESPACE
@@ -44,7 +44,8 @@ public:
         InputOpaque = 1,
         InputPremultiplied = 2,
         OutputPremultiplied = 4,
-        Premultiplied = (InputPremultiplied | OutputPremultiplied)
+        Premultiplied = (InputPremultiplied | OutputPremultiplied),
+        AllowLut3D = 8
     };
     Q_DECLARE_FLAGS(TransformFlags, TransformFlag)
 
@@ -54,7 +55,16 @@ public:
     template<typename D, typename S>
     void apply(D *dst, const S *src, qsizetype count, TransformFlags flags) const;
 
+    // Number of nodes per axis of the 3D lookup table; see AllowLut3D.
+    static constexpr int Lut3DSize = 33;
+
+    mutable QAtomicInt lut3dGenerated;
+    mutable QList<quint16> lut3d; // planar red, green and blue nodes
+
 private:
+    bool canUseLut3D() const;
+    void updateLut3D() const;
+    void applyLut3D(QRgb *dst, const QRgb *src, qsizetype count, TransformFlags flags) const;
     void pcsAdapt(QColorVector *buffer, qsizetype len) const;
     template<typename S>
     void applyConvertIn(const S *src, QColorVector *buffer, qsizetype len, TransformFlags flags) const;
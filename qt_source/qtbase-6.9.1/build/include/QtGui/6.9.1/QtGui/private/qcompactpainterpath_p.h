@@ -0,0 +1,119 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QCOMPACTPAINTERPATH_P_H
+#define QCOMPACTPAINTERPATH_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qpainterpath.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qshareddata.h>
+
+QT_BEGIN_NAMESPACE
+
+class QPainter;
+
+class QCompactPainterPathChunk : public QSharedData
+{
+public:
+    QList<float> coordinates;       // x and y of every element
+    QList<quint8> types;            // QPainterPath::ElementType of every element
+};
+
+class QCompactPainterPathPrivate : public QSharedData
+{
+public:
+    struct Segment
+    {
+        QExplicitlySharedDataPointer<QCompactPainterPathChunk> chunk;
+        qsizetype begin;
+        qsizetype count;
+    };
+
+    QList<Segment> segments;
+    qsizetype elementCount = 0;
+    float startX = 0;
+    float startY = 0;
+    Qt::FillRule fillRule = Qt::OddEvenFill;
+    QRectF controlBounds;
+    bool dirtyControlBounds = false;
+    bool requireMoveTo = false;
+};
+
+class Q_GUI_EXPORT QCompactPainterPath
+{
+public:
+    QCompactPainterPath();
+    explicit QCompactPainterPath(const QPainterPath &path);
+    QCompactPainterPath(const QCompactPainterPath &other);
+    QCompactPainterPath &operator=(const QCompactPainterPath &other);
+    QCompactPainterPath(QCompactPainterPath &&other) noexcept = default;
+    QCompactPainterPath &operator=(QCompactPainterPath &&other) noexcept = default;
+    ~QCompactPainterPath();
+
+    bool isEmpty() const { return d->elementCount == 0; }
+    qsizetype elementCount() const { return d->elementCount; }
+    QPainterPath::Element elementAt(qsizetype i) const;
+    QPointF currentPosition() const;
+
+    Qt::FillRule fillRule() const { return d->fillRule; }
+    void setFillRule(Qt::FillRule fillRule);
+
+    void moveTo(const QPointF &p);
+    void lineTo(const QPointF &p);
+    void quadTo(const QPointF &c, const QPointF &endPoint);
+    void cubicTo(const QPointF &c1, const QPointF &c2, const QPointF &endPoint);
+    void closeSubpath();
+
+    void addRect(const QRectF &rect);
+    void addPath(const QCompactPainterPath &other);
+
+    QRectF controlPointRect() const;
+    qsizetype memoryUsage() const;
+
+    QPainterPath toPainterPath() const;
+
+    /*
+        Calls \a func with a pointer to the coordinates, a pointer to the
+        element types and the element count of every contiguous run of
+        elements, in order.
+    */
+    template <typename Func>
+    void forEachRun(Func func) const
+    {
+        for (const QCompactPainterPathPrivate::Segment &segment : d->segments) {
+            func(segment.chunk->coordinates.constData() + 2 * segment.begin,
+                 segment.chunk->types.constData() + segment.begin, segment.count);
+        }
+    }
+
+private:
+    void append(float x, float y, QPainterPath::ElementType type);
+    void removeLastElement();
+    void ensureStart();
+    void maybeMoveTo();
+    bool isClosed() const;
+    QPainterPath::ElementType lastElementType() const;
+
+    QSharedDataPointer<QCompactPainterPathPrivate> d;
+};
+
+Q_DECLARE_TYPEINFO(QCompactPainterPathPrivate::Segment, Q_RELOCATABLE_TYPE);
+
+Q_GUI_EXPORT void qt_draw_compact_path(QPainter *painter, const QCompactPainterPath &path);
+
+QT_END_NAMESPACE
+
+#endif // QCOMPACTPAINTERPATH_P_H
@@ -69,12 +69,15 @@ public:
           patternOffset(0),
           current_span(0),
           lastDir(NoDirection),
-          lastAxisAligned(false)
+          lastAxisAligned(false),
+          fastHairlines(false)
     { setup(); }
 
     ~QCosmeticStroker() { free(pattern); free(reversePattern); }
 
     void drawLine(const QPointF &p1, const QPointF &p2);
+    void drawLines(const QLine *lines, int num);
+    void drawLines(const QLineF *lines, int num);
     void drawPath(const QVectorPath &path);
     void drawPoints(const QPoint *points, int num);
     void drawPoints(const QPointF *points, int num);
@@ -110,10 +113,16 @@ public:
     Direction lastDir;
     Point lastPixel;
     bool lastAxisAligned;
+    bool fastHairlines;
 
 private:
     void setup();
 
+    template <typename Line>
+    void drawLinesImpl(const Line *lines, int num);
+    void drawMappedLine(const QPointF &start, const QPointF &end);
+    void fillAxisAlignedLine(qreal rx1, qreal ry1, qreal rx2, qreal ry2);
+
     void renderCubic(const QPointF &p1, const QPointF &p2, const QPointF &p3, const QPointF &p4, int caps);
     void renderCubicSubdivision(PointF *points, int level, int caps);
     // used for closed subpaths
@@ -223,6 +223,7 @@ private:
                      const QTransform &t) override;
     bool hasInternalCaching() const override { return cacheEnabled; }
     bool expectsGammaCorrectedBlending() const override;
+    RasterizationSettings rasterizationSettings(GlyphFormat neededFormat) const override;
 
     void removeGlyphFromCache(glyph_t glyph) override;
     int glyphMargin(QFontEngine::GlyphFormat /* format */) override { return 0; }
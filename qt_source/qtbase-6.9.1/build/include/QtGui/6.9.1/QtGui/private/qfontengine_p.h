@@ -103,6 +103,8 @@ public:
     virtual ~QFontEngine();
 
     inline Type type() const { return m_type; }
+    // Unique for the lifetime of the process, unlike the engine's address
+    inline quint64 cacheKey() const { return m_cacheKey; }
 
     // all of these are in unscaled metrics if the engine supports uncsaled metrics,
     // otherwise in design metrics
@@ -281,8 +283,38 @@ public:
         Subpixel_VBGR
     };
 
+    // The settings besides the font definition that decide the bitmaps
+    // glyphData() renders; format is the format it renders for the needed
+    // format passed in.
+    struct RasterizationSettings
+    {
+        GlyphFormat format = Format_None;
+        HintStyle hintStyle = HintNone;
+        SubpixelAntialiasingType subpixelType = Subpixel_None;
+        int lcdFilter = 0;
+        int loadFlags = 0;
+        bool antialias = true;
+        bool embeddedBitmaps = false;
+        bool gammaCorrected = false;
+
+        friend bool operator==(const RasterizationSettings &a, const RasterizationSettings &b) noexcept
+        {
+            return a.format == b.format && a.hintStyle == b.hintStyle
+                && a.subpixelType == b.subpixelType && a.lcdFilter == b.lcdFilter
+                && a.loadFlags == b.loadFlags && a.antialias == b.antialias
+                && a.embeddedBitmaps == b.embeddedBitmaps
+                && a.gammaCorrected == b.gammaCorrected;
+        }
+        friend bool operator!=(const RasterizationSettings &a, const RasterizationSettings &b) noexcept
+        {
+            return !(a == b);
+        }
+    };
+    virtual RasterizationSettings rasterizationSettings(GlyphFormat neededFormat) const;
+
 private:
     const Type m_type;
+    const quint64 m_cacheKey;
 
 public:
     QAtomicInt ref;
@@ -348,6 +380,19 @@ public:
     GlyphFormat glyphFormat;
     int m_subPixelPositionCount; // Number of positions within a single pixel for this cache
 
+    // The QSharedGlyphCache font id last resolved for this engine, together
+    // with the settings and the transform it was resolved for.
+    struct SharedGlyphCacheFont
+    {
+        int id = -1;
+        bool resolved = false;
+        RasterizationSettings settings;
+        qreal m11 = 0;
+        qreal m12 = 0;
+        qreal m21 = 0;
+        qreal m22 = 0;
+    } sharedGlyphCacheFont;
+
 protected:
     explicit QFontEngine(Type type);
 
@@ -571,6 +571,9 @@ inline QImage::Format qt_alphaVersionForPainting(QImage::Format format)
 Q_GUI_EXPORT QMap<QString, QString> qt_getImageText(const QImage &image, const QString &description);
 Q_GUI_EXPORT QMap<QString, QString> qt_getImageTextFromDescription(const QString &description);
 
+Q_GUI_EXPORT QImage qt_mapImage(QIODevice *device, qint64 offset, const QSize &size,
+                                qsizetype bytesPerLine, QImage::Format format);
+
 QT_END_NAMESPACE
 
 #endif // QIMAGE_P_H
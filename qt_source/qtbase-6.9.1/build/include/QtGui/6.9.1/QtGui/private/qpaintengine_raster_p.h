@@ -134,6 +134,7 @@ public:
 
     void fillRect(const QRectF &rect, const QBrush &brush) override;
     void fillRect(const QRectF &rect, const QColor &color) override;
+    void fillRectBatch(const QRectF *rects, int rectCount, const QColor *colors, int colorCount) override;
 
     void drawRects(const QRect  *rects, int rectCount) override;
     void drawRects(const QRectF *rects, int rectCount) override;
@@ -171,6 +172,9 @@ public:
     ClipType clipType() const;
     QRectF clipBoundingRect() const;
 
+    quint64 culledPrimitiveCount() const;
+    void resetCulledPrimitiveCount();
+
 #ifdef Q_OS_WIN
     void setDC(HDC hdc);
     HDC getDC() const;
@@ -218,6 +222,13 @@ private:
     void updateOutlineMapper();
     inline void ensureOutlineMapper();
 
+    template <typename Point>
+    bool collapseSubPixelPolygon(const Point *points, int pointCount, PolygonDrawMode mode);
+
+    bool useDistanceFieldText(QFontEngine *fontEngine, const QTransform &m) const;
+    void drawDistanceFieldGlyphs(int numGlyphs, const glyph_t *glyphs, const QFixedPoint *positions,
+                                 QFontEngine *fontEngine);
+
     void updateRasterState();
     inline void ensureRasterState() {
         if (state()->dirty)
@@ -239,6 +250,7 @@ public:
                               int *dashIndex, qreal *dashOffset, bool *inDash);
     void rasterize(QT_FT_Outline *outline, ProcessSpans callback, QSpanData *spanData, QRasterBuffer *rasterBuffer);
     void rasterize(QT_FT_Outline *outline, ProcessSpans callback, void *userData, QRasterBuffer *rasterBuffer);
+    bool rasterizeBands(QT_FT_Outline *outline, ProcessSpans callback, QSpanData *spanData);
     void updateMatrixData(QSpanData *spanData, const QBrush &brush, const QTransform &brushMatrix);
     void updateClipping();
 
@@ -268,6 +280,9 @@ public:
 
     void initializeRasterizer(QSpanData *data);
 
+    bool collapseSubPixelPrimitive(const QRectF &deviceBounds, QSpanData *data);
+    QRectF strokeDeviceBounds(const QRectF &bounds, const QPen &pen) const;
+
     void recalculateFastImages();
     bool canUseFastImageBlending(QPainter::CompositionMode mode, const QImage &image) const;
     bool canUseImageBlitting(QPainter::CompositionMode mode, const QImage &image, const QPointF &pt, const QRectF &sr) const;
@@ -303,6 +318,8 @@ public:
     uint mono_surface : 1;
     uint outlinemapper_xform_dirty : 1;
 
+    quint64 culledPrimitives = 0;
+
     QScopedPointer<QRasterizer> rasterizer;
 };
 
@@ -0,0 +1,78 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPAINTENGINE_TILED_P_H
+#define QPAINTENGINE_TILED_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qpaintdevice.h>
+#include "private/qpaintrecording_p.h"
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QTiledRasterPaintEngine;
+class QTiledRasterPaintEnginePrivate;
+
+class Q_GUI_EXPORT QTiledRasterPaintDevice : public QPaintDevice
+{
+public:
+    explicit QTiledRasterPaintDevice(QImage *target);
+    ~QTiledRasterPaintDevice() override;
+
+    QImage *target() const { return m_target; }
+
+    void setTileCount(int count);
+    int tileCount() const { return m_tileCount; }
+
+    QPaintEngine *paintEngine() const override;
+
+protected:
+    int metric(PaintDeviceMetric metric) const override;
+
+private:
+    Q_DISABLE_COPY(QTiledRasterPaintDevice)
+
+    QImage *m_target;
+    int m_tileCount = 0;
+    mutable std::unique_ptr<QTiledRasterPaintEngine> m_engine;
+};
+
+class Q_GUI_EXPORT QTiledRasterPaintEngine : public QRecordingPaintEngine
+{
+    Q_DECLARE_PRIVATE(QTiledRasterPaintEngine)
+public:
+    QTiledRasterPaintEngine();
+    ~QTiledRasterPaintEngine() override;
+
+    bool begin(QPaintDevice *device) override;
+    bool end() override;
+
+    void flush();
+
+    void drawTextItem(const QPointF &p, const QTextItem &textItem) override;
+    void drawStaticTextItem(QStaticTextItem *textItem) override;
+
+    bool requiresPretransformedGlyphPositions(QFontEngine *fontEngine, const QTransform &m) const override;
+    bool shouldDrawCachedGlyphs(QFontEngine *fontEngine, const QTransform &m) const override;
+
+protected:
+    void recordingFull() override;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPAINTENGINE_TILED_P_H
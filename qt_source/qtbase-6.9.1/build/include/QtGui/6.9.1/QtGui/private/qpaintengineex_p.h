@@ -64,6 +64,7 @@ public:
 
     virtual void fillRect(const QRectF &rect, const QBrush &brush);
     virtual void fillRect(const QRectF &rect, const QColor &color);
+    virtual void fillRectBatch(const QRectF *rects, int rectCount, const QColor *colors, int colorCount);
 
     virtual void drawRoundedRect(const QRectF &rect, qreal xrad, qreal yrad, Qt::SizeMode mode);
 
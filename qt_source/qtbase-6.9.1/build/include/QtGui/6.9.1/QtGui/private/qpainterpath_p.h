@@ -29,6 +29,7 @@
 
 QT_BEGIN_NAMESPACE
 
+class QCompactPainterPath;
 class QPolygonF;
 class QVectorPathConverter;
 
@@ -40,6 +41,7 @@ public:
           path(pathData.points.data(), path.size(), pathData.elements.data(), pathData.flags)
     {
     }
+    explicit QVectorPathConverter(const QCompactPainterPath &path);
 
     const QVectorPath &vectorPath() {
         return path;
@@ -79,6 +81,8 @@ public:
             }
 
         }
+        explicit QVectorPathData(const QCompactPainterPath &path);
+
         QVarLengthArray<QPainterPath::ElementType> elements;
         QVarLengthArray<qreal> points;
         uint flags;
@@ -60,6 +60,9 @@ private:
     bool handleCrossingEdges(QWingedEdge &list, qreal y, ClipperMode mode);
     bool doClip(QWingedEdge &list, ClipperMode mode);
 
+    static bool isRectilinear(const QPainterPath &path);
+    QPainterPath clipRectilinear();
+
     QPainterPath subjectPath;
     QPainterPath clipPath;
     Operation op;
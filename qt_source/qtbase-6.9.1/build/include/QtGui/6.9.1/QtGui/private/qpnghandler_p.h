@@ -17,6 +17,8 @@
 
 #include <QtGui/private/qtguiglobal_p.h>
 #include "QtGui/qimageiohandler.h"
+#include <QtGui/qcolorspace.h>
+#include <QtGui/qimage.h>
 
 #ifndef QT_NO_IMAGEFORMAT_PNG
 
@@ -43,6 +45,33 @@ private:
     QPngHandlerPrivate *d;
 };
 
+class QPngBandWriterPrivate;
+class Q_GUI_EXPORT QPngBandWriter
+{
+public:
+    explicit QPngBandWriter(QIODevice *device);
+    ~QPngBandWriter();
+
+    void setCompression(int compression);
+    int compression() const;
+
+    void setDescription(const QString &description);
+    QString description() const;
+
+    bool begin(const QSize &size, QImage::Format format,
+               const QColorSpace &colorSpace = QColorSpace());
+    bool writeBand(const QImage &band);
+    bool end();
+
+    int rowsWritten() const;
+    bool hasError() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QPngBandWriter)
+
+    QPngBandWriterPrivate *d;
+};
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_IMAGEFORMAT_PNG
@@ -0,0 +1,172 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSHAREDGLYPHCACHE_P_H
+#define QSHAREDGLYPHCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qreadwritelock.h>
+#include <QtCore/qshareddata.h>
+#include "private/qfixed_p.h"
+#include "private/qfontengine_p.h"
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QTransform;
+
+class Q_GUI_EXPORT QSharedGlyphCache
+{
+public:
+    // A rendered glyph, laid out like QFontEngine::Glyph.
+    class Glyph : public QSharedData
+    {
+    public:
+        short x = 0;
+        short y = 0;
+        unsigned short width = 0;
+        unsigned short height = 0;
+        short advance = 0;
+        signed char format = 0;
+        std::unique_ptr<uchar[]> data;
+        qsizetype cost = 0;
+        mutable QAtomicInteger<quint32> lastUse;
+    };
+    using GlyphPointer = QExplicitlySharedDataPointer<const Glyph>;
+
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 insertions = 0;
+        quint64 evictions = 0;
+        qsizetype glyphCount = 0;
+        qsizetype cost = 0;
+    };
+
+    QSharedGlyphCache();
+    ~QSharedGlyphCache();
+
+    static QSharedGlyphCache *instance();
+
+    int fontId(QFontEngine *fontEngine, QFontEngine::GlyphFormat format, const QTransform &matrix);
+
+    GlyphPointer find(int fontId, glyph_t glyph, const QFixedPoint &subPixelPosition);
+    GlyphPointer insert(int fontId, glyph_t glyph, const QFixedPoint &subPixelPosition,
+                        const QFontEngine::Glyph &rendered);
+
+    void setMaximumCost(qsizetype bytes);
+    qsizetype maximumCost() const;
+
+    Statistics statistics() const;
+    void clear();
+
+    static int bytesPerLine(const QFontEngine::Glyph &glyph);
+
+private:
+    Q_DISABLE_COPY_MOVE(QSharedGlyphCache)
+
+    enum {
+        ShardCount = 16,
+        MaximumFontIds = 1024
+    };
+
+    struct Key
+    {
+        int fontId;
+        glyph_t glyph;
+        int subPixelX;
+        int subPixelY;
+
+        friend bool operator==(const Key &a, const Key &b) noexcept
+        {
+            return a.fontId == b.fontId && a.glyph == b.glyph
+                && a.subPixelX == b.subPixelX && a.subPixelY == b.subPixelY;
+        }
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.fontId, key.glyph, key.subPixelX, key.subPixelY);
+        }
+    };
+
+    struct alignas(64) Shard
+    {
+        mutable QReadWriteLock lock;
+        QHash<Key, GlyphPointer> glyphs;
+        qsizetype cost = 0;
+        quint32 clock = 0;          // advanced by insertions
+        QAtomicInteger<quint64> hits;
+        QAtomicInteger<quint64> misses;
+        QAtomicInteger<quint64> insertions;
+        QAtomicInteger<quint64> evictions;
+    };
+
+    struct FontKey
+    {
+        QFontEngine::FaceId faceId;
+        int type;
+        int synthesized;
+        QFontEngine::RasterizationSettings settings;
+        qreal pixelSize;
+        uint weight;
+        uint style;
+        uint stretch;
+        uint styleStrategy;
+        uint hintingPreference;
+        qreal m11;
+        qreal m12;
+        qreal m21;
+        qreal m22;
+
+        friend bool operator==(const FontKey &a, const FontKey &b) noexcept
+        {
+            return a.faceId == b.faceId && a.type == b.type && a.synthesized == b.synthesized
+                && a.settings == b.settings && a.pixelSize == b.pixelSize && a.weight == b.weight
+                && a.style == b.style && a.stretch == b.stretch
+                && a.styleStrategy == b.styleStrategy
+                && a.hintingPreference == b.hintingPreference
+                && a.m11 == b.m11 && a.m12 == b.m12 && a.m21 == b.m21 && a.m22 == b.m22;
+        }
+        friend size_t qHash(const FontKey &key, size_t seed = 0)
+        {
+            const QFontEngine::RasterizationSettings &s = key.settings;
+            seed = qHashMulti(seed, key.faceId, key.type, key.synthesized, key.pixelSize,
+                              key.weight, key.style, key.stretch);
+            seed = qHashMulti(seed, int(s.format), int(s.hintStyle), int(s.subpixelType),
+                              s.lcdFilter, s.loadFlags, s.antialias, s.embeddedBitmaps,
+                              s.gammaCorrected);
+            return qHashMulti(seed, key.styleStrategy, key.hintingPreference,
+                              key.m11, key.m12, key.m21, key.m22);
+        }
+    };
+
+    Shard &shardFor(const Key &key) { return m_shards[qHash(key) % ShardCount]; }
+    void evict(Shard &shard);
+    int resolveFontId(QFontEngine *fontEngine, const QFontEngine::RasterizationSettings &settings,
+                      const QTransform &matrix);
+
+    Shard m_shards[ShardCount];
+    QAtomicInteger<qsizetype> m_maximumCost;
+
+    mutable QReadWriteLock m_fontLock;
+    QHash<FontKey, int> m_fontIds;
+    int m_nextFontId = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSHAREDGLYPHCACHE_P_H
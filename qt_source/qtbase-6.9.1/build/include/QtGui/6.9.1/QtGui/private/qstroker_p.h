@@ -184,6 +184,12 @@ public:
     Qt::PenCapStyle capStyle() const { return capForJoinMode(m_capStyle); }
     LineJoinMode capStyleMode() const { return m_capStyle; }
 
+    // Gives the start or the end of every subpath a flat cap regardless of
+    // the cap style, for subpaths that are stroked in pieces.
+    void setFlatEnds(bool start, bool end) { m_flatStart = start; m_flatEnd = end; }
+    LineJoinMode startCapStyleMode() const { return m_flatStart ? FlatJoin : m_capStyle; }
+    LineJoinMode endCapStyleMode() const { return m_flatEnd ? FlatJoin : m_capStyle; }
+
     void setJoinStyle(Qt::PenJoinStyle style) { m_joinStyle = joinModeForJoin(style); }
     Qt::PenJoinStyle joinStyle() const { return joinForJoinMode(m_joinStyle); }
     LineJoinMode joinStyleMode() const { return m_joinStyle; }
@@ -221,6 +227,8 @@ protected:
     qfixed m_back2Y;
 
     bool m_forceOpen;
+    bool m_flatStart;
+    bool m_flatEnd;
 };
 
 class Q_GUI_EXPORT QDashStroker : public QStrokerOps
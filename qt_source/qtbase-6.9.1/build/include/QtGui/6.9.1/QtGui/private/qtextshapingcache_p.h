@@ -0,0 +1,130 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QTEXTSHAPINGCACHE_P_H
+#define QTEXTSHAPINGCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtGui/qfont.h>
+#include "private/qfixed_p.h"
+#include "private/qtextengine_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class Q_GUI_EXPORT QTextShapingCache
+{
+public:
+    // Longer items are always shaped.
+    enum { MaximumLength = 64 };
+
+    struct Key
+    {
+        quint64 fontEngine = 0;         // QFontEngine::cacheKey()
+        QString text;
+        QScriptAnalysis analysis = {};
+        bool kerning = false;
+        bool shaping = false;
+        bool letterSpacingIsAbsolute = false;
+        bool designMetrics = false;
+        bool showDefaultIgnorables = false;
+        QFixed letterSpacing;
+        QFixed wordSpacing;
+        QHash<QFont::Tag, quint32> features;
+        size_t featuresHash = 0;
+
+        friend bool operator==(const Key &a, const Key &b) noexcept
+        {
+            return a.fontEngine == b.fontEngine && a.analysis == b.analysis
+                && a.kerning == b.kerning && a.shaping == b.shaping
+                && a.letterSpacingIsAbsolute == b.letterSpacingIsAbsolute
+                && a.designMetrics == b.designMetrics
+                && a.showDefaultIgnorables == b.showDefaultIgnorables
+                && a.letterSpacing == b.letterSpacing && a.wordSpacing == b.wordSpacing
+                && a.featuresHash == b.featuresHash && a.text == b.text
+                && a.features == b.features;
+        }
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        {
+            seed = qHashMulti(seed, key.fontEngine, key.text, uint(key.analysis.script),
+                              uint(key.analysis.flags), uint(key.analysis.bidiLevel),
+                              key.featuresHash);
+            return qHashMulti(seed, key.kerning, key.shaping, key.letterSpacingIsAbsolute,
+                              key.designMetrics, key.showDefaultIgnorables,
+                              key.letterSpacing.value(), key.wordSpacing.value());
+        }
+    };
+
+    // The outcome of QTextEngine::shapeText() for one item.
+    struct Entry
+    {
+        QByteArray glyphData;           // QGlyphLayout storage for numGlyphs glyphs
+        QList<ushort> logClusters;      // one per character of the key
+        int numGlyphs = 0;
+        QFixed width;
+        QFixed ascent;
+        QFixed descent;
+        QFixed leading;
+        qsizetype cost = 0;
+        quint32 lastUse = 0;
+
+        QGlyphLayout glyphs() const
+        { return QGlyphLayout(const_cast<char *>(glyphData.constData()), numGlyphs); }
+    };
+
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 insertions = 0;
+        quint64 evictions = 0;
+        qsizetype entryCount = 0;
+        qsizetype cost = 0;
+    };
+
+    QTextShapingCache();
+    ~QTextShapingCache();
+
+    static QTextShapingCache *instance();
+    static void clearForCurrentThread();
+
+    static size_t featuresHash(const QHash<QFont::Tag, quint32> &features);
+
+    const Entry *find(const Key &key);
+    void insert(const Key &key, const QGlyphLayout &glyphs, const ushort *logClusters,
+                QFixed width, QFixed ascent, QFixed descent, QFixed leading);
+    void clear();
+
+    static void setMaximumCost(qsizetype bytes);
+    static qsizetype maximumCost();
+
+    static Statistics statistics();
+
+private:
+    Q_DISABLE_COPY_MOVE(QTextShapingCache)
+
+    void evict();
+    void remove(QHash<Key, Entry>::iterator it);
+
+    QHash<Key, Entry> m_entries;
+    qsizetype m_cost = 0;
+    quint32 m_clock = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QTEXTSHAPINGCACHE_P_H
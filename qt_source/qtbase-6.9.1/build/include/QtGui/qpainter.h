@@ -9,6 +9,7 @@
 #include <QtCore/qrect.h>
 #include <QtCore/qpoint.h>
 #include <QtCore/qscopedpointer.h>
+#include <QtCore/qspan.h>
 #include <QtGui/qpixmap.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qtextoption.h>
@@ -54,7 +55,9 @@ public:
         SmoothPixmapTransform = 0x04,
         VerticalSubpixelPositioning = 0x08,
         LosslessImageRendering = 0x40,
-        NonCosmeticBrushPatterns = 0x80
+        NonCosmeticBrushPatterns = 0x80,
+        CollapseSubPixelPrimitives = 0x100,
+        DistanceFieldText = 0x200
     };
     Q_ENUM(RenderHint)
 
@@ -353,6 +356,8 @@ public:
 
 #if !defined(QT_NO_RAWFONT)
     void drawGlyphRun(const QPointF &position, const QGlyphRun &glyphRun);
+    void drawGlyphRunBatch(QSpan<const QPointF> positions, QSpan<const QGlyphRun> glyphRuns,
+                           QSpan<const QColor> colors = {});
 #endif
 
     void drawStaticText(const QPointF &topLeftPosition, const QStaticText &staticText);
@@ -360,6 +365,8 @@ public:
     inline void drawStaticText(int left, int top, const QStaticText &staticText);
 
     void drawText(const QPointF &p, const QString &s);
+    void drawTextBatch(QSpan<const QPointF> positions, QSpan<const QString> texts,
+                       QSpan<const QColor> colors = {});
     inline void drawText(const QPoint &p, const QString &s);
     inline void drawText(int x, int y, const QString &s);
 
@@ -401,6 +408,8 @@ public:
     inline void fillRect(const QRect &r, QGradient::Preset preset);
     inline void fillRect(const QRectF &r, QGradient::Preset preset);
 
+    void drawRectBatch(QSpan<const QRectF> rects, QSpan<const QColor> colors);
+
     void eraseRect(const QRectF &);
     inline void eraseRect(int x, int y, int w, int h);
     inline void eraseRect(const QRect &);
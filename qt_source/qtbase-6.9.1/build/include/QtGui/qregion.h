@@ -76,6 +76,7 @@ public:
     QRect boundingRect() const noexcept;
     void setRects(const QRect *rect, int num);
     void setRects(QSpan<const QRect> r);
+    [[nodiscard]] static QRegion fromRects(QSpan<const QRect> rects);
     QSpan<const QRect> rects() const noexcept;
     int rectCount() const noexcept;
 
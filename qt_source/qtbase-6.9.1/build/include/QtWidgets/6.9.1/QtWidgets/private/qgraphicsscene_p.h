@@ -209,6 +209,31 @@ public:
     void draw(QGraphicsItem *, QPainter *, const QTransform *const, const QTransform *const,
               QRegion *, QWidget *, qreal, const QTransform *const, bool, bool);
 
+    // Items with ItemHasThreadSafePaint that are painted on a thread pool
+    // when the next item that has to be painted directly is reached. Only
+    // the members of the style option that initStyleOption() sets per item
+    // are kept.
+    struct DeferredPaint
+    {
+        QGraphicsItem *item;
+        QTransform transform;
+        qreal opacity;
+        QRect viewBoundingRect;
+        QStyle::State state;
+        QRect rect;
+        QRectF exposedRect;
+        QObject *styleObject;
+    };
+    QList<DeferredPaint> deferredPaints;
+    QPainter *deferredPaintPainter = nullptr;
+    QRegion *deferredPaintExposedRegion = nullptr;
+    QWidget *deferredPaintWidget = nullptr;
+    void flushDeferredPaints();
+
+    // Nesting depth of beginTransaction(); see
+    // QGraphicsItemPrivate::pendingTransactionGeometry.
+    int transactionDepth = 0;
+
     void markDirty(QGraphicsItem *item, const QRectF &rect = QRectF(), bool invalidateChildren = false,
                    bool force = false, bool ignoreOpacity = false, bool removingItemFromScene = false,
                    bool updateBoundingRect = false);
@@ -221,6 +246,7 @@ public:
         item->d_ptr->dirty = 0;
         item->d_ptr->paintedViewBoundingRectsNeedRepaint = 0;
         item->d_ptr->geometryChanged = 0;
+        item->d_ptr->pendingTransactionGeometry = 0;
         if (!item->d_ptr->dirtyChildren)
             recursive = false;
         item->d_ptr->dirtyChildren = 0;
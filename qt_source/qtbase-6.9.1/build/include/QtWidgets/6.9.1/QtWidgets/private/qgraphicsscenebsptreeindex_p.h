@@ -22,6 +22,7 @@
 #include "qgraphicsscene_bsp_p.h"
 
 #include <QtCore/qbasictimer.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qrect.h>
 #include <QtCore/qlist.h>
 
@@ -59,6 +60,8 @@ protected:
     void addItem(QGraphicsItem *item) override;
     void removeItem(QGraphicsItem *item) override;
     void prepareBoundingRectChange(const QGraphicsItem *item) override;
+    void beginTransaction() override;
+    void endTransaction() override;
 
     void itemChange(const QGraphicsItem *item, QGraphicsItem::GraphicsItemChange change, const void *const value) override;
 
@@ -95,6 +98,15 @@ public:
     QSet<QGraphicsItem *> removedItems;
     void purgeRemovedItems();
 
+    // Inside a scene transaction, moved items stay where they are in the
+    // tree. A few of them are remembered with the rect they were inserted
+    // with and reinserted afterwards; once there are more, the whole tree
+    // is regenerated instead.
+    bool inTransaction;
+    bool staleTree;
+    QHash<QGraphicsItem *, QRectF> movedItems;
+    void regenerateStaleTree();
+
     void _q_updateIndex();
     void startIndexTimer(int interval = QGRAPHICSSCENE_INDEXTIMER_TIMEOUT);
     void resetIndex();
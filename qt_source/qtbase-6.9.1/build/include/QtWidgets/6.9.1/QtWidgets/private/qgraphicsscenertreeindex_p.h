@@ -0,0 +1,92 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QGRAPHICSSCENERTREEINDEX_H
+#define QGRAPHICSSCENERTREEINDEX_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtWidgets/private/qtwidgetsglobal_p.h>
+
+#include "qgraphicssceneindex_p.h"
+#include "qgraphicsitem_p.h"
+
+#include <QtCore/qbasictimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qset.h>
+#include <QtGui/private/qrtree_p.h>
+
+QT_REQUIRE_CONFIG(graphicsview);
+
+QT_BEGIN_NAMESPACE
+
+class QGraphicsScene;
+class QGraphicsSceneRTreeIndexPrivate;
+
+class Q_AUTOTEST_EXPORT QGraphicsSceneRTreeIndex : public QGraphicsSceneIndex
+{
+    Q_OBJECT
+public:
+    QGraphicsSceneRTreeIndex(QGraphicsScene *scene = nullptr);
+    ~QGraphicsSceneRTreeIndex();
+
+    QList<QGraphicsItem *> estimateItems(const QRectF &rect, Qt::SortOrder order) const override;
+    QList<QGraphicsItem *> estimateTopLevelItems(const QRectF &rect, Qt::SortOrder order) const override;
+    QList<QGraphicsItem *> items(Qt::SortOrder order = Qt::DescendingOrder) const override;
+
+protected:
+    bool event(QEvent *event) override;
+    void clear() override;
+
+    void addItem(QGraphicsItem *item) override;
+    void removeItem(QGraphicsItem *item) override;
+    void prepareBoundingRectChange(const QGraphicsItem *item) override;
+
+    void itemChange(const QGraphicsItem *item, QGraphicsItem::GraphicsItemChange change, const void *const value) override;
+
+private:
+    Q_DECLARE_PRIVATE(QGraphicsSceneRTreeIndex)
+    Q_DISABLE_COPY_MOVE(QGraphicsSceneRTreeIndex)
+};
+
+class QGraphicsSceneRTreeIndexPrivate : public QGraphicsSceneIndexPrivate
+{
+    Q_DECLARE_PUBLIC(QGraphicsSceneRTreeIndex)
+public:
+    QGraphicsSceneRTreeIndexPrivate(QGraphicsScene *scene);
+
+    // Items in the tree keep their handle in QGraphicsItemPrivate::index.
+    QRTree<QGraphicsItem *> tree;
+    qsizetype removalsSinceBuild;
+    QBasicTimer indexTimer;
+
+    QSet<QGraphicsItem *> unindexedItems;       // added, bounding rect not known yet
+    QSet<QGraphicsItem *> movedItems;           // in the tree with a stale rect
+    QSet<QGraphicsItem *> untransformableItems;
+    QSet<QGraphicsItem *> clippedItems;         // found through their clipping ancestor
+
+    void updateIndex();
+    void rebuild(const QList<QGraphicsItem *> &newItems);
+    void startIndexTimer();
+    void resetItemIndexes();
+
+    void addItem(QGraphicsItem *item, bool recursive = false);
+    void removeItem(QGraphicsItem *item, bool recursive = false, bool moveToUnindexedItems = false);
+    QList<QGraphicsItem *> estimateItems(const QRectF &rect, Qt::SortOrder order, bool onlyTopLevelItems = false);
+
+    static void sortItems(QList<QGraphicsItem *> *itemList, Qt::SortOrder order, bool onlyTopLevelItems = false);
+};
+
+QT_END_NAMESPACE
+
+#endif // QGRAPHICSSCENERTREEINDEX_H
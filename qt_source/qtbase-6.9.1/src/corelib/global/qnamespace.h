@@ -507,7 +507,8 @@ namespace Qt {
         AvoidDither             = 0x00000080,
 
         NoOpaqueDetection       = 0x00000100,
-        NoFormatConversion      = 0x00000200
+        NoFormatConversion      = 0x00000200,
+        ApproximateColorTransform = 0x00000400
     };
     Q_DECLARE_FLAGS(ImageConversionFlags, ImageConversionFlag)
     Q_DECLARE_OPERATORS_FOR_FLAGS(ImageConversionFlags)
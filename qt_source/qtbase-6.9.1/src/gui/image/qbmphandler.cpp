@@ -9,6 +9,10 @@
 #include <qimage.h>
 #include <qlist.h>
 #include <qvariant.h>
+#include <private/qimage_p.h>
+#include <private/qimagedecimator_p.h>
+
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -583,6 +587,95 @@ static bool read_dib_body(QDataStream &s, const BMP_INFOHDR &bi, qint64 datapos,
     return true;
 }
 
+// Maps the pixel data of an uncompressed, top-down BMP file whose layout
+// matches a QImage format: 8-bit indexed and 24-bit images. 32-bit images are
+// not mapped: the pixel data follows a 54, 66, 122 or 138 byte header, which
+// never leaves it 32-bit aligned as QImage requires. Bottom-up files, the
+// common case, store their scanlines in reverse order and are always decoded.
+static bool map_dib_body(QIODevice *d, const BMP_INFOHDR &bi, qint64 datapos, qint64 startpos, QImage &image)
+{
+    if (bi.biHeight >= 0 || bi.biCompression != BMP_RGB || datapos < 0)
+        return false;
+
+    const int w = bi.biWidth;
+    const int h = -bi.biHeight;
+    const int nbits = bi.biBitCount;
+    QImage::Format format;
+    switch (nbits) {
+    case 8:
+        format = QImage::Format_Indexed8;
+        break;
+    case 24:
+        format = QImage::Format_BGR888;
+        break;
+    default:
+        return false;
+    }
+
+    QList<QRgb> colorTable;
+    if (nbits == 8) {
+        const int ncols = bi.biClrUsed ? bi.biClrUsed : 256;
+        if (ncols < 1 || ncols > 256 || !d->seek(startpos + bi.biSize))
+            return false;
+        const int rgb_len = bi.biSize == BMP_OLD ? 3 : 4;
+        colorTable.resize(ncols);
+        for (int i = 0; i < ncols; ++i) {
+            uchar rgb[4];
+            if (d->read((char *)rgb, rgb_len) != rgb_len)
+                return false;
+            colorTable[i] = qRgb(rgb[2], rgb[1], rgb[0]);
+        }
+    }
+
+    const qsizetype bpl = ((qsizetype(w) * nbits + 31) / 32) * 4;
+    QImage mapped = qt_mapImage(d, datapos, QSize(w, h), bpl, format);
+    if (mapped.isNull() || !d->seek(datapos + bpl * h))
+        return false;
+    if (!colorTable.isEmpty())
+        mapped.setColorTable(colorTable);
+    mapped.setDotsPerMeterX(bi.biXPelsPerMeter);
+    mapped.setDotsPerMeterY(bi.biYPelsPerMeter);
+    image = mapped;
+    return true;
+}
+
+// Decodes the rows of sourceRect of an uncompressed image into image, which
+// is scaled to targetSize. The rows are stored at known offsets, so only
+// the rows of the rectangle are read, a band at a time, each decoded as an
+// image of its own.
+static bool read_dib_region(QDataStream &s, const BMP_INFOHDR &bi, qint64 datapos, qint64 startpos,
+                            const QRect &sourceRect, const QSize &targetSize, QImage &image)
+{
+    const int w = bi.biWidth;
+    const int h = qAbs(bi.biHeight);
+    const bool topDown = bi.biHeight < 0;
+    const qsizetype bpl_bmp = ((qsizetype(w) * bi.biBitCount + 31) / 32) * 4;
+    const int bandHeight = int(qBound(qsizetype(1), (4 * 1024 * 1024) / (qsizetype(w) * 4),
+                                      qsizetype(sourceRect.height())));
+
+    std::unique_ptr<QImageDecimator> decimator;
+    for (int y = sourceRect.top(); y <= sourceRect.bottom(); y += bandHeight) {
+        const int n = qMin(bandHeight, sourceRect.bottom() + 1 - y);
+        BMP_INFOHDR band = bi;
+        band.biHeight = topDown ? -n : n;
+        const qint64 firstStoredRow = topDown ? y : h - (y + n);
+        QImage rows;
+        if (!read_dib_body(s, band, datapos + firstStoredRow * bpl_bmp, startpos, rows))
+            return false;
+        if (!decimator) {
+            if (!QImageIOHandler::allocateImage(targetSize, rows.format(), &image))
+                return false;
+            image.setColorTable(rows.colorTable());
+            image.setDotsPerMeterX(rows.dotsPerMeterX());
+            image.setDotsPerMeterY(rows.dotsPerMeterY());
+            decimator.reset(new QImageDecimator(&image, sourceRect));
+        }
+        for (int i = 0; i < n; ++i)
+            decimator->addRow(y + i, rows.constScanLine(i));
+    }
+    return decimator != nullptr;
+}
+
 bool qt_write_dib(QDataStream &s, const QImage &image, int bpl, int bpl_bmp, int nbits)
 {
     QIODevice* d = s.device();
@@ -670,7 +763,7 @@ bool qt_write_dib(QDataStream &s, const QImage &image, int bpl, int bpl_bmp, int
 }
 
 QBmpHandler::QBmpHandler(InternalFormat fmt) :
-    m_format(fmt), state(Ready)
+    m_format(fmt), state(Ready), memoryMapping(false)
 {
 }
 
@@ -774,10 +867,44 @@ bool QBmpHandler::read(QImage *image)
             }
         }
     }
-    const bool readSuccess = m_format == BmpFormat ?
-        read_dib_body(s, infoHeader, datapos, startpos + BMP_FILEHDR_SIZE, *image) :
-        read_dib_body(s, infoHeader, datapos, startpos, *image);
-    if (!readSuccess)
+    const qint64 infopos = m_format == BmpFormat ? startpos + BMP_FILEHDR_SIZE : startpos;
+    const QSize imageSize(infoHeader.biWidth, qAbs(infoHeader.biHeight));
+    const QRect sourceRect = QImageDecimator::sourceRect(imageSize, clipRect);
+    const QSize targetSize = QImageDecimator::targetSize(sourceRect, scaledSize);
+    const bool partial = sourceRect.size() != imageSize || targetSize != imageSize;
+
+    if (memoryMapping && m_format == BmpFormat
+        && map_dib_body(d, infoHeader, datapos, infopos, *image)) {
+        // Only the pages of the rectangle are touched.
+        if (partial)
+            *image = QImageDecimator::decimate(*image, sourceRect, targetSize);
+        state = Ready;
+        return !image->isNull();
+    }
+
+    if (partial) {
+        if (sourceRect.isEmpty())
+            return false;
+        // Compressed rows have to be decoded in full, and cropped and
+        // scaled after.
+        const bool compressed = infoHeader.biCompression == BMP_RLE4
+                || infoHeader.biCompression == BMP_RLE8;
+        if (!compressed && !d->isSequential()) {
+            if (!read_dib_region(s, infoHeader, datapos, infopos, sourceRect, targetSize, *image))
+                return false;
+        } else {
+            QImage full;
+            if (!read_dib_body(s, infoHeader, datapos, infopos, full))
+                return false;
+            *image = QImageDecimator::decimate(full, sourceRect, targetSize);
+            if (image->isNull())
+                return false;
+        }
+        state = Ready;
+        return true;
+    }
+
+    if (!read_dib_body(s, infoHeader, datapos, infopos, *image))
         return false;
 
     state = Ready;
@@ -859,7 +986,10 @@ bool QBmpHandler::write(const QImage &img)
 bool QBmpHandler::supportsOption(ImageOption option) const
 {
     return option == Size
-            || option == ImageFormat;
+            || option == ImageFormat
+            || option == MemoryMappedReading
+            || option == ClipRect
+            || option == ScaledSize;
 }
 
 QVariant QBmpHandler::option(ImageOption option) const
@@ -893,14 +1023,24 @@ QVariant QBmpHandler::option(ImageOption option) const
                 format = QImage::Format_Mono;
             }
         return format;
+    } else if (option == MemoryMappedReading) {
+        return memoryMapping;
+    } else if (option == ClipRect) {
+        return clipRect;
+    } else if (option == ScaledSize) {
+        return scaledSize;
     }
     return QVariant();
 }
 
 void QBmpHandler::setOption(ImageOption option, const QVariant &value)
 {
-    Q_UNUSED(option);
-    Q_UNUSED(value);
+    if (option == MemoryMappedReading)
+        memoryMapping = value.toBool();
+    else if (option == ClipRect)
+        clipRect = value.toRect();
+    else if (option == ScaledSize)
+        scaledSize = value.toSize();
 }
 
 QT_END_NAMESPACE
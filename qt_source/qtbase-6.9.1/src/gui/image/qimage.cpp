@@ -6,6 +6,7 @@
 
 #include "qbuffer.h"
 #include "qdatastream.h"
+#include "qfile.h"
 #include "qcolortransform.h"
 #include "qfloat16.h"
 #include "qmap.h"
@@ -3898,6 +3899,86 @@ QImage QImage::fromData(const uchar *data, int size, const char *format)
 
 */
 
+/*!
+    \since 6.10
+
+    Returns an image of the given \a size and \a format that refers to the
+    pixel data stored in the file \a fileName from byte \a offset on,
+    without reading it. The scanlines are \a bytesPerLine bytes apart; if
+    \a bytesPerLine is -1, they are assumed to be packed.
+
+    The file is mapped into memory read-only, so opening even very large
+    raw pixel dumps is nearly instant, and only the pages of the file that
+    are accessed are loaded into memory. The image is copied into memory of
+    its own the first time it is modified. The file must not be truncated
+    or modified while the image, or a copy of it that has not been
+    modified, is alive.
+
+    Returns a null image if the file cannot be mapped, if it is too short
+    for the image, or if \a offset and \a bytesPerLine are not aligned to
+    the size of a pixel of \a format. Images with a color table, such as
+    QImage::Format_Indexed8, have an empty one that must be set with
+    setColorTable(); this does not copy the pixel data.
+
+    \sa QImageReader::setMemoryMappingEnabled(), QFile::map()
+*/
+QImage QImage::fromMappedFile(const QString &fileName, const QSize &size, Format format,
+                              qsizetype bytesPerLine, qint64 offset)
+{
+    if (size.isEmpty() || format <= Format_Invalid || format >= NImageFormats || offset < 0)
+        return QImage();
+
+    const int depth = qt_depthForFormat(format);
+    const qsizetype minBytesPerLine = (qsizetype(size.width()) * depth + 7) / 8;
+    if (bytesPerLine < 0)
+        bytesPerLine = minBytesPerLine;
+    if (bytesPerLine < minBytesPerLine)
+        return QImage();
+
+    // Pixels are read as whole units, so they have to be naturally aligned.
+    // The mapping itself starts at a page boundary.
+    const int alignment = (depth % 8 == 0 && (depth & (depth - 1)) == 0) ? qMin(depth / 8, 8) : 1;
+    if (offset % alignment != 0 || bytesPerLine % alignment != 0)
+        return QImage();
+
+    qsizetype totalSize;
+    if (qMulOverflow<qsizetype>(bytesPerLine, size.height(), &totalSize))
+        return QImage();
+
+    auto file = std::make_unique<QFile>(fileName);
+    if (!file->open(QIODevice::ReadOnly) || offset + totalSize > file->size())
+        return QImage();
+    const uchar *data = file->map(offset, totalSize);
+    if (!data)
+        return QImage();
+
+    // The file is unmapped when it is deleted along with the last image
+    // that refers to its data.
+    QImage image(data, size.width(), size.height(), bytesPerLine, format,
+                 [](void *file) { delete static_cast<QFile *>(file); }, file.get());
+    if (image.isNull())
+        return QImage();
+    file.release();
+    return image;
+}
+
+/*!
+    \internal
+
+    Returns an image that refers to the memory mapped contents of
+    \a device from byte \a offset on, or a null image if \a device is not
+    a file that can be mapped. Used by the image handlers that support
+    QImageIOHandler::MemoryMappedReading.
+*/
+QImage qt_mapImage(QIODevice *device, qint64 offset, const QSize &size, qsizetype bytesPerLine,
+                   QImage::Format format)
+{
+    QFile *file = qobject_cast<QFile *>(device);
+    if (!file || file->fileName().isEmpty() || file->isTextModeEnabled())
+        return QImage();
+    return QImage::fromMappedFile(file->fileName(), size, format, bytesPerLine, offset);
+}
+
 /*!
     Saves the image to the file with the given \a fileName, using the
     given image file \a format and \a quality factor. If \a format is
@@ -4991,13 +5072,44 @@ QImage Q_TRACE_INSTRUMENT(qtgui) QImage::transformed(const QTransform &matrix, Q
         Q_ASSERT(sImage.devicePixelRatio() == 1);
         Q_ASSERT(sImage.devicePixelRatio() == dImage.devicePixelRatio());
 
-        QPainter p(&dImage);
-        if (mode == Qt::SmoothTransformation) {
-            p.setRenderHint(QPainter::Antialiasing);
-            p.setRenderHint(QPainter::SmoothPixmapTransform);
+        // Every band of rows gets its own painter on an image that shares the
+        // pixels of dImage, so that large images are painted in parallel.
+        uchar *dbits = dImage.bits();
+        const qsizetype dbpl = dImage.bytesPerLine();
+        auto paintSegment = [&](int y, int yn) {
+            QImage band(dbits + y * dbpl, wd, yn, dbpl, target_format);
+            QPainter p(&band);
+            if (mode == Qt::SmoothTransformation) {
+                p.setRenderHint(QPainter::Antialiasing);
+                p.setRenderHint(QPainter::SmoothPixmapTransform);
+            }
+            p.setTransform(mat * QTransform::fromTranslate(0, -y));
+            p.drawImage(QPoint(0, 0), sImage);
+        };
+
+#if QT_CONFIG(qtgui_threadpool)
+        int segments = (qsizetype(wd) * hd) >> 16;
+        segments = std::min(segments, hd);
+
+        QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+        if (segments <= 1 || !threadPool || threadPool->contains(QThread::currentThread())) {
+            paintSegment(0, hd);
+        } else {
+            QSemaphore semaphore;
+            int y = 0;
+            for (int i = 0; i < segments; ++i) {
+                int yn = (hd - y) / (segments - i);
+                threadPool->start([&, y, yn]() {
+                    paintSegment(y, yn);
+                    semaphore.release(1);
+                });
+                y += yn;
+            }
+            semaphore.acquire(segments);
         }
-        p.setTransform(mat);
-        p.drawImage(QPoint(0, 0), sImage);
+#else
+        paintSegment(0, hd);
+#endif
     } else {
         bool invertible;
         mat = mat.inverted(&invertible);                // invert matrix
@@ -5751,6 +5863,8 @@ QImage QImage::colorTransformed(const QColorTransform &transform, QImage::Format
             transFlags = QColorTransformPrivate::InputOpaque;
         else if (qPixelLayouts[fromImage.format()].premultiplied)
             transFlags = QColorTransformPrivate::Premultiplied;
+        if (flags & Qt::ApproximateColorTransform)
+            transFlags |= QColorTransformPrivate::AllowLut3D;
 
         if (fromImage.format() == Format_Grayscale8) {
             transformSegment = [&](int yStart, int yEnd) {
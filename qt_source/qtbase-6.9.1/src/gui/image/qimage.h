@@ -271,6 +271,8 @@ public:
     static QImage fromData(const uchar *data, int size, const char *format = nullptr); // ### Qt 7: qsizetype
     static QImage fromData(const QByteArray &data, const char *format = nullptr)  // ### Qt 7: drop
     { return fromData(QByteArrayView(data), format); }
+    static QImage fromMappedFile(const QString &fileName, const QSize &size, Format format,
+                                 qsizetype bytesPerLine = -1, qint64 offset = 0);
 
     qint64 cacheKey() const;
 
@@ -0,0 +1,370 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qimagedecimator_p.h"
+
+#include <qcolorspace.h>
+#include <qimageiohandler.h>
+#include <qrgba64.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QImageDecimator
+    \internal
+    \inmodule QtGui
+
+    \brief The QImageDecimator class crops and scales an image while its
+    rows are being decoded.
+
+    Image handlers that support the ClipRect and ScaledSize options hand
+    the decoded rows of the image to a decimator one by one, from top to
+    bottom, instead of storing them in an image of the full size. The
+    decimator keeps the part of the row inside the source rectangle, and
+    reduces it to the size of the target image by averaging the source
+    pixels that fall on each target pixel. Only the target image and one
+    row of sums are allocated, so a small window of a very large image
+    costs little memory, and a handler can stop decoding once isDone()
+    returns \c true.
+
+    Pixels of formats with an alpha channel that is not premultiplied are
+    weighted by their alpha. Indexed and monochrome pixels cannot be
+    averaged, and averaging cannot enlarge an image. When canAverage()
+    returns \c false, the decimator keeps a copy of the source rectangle
+    and replaces the target with a smoothly scaled copy of it once the last
+    row has been added, as QImageReader does for handlers that cannot
+    scale.
+*/
+
+/*!
+    Constructs a decimator that stores the pixels of \a sourceRect in
+    \a target, which must have the format of the rows that will be added
+    and the size the rectangle is scaled to.
+*/
+QImageDecimator::QImageDecimator(QImage *target, const QRect &sourceRect)
+    : m_target(target), m_source(sourceRect), m_mode(mode(target->format())),
+      m_bytesPerPixel(target->depth() / 8)
+{
+    if (!canAverage(target->format(), sourceRect.size(), target->size())
+        && QImageIOHandler::allocateImage(sourceRect.size(), target->format(), &m_crop)) {
+        m_crop.setColorTable(target->colorTable());
+        m_crop.setColorSpace(target->colorSpace());
+        m_crop.setDotsPerMeterX(target->dotsPerMeterX());
+        m_crop.setDotsPerMeterY(target->dotsPerMeterY());
+        return;
+    }
+
+    // If the copy cannot be allocated, the pixels are sampled.
+    const int width = target->width();
+    m_columns.resize(width + 1);
+    for (int tx = 0; tx <= width; ++tx)
+        m_columns[tx] = m_source.left() + int(qint64(tx) * m_source.width() / width);
+    if (m_mode != Nearest)
+        m_sums.resize(qsizetype(width) * 4);
+}
+
+QImageDecimator::Mode QImageDecimator::mode(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_Grayscale8:
+        return Gray8;
+    case QImage::Format_Grayscale16:
+        return Gray16;
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return Rgb32;
+    case QImage::Format_ARGB32:
+        return Argb32;
+    case QImage::Format_RGBX64:
+    case QImage::Format_RGBA64_Premultiplied:
+        return Rgba64;
+    case QImage::Format_RGBA64:
+        return Rgba64Unpremultiplied;
+    default:
+        return Nearest;
+    }
+}
+
+/*!
+    Returns \c true if a rectangle of \a sourceSize of an image in
+    \a format is reduced to \a targetSize by averaging its pixels, and
+    \c false if it is scaled with Qt::SmoothTransformation instead.
+*/
+bool QImageDecimator::canAverage(QImage::Format format, const QSize &sourceSize,
+                                 const QSize &targetSize)
+{
+    if (sourceSize == targetSize)
+        return true;
+    return mode(format) != Nearest
+            && targetSize.width() <= sourceSize.width()
+            && targetSize.height() <= sourceSize.height();
+}
+
+/*!
+    Returns the part of an image of \a imageSize that is read when the
+    ClipRect option is \a clipRect; an invalid clip rectangle selects the
+    whole image.
+*/
+QRect QImageDecimator::sourceRect(const QSize &imageSize, const QRect &clipRect)
+{
+    const QRect imageRect(QPoint(0, 0), imageSize);
+    return clipRect.isValid() ? clipRect & imageRect : imageRect;
+}
+
+/*!
+    Returns the size that \a sourceRect is scaled to when the ScaledSize
+    option is \a scaledSize.
+*/
+QSize QImageDecimator::targetSize(const QRect &sourceRect, const QSize &scaledSize)
+{
+    return scaledSize.isValid() && !scaledSize.isEmpty() ? scaledSize : sourceRect.size();
+}
+
+/*!
+    Returns the pixels of \a sourceRect of \a image scaled to
+    \a targetSize, for handlers that have to decode an image in full.
+    The metadata of \a image is kept.
+*/
+QImage QImageDecimator::decimate(const QImage &image, const QRect &sourceRect,
+                                 const QSize &targetSize)
+{
+    if (sourceRect == image.rect() && targetSize == image.size())
+        return image;
+
+    if (sourceRect.isEmpty() || !image.rect().contains(sourceRect))
+        return QImage();
+    if (!canAverage(image.format(), sourceRect.size(), targetSize))
+        return image.copy(sourceRect).scaled(targetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    QImage target;
+    if (!QImageIOHandler::allocateImage(targetSize, image.format(), &target))
+        return QImage();
+    target.setColorTable(image.colorTable());
+    target.setColorSpace(image.colorSpace());
+    target.setDotsPerMeterX(image.dotsPerMeterX());
+    target.setDotsPerMeterY(image.dotsPerMeterY());
+    target.setOffset(image.offset());
+    const QStringList keys = image.textKeys();
+    for (const QString &key : keys)
+        target.setText(key, image.text(key));
+
+    QImageDecimator decimator(&target, sourceRect);
+    for (int y = sourceRect.top(); y <= sourceRect.bottom() && !decimator.isDone(); ++y)
+        decimator.addRow(y, image.constScanLine(y));
+    return target;
+}
+
+int QImageDecimator::rowStart(int ty) const
+{
+    return m_source.top() + int(qint64(ty) * m_source.height() / m_target->height());
+}
+
+int QImageDecimator::rowEnd(int ty) const
+{
+    const int end = m_source.top() + int(qint64(ty + 1) * m_source.height() / m_target->height());
+    return qMax(end, rowStart(ty) + 1);
+}
+
+/*!
+    Adds \a row, the decoded row \a y of the image, which starts at
+    column 0. Rows must be added from top to bottom; rows outside the
+    source rectangle are ignored.
+*/
+void QImageDecimator::addRow(int y, const uchar *row)
+{
+    if (!m_crop.isNull()) {
+        crop(y, row);
+        return;
+    }
+    while (!isDone()) {
+        const int start = rowStart(m_targetY);
+        const int end = rowEnd(m_targetY);
+        if (y < start)
+            return;
+        if (y < end) {
+            if (m_mode == Nearest) {
+                if (y == (start + end - 1) / 2)
+                    sample(row);
+            } else {
+                accumulate(row);
+            }
+            if (y < end - 1)
+                return;
+        }
+        if (m_mode != Nearest)
+            emitRow();
+        ++m_targetY;
+    }
+}
+
+void QImageDecimator::sample(const uchar *row)
+{
+    uchar *out = m_target->scanLine(m_targetY);
+    const int width = m_target->width();
+    if (m_bytesPerPixel == 0) {
+        const bool lsb = m_target->format() == QImage::Format_MonoLSB;
+        for (int tx = 0; tx < width; ++tx) {
+            const int x = (m_columns[tx] + qMax(m_columns[tx + 1], m_columns[tx] + 1) - 1) / 2;
+            const bool bit = lsb ? (row[x >> 3] >> (x & 7)) & 1
+                                 : (row[x >> 3] >> (7 - (x & 7))) & 1;
+            const uchar mask = lsb ? uchar(1 << (tx & 7)) : uchar(0x80 >> (tx & 7));
+            if (bit)
+                out[tx >> 3] |= mask;
+            else
+                out[tx >> 3] &= ~mask;
+        }
+        return;
+    }
+
+    if (m_source.width() == width) {
+        memcpy(out, row + qsizetype(m_source.left()) * m_bytesPerPixel,
+               qsizetype(width) * m_bytesPerPixel);
+        return;
+    }
+    for (int tx = 0; tx < width; ++tx) {
+        const int x = (m_columns[tx] + qMax(m_columns[tx + 1], m_columns[tx] + 1) - 1) / 2;
+        memcpy(out + qsizetype(tx) * m_bytesPerPixel, row + qsizetype(x) * m_bytesPerPixel,
+               m_bytesPerPixel);
+    }
+}
+
+void QImageDecimator::crop(int y, const uchar *row)
+{
+    if (y < m_source.top() || y > m_source.bottom())
+        return;
+    uchar *out = m_crop.scanLine(y - m_source.top());
+    const int left = m_source.left();
+    const int width = m_source.width();
+    if (m_bytesPerPixel != 0) {
+        memcpy(out, row + qsizetype(left) * m_bytesPerPixel, qsizetype(width) * m_bytesPerPixel);
+    } else if (left % 8 == 0) {
+        memcpy(out, row + left / 8, (width + 7) / 8);
+    } else {
+        const bool lsb = m_crop.format() == QImage::Format_MonoLSB;
+        for (int tx = 0; tx < width; ++tx) {
+            const int x = left + tx;
+            const bool bit = lsb ? (row[x >> 3] >> (x & 7)) & 1
+                                 : (row[x >> 3] >> (7 - (x & 7))) & 1;
+            const uchar mask = lsb ? uchar(1 << (tx & 7)) : uchar(0x80 >> (tx & 7));
+            if (bit)
+                out[tx >> 3] |= mask;
+            else
+                out[tx >> 3] &= ~mask;
+        }
+    }
+
+    if (y == m_source.bottom()) {
+        *m_target = m_crop.scaled(m_target->size(), Qt::IgnoreAspectRatio,
+                                  Qt::SmoothTransformation);
+        m_crop = QImage();
+        m_targetY = m_target->height();
+    }
+}
+
+void QImageDecimator::accumulate(const uchar *row)
+{
+    const int width = m_target->width();
+    quint64 *sums = m_sums.data();
+    for (int tx = 0; tx < width; ++tx, sums += 4) {
+        const int start = m_columns[tx];
+        const int end = qMax(m_columns[tx + 1], start + 1);
+        for (int x = start; x < end; ++x) {
+            switch (m_mode) {
+            case Gray8:
+                sums[0] += row[x];
+                break;
+            case Gray16:
+                sums[0] += reinterpret_cast<const quint16 *>(row)[x];
+                break;
+            case Rgb32: {
+                const QRgb p = reinterpret_cast<const QRgb *>(row)[x];
+                sums[0] += qRed(p);
+                sums[1] += qGreen(p);
+                sums[2] += qBlue(p);
+                sums[3] += qAlpha(p);
+                break;
+            }
+            case Argb32: {
+                const QRgb p = reinterpret_cast<const QRgb *>(row)[x];
+                const uint a = qAlpha(p);
+                sums[0] += qRed(p) * a;
+                sums[1] += qGreen(p) * a;
+                sums[2] += qBlue(p) * a;
+                sums[3] += a;
+                break;
+            }
+            case Rgba64: {
+                const QRgba64 p = reinterpret_cast<const QRgba64 *>(row)[x];
+                sums[0] += p.red();
+                sums[1] += p.green();
+                sums[2] += p.blue();
+                sums[3] += p.alpha();
+                break;
+            }
+            case Rgba64Unpremultiplied: {
+                const QRgba64 p = reinterpret_cast<const QRgba64 *>(row)[x];
+                const quint64 a = p.alpha();
+                sums[0] += p.red() * a;
+                sums[1] += p.green() * a;
+                sums[2] += p.blue() * a;
+                sums[3] += a;
+                break;
+            }
+            case Nearest:
+                break;
+            }
+        }
+    }
+}
+
+void QImageDecimator::emitRow()
+{
+    const int rows = rowEnd(m_targetY) - rowStart(m_targetY);
+    const int width = m_target->width();
+    uchar *out = m_target->scanLine(m_targetY);
+    quint64 *sums = m_sums.data();
+    for (int tx = 0; tx < width; ++tx, sums += 4) {
+        const quint64 n = quint64(rows) * (qMax(m_columns[tx + 1], m_columns[tx] + 1) - m_columns[tx]);
+        const auto average = [n](quint64 sum) { return (sum + n / 2) / n; };
+        const auto weighted = [](quint64 sum, quint64 alpha) {
+            return alpha ? (sum + alpha / 2) / alpha : 0;
+        };
+        switch (m_mode) {
+        case Gray8:
+            out[tx] = uchar(average(sums[0]));
+            break;
+        case Gray16:
+            reinterpret_cast<quint16 *>(out)[tx] = quint16(average(sums[0]));
+            break;
+        case Rgb32:
+            reinterpret_cast<QRgb *>(out)[tx] = qRgba(int(average(sums[0])), int(average(sums[1])),
+                                                      int(average(sums[2])), int(average(sums[3])));
+            break;
+        case Argb32:
+            reinterpret_cast<QRgb *>(out)[tx] = qRgba(int(weighted(sums[0], sums[3])),
+                                                      int(weighted(sums[1], sums[3])),
+                                                      int(weighted(sums[2], sums[3])),
+                                                      int(average(sums[3])));
+            break;
+        case Rgba64:
+            reinterpret_cast<QRgba64 *>(out)[tx] =
+                    QRgba64::fromRgba64(quint16(average(sums[0])), quint16(average(sums[1])),
+                                        quint16(average(sums[2])), quint16(average(sums[3])));
+            break;
+        case Rgba64Unpremultiplied:
+            reinterpret_cast<QRgba64 *>(out)[tx] =
+                    QRgba64::fromRgba64(quint16(weighted(sums[0], sums[3])),
+                                        quint16(weighted(sums[1], sums[3])),
+                                        quint16(weighted(sums[2], sums[3])),
+                                        quint16(average(sums[3])));
+            break;
+        case Nearest:
+            break;
+        }
+        sums[0] = sums[1] = sums[2] = sums[3] = 0;
+    }
+}
+
+QT_END_NAMESPACE
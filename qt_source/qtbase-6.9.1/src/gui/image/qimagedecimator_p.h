@@ -0,0 +1,72 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QIMAGEDECIMATOR_P_H
+#define QIMAGEDECIMATOR_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrect.h>
+#include <QtGui/qimage.h>
+
+QT_BEGIN_NAMESPACE
+
+class Q_GUI_EXPORT QImageDecimator
+{
+public:
+    QImageDecimator(QImage *target, const QRect &sourceRect);
+
+    static QRect sourceRect(const QSize &imageSize, const QRect &clipRect);
+    static QSize targetSize(const QRect &sourceRect, const QSize &scaledSize);
+    static QImage decimate(const QImage &image, const QRect &sourceRect, const QSize &targetSize);
+
+    void addRow(int y, const uchar *row);
+    bool isDone() const { return m_targetY >= m_target->height(); }
+
+    static bool canAverage(QImage::Format format, const QSize &sourceSize,
+                           const QSize &targetSize);
+
+private:
+    enum Mode {
+        Nearest,
+        Gray8,
+        Gray16,
+        Rgb32,
+        Argb32,
+        Rgba64,
+        Rgba64Unpremultiplied
+    };
+
+    static Mode mode(QImage::Format format);
+
+    int rowStart(int ty) const;
+    int rowEnd(int ty) const;
+    void accumulate(const uchar *row);
+    void sample(const uchar *row);
+    void emitRow();
+    void crop(int y, const uchar *row);
+
+    QImage *m_target;
+    QRect m_source;
+    Mode m_mode;
+    int m_bytesPerPixel;
+    int m_targetY = 0;
+    QList<int> m_columns;       // source columns of the target columns, plus the end
+    QList<quint64> m_sums;      // four per target pixel
+    QImage m_crop;              // the source rectangle, when it cannot be averaged
+};
+
+QT_END_NAMESPACE
+
+#endif // QIMAGEDECIMATOR_P_H
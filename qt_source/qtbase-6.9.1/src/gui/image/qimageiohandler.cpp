@@ -133,6 +133,14 @@
     \value ImageTransformation A handler which supports this option can read
     the transformation metadata of an image. A handler that supports this option
     should not apply the transformation itself.
+
+    \value MemoryMappedReading A handler which supports this option can
+    return images that refer to a memory mapping of the file they are read
+    from, instead of decoding them into newly allocated memory. The option
+    is only a hint: the handler decodes as usual when the device is not a
+    file or the pixel data cannot be used as it is stored. A mapped image is
+    read-only; it is copied the first time it is modified. This enum value
+    has been added in Qt 6.10.
 */
 
 /*! \enum QImageIOHandler::Transformation
@@ -57,7 +57,8 @@ public:
         SupportedSubTypes,
         OptimizedWrite,
         ProgressiveScanWrite,
-        ImageTransformation
+        ImageTransformation,
+        MemoryMappedReading
     };
 
     enum Transformation {
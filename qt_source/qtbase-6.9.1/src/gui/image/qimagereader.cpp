@@ -110,6 +110,12 @@
 #include <qsize.h>
 #include <qcolor.h>
 #include <qvariant.h>
+#if QT_CONFIG(future)
+#include <qpromise.h>
+#include <qthreadpool.h>
+#include <private/qguiapplication_p.h>
+#include <private/qimagedecimator_p.h>
+#endif
 
 // factory loader
 #include <qcoreapplication.h>
@@ -132,6 +138,7 @@
 #include <qtgui_tracepoints_p.h>
 
 #include <algorithm>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -429,6 +436,7 @@ public:
         ApplyTransform,
         DoNotApplyTransform
     } autoTransform;
+    bool memoryMapping;
 
     // error
     QImageReader::ImageReaderError imageReaderError;
@@ -453,6 +461,7 @@ QImageReaderPrivate::QImageReaderPrivate(QImageReader *qq)
     quality = -1;
     imageReaderError = QImageReader::UnknownError;
     autoTransform = UsePluginDefault;
+    memoryMapping = false;
 
     q = qq;
 }
@@ -1066,6 +1075,47 @@ bool QImageReader::autoTransform() const
     return false;
 }
 
+/*!
+    \since 6.10
+
+    Determines whether read() may return images that refer to a memory
+    mapping of the image file instead of decoded copies, if \a enabled is
+    \c true. The default is \c false.
+
+    Mapping avoids decoding and copying the pixel data of large uncompressed
+    images, such as binary PPM, PGM and PBM files and top-down BMP files:
+    reading the image costs a system call, and only the pages that are
+    accessed are loaded from disk. The returned image is read-only; it is
+    copied into memory of its own the first time it is modified, for
+    instance by QImage::bits() or QPainter. It may also have a different
+    format than a decoded image would have, for example
+    QImage::Format_RGB888 for a PPM file; use QImage::convertToFormat() to
+    convert it when needed.
+
+    Images are only mapped when the device is a QFile and the handler
+    supports QImageIOHandler::MemoryMappedReading; otherwise this setting
+    has no effect. The file must not be truncated or modified while a
+    mapped image is alive.
+
+    \sa isMemoryMappingEnabled(), read()
+*/
+void QImageReader::setMemoryMappingEnabled(bool enabled)
+{
+    d->memoryMapping = enabled;
+}
+
+/*!
+    \since 6.10
+
+    Returns \c true if read() may return memory mapped images.
+
+    \sa setMemoryMappingEnabled()
+*/
+bool QImageReader::isMemoryMappingEnabled() const
+{
+    return d->memoryMapping;
+}
+
 /*!
     Returns \c true if an image can be read for the device (i.e., the
     image format is supported, and the device seems to contain valid
@@ -1177,6 +1227,8 @@ bool QImageReader::read(QImage *image)
         d->handler->setOption(QImageIOHandler::ScaledClipRect, d->scaledClipRect);
     if (supportsOption(QImageIOHandler::Quality))
         d->handler->setOption(QImageIOHandler::Quality, d->quality);
+    if (supportsOption(QImageIOHandler::MemoryMappedReading))
+        d->handler->setOption(QImageIOHandler::MemoryMappedReading, d->memoryMapping);
 
     // read the image
     QString filename = fileName();
@@ -1550,4 +1602,79 @@ void QImageReader::setAllocationLimit(int mbLimit)
         QImageReaderPrivate::maxAlloc = mbLimit;
 }
 
+#if QT_CONFIG(future)
+/*!
+    \since 6.10
+
+    Reads \a rect of the image in \a fileName as a pyramid of
+    \a levelCount levels in the background, and returns a future that
+    receives the levels as they are computed. Level \e n holds \a rect
+    scaled down by a factor of 2 to the power of \e n, and is stored at
+    result index \e n; level 0 is \a rect at full resolution. An invalid
+    \a rect selects the whole image, and a negative \a levelCount reads
+    levels until the coarsest one is a single pixel.
+
+    The image is decoded once, on the Qt GUI thread pool, and every level
+    is reduced from the one before it by averaging blocks of 2 by 2 pixels,
+    so the whole pyramid costs about a third more than level 0. The image
+    handlers for PNG and BMP decode only the rows of \a rect. If the image
+    cannot be read, the future finishes without results; canceling it skips
+    the levels that have not been computed yet.
+
+    \sa setClipRect(), setScaledSize()
+*/
+QFuture<QImage> QImageReader::readPyramid(const QString &fileName, const QRect &rect,
+                                          int levelCount)
+{
+    auto promise = std::make_shared<QPromise<QImage>>();
+    QFuture<QImage> future = promise->future();
+    promise->start();
+
+    const QSize imageSize = QImageReader(fileName).size();
+    const QRect imageRect(QPoint(0, 0), imageSize);
+    const QRect sourceRect = rect.isValid() ? rect & imageRect : imageRect;
+    if (sourceRect.isEmpty()) {
+        promise->finish();
+        return future;
+    }
+
+    int levels = 1;
+    while ((qMax(sourceRect.width(), sourceRect.height()) >> levels) > 0)
+        ++levels;
+    if (levelCount >= 0)
+        levels = qMin(levels, levelCount);
+    if (levels == 0) {
+        promise->finish();
+        return future;
+    }
+    promise->setProgressRange(0, levels);
+
+    const QRect clipRect = sourceRect == imageRect ? QRect() : sourceRect;
+    auto readLevels = [=] {
+        QImageReader reader(fileName);
+        reader.setClipRect(clipRect);
+        QImage image = reader.read();
+        for (int level = 0; level < levels && !image.isNull() && !promise->isCanceled(); ++level) {
+            if (level > 0) {
+                const QSize size(qMax(1, sourceRect.width() >> level),
+                                 qMax(1, sourceRect.height() >> level));
+                image = QImageDecimator::decimate(image, image.rect(), size);
+            }
+            promise->addResult(image, level);
+            promise->setProgressValue(level + 1);
+        }
+        promise->finish();
+    };
+
+#if QT_CONFIG(qtgui_threadpool)
+    if (QThreadPool *pool = QGuiApplicationPrivate::qtGuiThreadPool()) {
+        pool->start(readLevels);
+        return future;
+    }
+#endif
+    readLevels();
+    return future;
+}
+#endif // QT_CONFIG(future)
+
 QT_END_NAMESPACE
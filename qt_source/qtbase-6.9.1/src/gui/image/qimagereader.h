@@ -9,6 +9,9 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qimageiohandler.h>
+#if QT_CONFIG(future)
+#include <QtCore/qfuture.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -80,6 +83,9 @@ public:
     void setAutoTransform(bool enabled);
     bool autoTransform() const;
 
+    void setMemoryMappingEnabled(bool enabled);
+    bool isMemoryMappingEnabled() const;
+
     QByteArray subType() const;
     QList<QByteArray> supportedSubTypes() const;
 
@@ -107,6 +113,10 @@ public:
     static QList<QByteArray> imageFormatsForMimeType(const QByteArray &mimeType);
     static int allocationLimit();
     static void setAllocationLimit(int mbLimit);
+#if QT_CONFIG(future)
+    static QFuture<QImage> readPyramid(const QString &fileName, const QRect &rect = QRect(),
+                                       int levelCount = -1);
+#endif
 
 private:
     Q_DISABLE_COPY(QImageReader)
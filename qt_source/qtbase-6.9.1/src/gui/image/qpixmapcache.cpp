@@ -8,6 +8,11 @@
 #include "qpixmapcache_p.h"
 #include "qthread.h"
 #include "qcoreapplication.h"
+#include "qmutex.h"
+#include "qscopedvaluerollback.h"
+#include "qstringlist.h"
+
+#include <algorithm>
 
 using namespace std::chrono_literals;
 
@@ -52,7 +57,30 @@ QT_BEGIN_NAMESPACE
     applications by caching the results of painting.
 
     \note QPixmapCache is only usable from the application's main thread.
-    Access from other threads will be ignored and return failure.
+    Access from other threads will be ignored and return failure. The
+    images of cache partitions are the exception.
+
+    \section1 Partitions
+
+    Pixmaps of different kinds, such as icons, tiles of a map and rendered
+    labels, compete for the space of the cache, and a burst of one kind
+    evicts the others. They can be kept apart in named partitions instead,
+    by passing the name of a partition to find(), insert() and remove().
+    Every partition has its own limit, set in bytes with
+    setPartitionLimit(), and its own eviction policy. A partition is
+    created on first use with a limit of 10 MB; partitions() returns the
+    names of the partitions that exist.
+
+    Partitions also hold images, which are stored with insertImage() and
+    retrieved with findImage(). Unlike pixmaps, images can be stored and
+    looked up from any thread, so that worker threads can share decoded
+    images. A key refers to either a pixmap or an image; findImage() does
+    not return pixmaps and find() does not return images.
+
+    Each partition, and the default cache, counts hits, misses, insertions
+    and evictions. statistics() returns the counters together with the
+    number of bytes in use, and dumpStatistics() prints them for all
+    caches, which helps to choose the limits of the partitions.
 
     \sa QCache, QPixmap
 */
@@ -202,6 +230,12 @@ public:
 
     bool flushDetachedPixmaps(bool nt);
 
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 insertions = 0;
+    quint64 evictions = 0;
+    bool removing = false;  // entries are deleted on request, not evicted
+
 private:
     static constexpr auto soon_time = 10s;
     static constexpr auto flush_time = 30s;
@@ -282,6 +316,7 @@ QPixmap *QPMCache::object(const QString &key) const
 {
     if (const auto it = cacheKeys.find(key); it != cacheKeys.cend())
         return object(it.value());
+    ++const_cast<QPMCache *>(this)->misses;
     return nullptr;
 }
 
@@ -292,6 +327,7 @@ QPixmap *QPMCache::object(const QPixmapCache::Key &key) const
     //We didn't find the pixmap in the cache, the key is not valid anymore
     if (!ptr)
         const_cast<QPMCache *>(this)->releaseKey(key);
+    ++(ptr ? const_cast<QPMCache *>(this)->hits : const_cast<QPMCache *>(this)->misses);
     return ptr;
 }
 
@@ -312,10 +348,14 @@ bool QPMCache::insert(const QString& key, const QPixmap &pixmap, int cost)
 
 QPixmapCache::Key QPMCache::insert(const QPixmap &pixmap, int cost)
 {
+    // QCache would delete the new entry right away, which counts as an eviction
+    if (cost > maxCost())
+        return QPixmapCache::Key();
     QPixmapCache::Key cacheKey = createKey(); // invalidated by ~QPixmapCacheEntry on failed insert
     bool success = QCache<QPixmapCache::Key, QPixmapCacheEntry>::insert(cacheKey, new QPixmapCacheEntry(cacheKey, pixmap), cost);
     Q_ASSERT(success || !cacheKey.isValid());
     if (success) {
+        ++insertions;
         if (!timer.isActive()) {
             timer.start(flush_time, this);
             t = false;
@@ -332,6 +372,7 @@ bool QPMCache::remove(const QString &key)
 
 bool QPMCache::remove(const QPixmapCache::Key &key)
 {
+    const QScopedValueRollback<bool> rollback(removing, true);
     return QCache<QPixmapCache::Key, QPixmapCacheEntry>::remove(key);
 }
 
@@ -386,6 +427,7 @@ void QPMCache::clear()
         if (key.d)
             key.d->isValid = false;
     }
+    const QScopedValueRollback<bool> rollback(removing, true);
     QCache<QPixmapCache::Key, QPixmapCacheEntry>::clear();
     // Nothing left to flush; stop the timer
     timer.stop();
@@ -405,9 +447,281 @@ int Q_AUTOTEST_EXPORT q_QPixmapCache_keyHashSize()
     return pm_cache()->size();
 }
 
+/*
+  A named partition of the cache. Its entries are spread over a few
+  shards by the hash of their key, each with its own lock, so that
+  threads looking up images rarely wait for each other. The limit
+  applies to the partition as a whole: when an insertion pushes the
+  partition over it, the entries of all shards are ranked by the
+  eviction policy and removed until three quarters of the limit are in
+  use.
+
+  Pixmaps are only created and destroyed on the main thread, so the
+  pixmap entries are left alone by other threads; they are evicted by
+  the next insertion on the main thread instead. Until then, other
+  threads keep the images within what the pixmaps leave of the limit,
+  but at least a quarter of it, so that pixmaps filling the partition
+  do not make every insertion rescan it and evict all images again.
+*/
+class QPixmapCachePartition
+{
+public:
+    struct Entry
+    {
+        QPixmap pixmap;
+        QImage image;
+        qint64 cost = 0;
+        quint64 lastUse = 0;
+        bool isPixmap = false;
+    };
+
+    template <typename T>
+    bool find(const QString &key, T *object);
+    bool insert(const QString &key, Entry &&entry);
+    void remove(const QString &key);
+    void clear();
+    void evict();
+    QPixmapCache::Statistics statistics() const;
+
+    QAtomicInteger<qint64> limit = qint64(cache_limit_default) * 1024;
+    QAtomicInt policy = int(QPixmapCache::EvictionPolicy::LeastRecentlyUsed);
+
+private:
+    static constexpr int ShardCount = 8;
+    struct Shard
+    {
+        QMutex mutex;
+        QHash<QString, Entry> entries;
+    };
+
+    Shard &shardFor(const QString &key) { return shards[qHash(key) % ShardCount]; }
+    static bool mayRemove(const Entry &entry)
+    { return !entry.isPixmap || QThread::isMainThread(); }
+    void charge(const Entry &entry)
+    {
+        resident.fetchAndAddRelaxed(entry.cost);
+        if (entry.isPixmap)
+            pixmapBytes.fetchAndAddRelaxed(entry.cost);
+    }
+    void release(const Entry &entry)
+    {
+        resident.fetchAndSubRelaxed(entry.cost);
+        if (entry.isPixmap)
+            pixmapBytes.fetchAndSubRelaxed(entry.cost);
+    }
+
+    Shard shards[ShardCount];
+    QAtomicInteger<quint64> clock = 0;
+    QAtomicInteger<quint64> hits = 0;
+    QAtomicInteger<quint64> misses = 0;
+    QAtomicInteger<quint64> insertions = 0;
+    QAtomicInteger<quint64> evictions = 0;
+    QAtomicInteger<qint64> resident = 0;
+    QAtomicInteger<qint64> pixmapBytes = 0;     // only the main thread can evict these
+    QAtomicInteger<qsizetype> entryCount = 0;
+};
+
+template <typename T>
+bool QPixmapCachePartition::find(const QString &key, T *object)
+{
+    constexpr bool isPixmap = std::is_same_v<T, QPixmap>;
+    Shard &shard = shardFor(key);
+    {
+        QMutexLocker locker(&shard.mutex);
+        const auto it = shard.entries.find(key);
+        if (it != shard.entries.end() && it->isPixmap == isPixmap) {
+            it->lastUse = clock.fetchAndAddRelaxed(1) + 1;
+            if (object) {
+                if constexpr (isPixmap)
+                    *object = it->pixmap;
+                else
+                    *object = it->image;
+            }
+            hits.fetchAndAddRelaxed(1);
+            return true;
+        }
+    }
+    misses.fetchAndAddRelaxed(1);
+    return false;
+}
+
+bool QPixmapCachePartition::insert(const QString &key, Entry &&entry)
+{
+    const qint64 cost = entry.cost;
+    if (cost > limit.loadRelaxed()) {
+        remove(key);
+        return false;
+    }
+    entry.lastUse = clock.fetchAndAddRelaxed(1) + 1;
+
+    Entry replaced; // destroyed after the shard is unlocked
+    Shard &shard = shardFor(key);
+    {
+        QMutexLocker locker(&shard.mutex);
+        const auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) {
+            if (!mayRemove(*it))
+                return false;
+            release(*it);
+            charge(entry);
+            replaced = std::exchange(*it, std::move(entry));
+        } else {
+            charge(entry);
+            shard.entries.insert(key, std::move(entry));
+            entryCount.fetchAndAddRelaxed(1);
+        }
+    }
+    insertions.fetchAndAddRelaxed(1);
+
+    if (resident.loadRelaxed() > limit.loadRelaxed())
+        evict();
+    return true;
+}
+
+void QPixmapCachePartition::remove(const QString &key)
+{
+    Entry removed;
+    Shard &shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+    const auto it = shard.entries.find(key);
+    if (it == shard.entries.end() || !mayRemove(*it))
+        return;
+    release(*it);
+    entryCount.fetchAndSubRelaxed(1);
+    removed = std::move(*it);
+    shard.entries.erase(it);
+}
+
+void QPixmapCachePartition::clear()
+{
+    for (Shard &shard : shards) {
+        QHash<QString, Entry> removed;
+        QMutexLocker locker(&shard.mutex);
+        for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+            if (mayRemove(*it)) {
+                release(*it);
+                entryCount.fetchAndSubRelaxed(1);
+                removed.insert(it.key(), std::move(*it));
+                it = shard.entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void QPixmapCachePartition::evict()
+{
+    struct Candidate
+    {
+        double score;
+        int shard;
+        QString key;
+    };
+
+    // Other threads only count the images they can remove.
+    const qint64 pinned = QThread::isMainThread() ? 0 : pixmapBytes.loadRelaxed();
+    const qint64 byteLimit = limit.loadRelaxed();
+    const qint64 allowance = qMax(byteLimit - pinned, byteLimit / 4);
+    if (resident.loadRelaxed() - pinned <= allowance)
+        return;
+
+    const bool costAware = policy.loadRelaxed() == int(QPixmapCache::EvictionPolicy::CostAware);
+    const quint64 now = clock.loadRelaxed();
+    QList<Candidate> candidates;
+    for (int i = 0; i < ShardCount; ++i) {
+        QMutexLocker locker(&shards[i].mutex);
+        for (auto it = shards[i].entries.cbegin(); it != shards[i].entries.cend(); ++it) {
+            if (!mayRemove(*it))
+                continue;
+            // the most recently used entry has an age of one
+            const double age = double(now > it->lastUse ? now - it->lastUse : 0) + 1;
+            candidates.append({ costAware ? age * double(it->cost) : age, i, it.key() });
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate &a, const Candidate &b) { return a.score > b.score; });
+
+    const qint64 target = allowance * 3 / 4;
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        if (resident.loadRelaxed() - pinned <= target)
+            break;
+        Entry removed;
+        Shard &shard = shards[candidate.shard];
+        QMutexLocker locker(&shard.mutex);
+        // The entry may have been replaced by a pixmap since it was chosen.
+        const auto it = shard.entries.find(candidate.key);
+        if (it == shard.entries.end() || !mayRemove(*it))
+            continue;
+        release(*it);
+        entryCount.fetchAndSubRelaxed(1);
+        removed = std::move(*it);
+        shard.entries.erase(it);
+        evictions.fetchAndAddRelaxed(1);
+    }
+}
+
+QPixmapCache::Statistics QPixmapCachePartition::statistics() const
+{
+    QPixmapCache::Statistics statistics;
+    statistics.hits = hits.loadRelaxed();
+    statistics.misses = misses.loadRelaxed();
+    statistics.insertions = insertions.loadRelaxed();
+    statistics.evictions = evictions.loadRelaxed();
+    statistics.residentBytes = resident.loadRelaxed();
+    statistics.byteLimit = limit.loadRelaxed();
+    statistics.entryCount = entryCount.loadRelaxed();
+    return statistics;
+}
+
+class QPixmapCachePartitions
+{
+public:
+    ~QPixmapCachePartitions() { qDeleteAll(partitions); }
+
+    // Partitions live as long as the application, so the pointer stays
+    // valid after the lock is released.
+    QPixmapCachePartition *partition(const QString &name)
+    {
+        QMutexLocker locker(&mutex);
+        QPixmapCachePartition *&partition = partitions[name];
+        if (!partition)
+            partition = new QPixmapCachePartition;
+        return partition;
+    }
+
+    QStringList names()
+    {
+        QMutexLocker locker(&mutex);
+        QStringList names = partitions.keys();
+        names.sort();
+        return names;
+    }
+
+    QList<QPixmapCachePartition *> all()
+    {
+        QMutexLocker locker(&mutex);
+        return partitions.values();
+    }
+
+private:
+    QMutex mutex;
+    QHash<QString, QPixmapCachePartition *> partitions;
+};
+
+Q_GLOBAL_STATIC(QPixmapCachePartitions, pm_cache_partitions)
+
+static inline qint64 byteCost(const QPixmap &pixmap)
+{
+    return qMax<qint64>(1, qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8);
+}
+
 QPixmapCacheEntry::~QPixmapCacheEntry()
 {
-    pm_cache()->releaseKey(key);
+    QPMCache *cache = pm_cache();
+    if (!cache->removing)
+        ++cache->evictions;
+    cache->releaseKey(key);
 }
 
 /*!
@@ -569,7 +883,8 @@ void QPixmapCache::remove(const Key &key)
 }
 
 /*!
-    Removes all pixmaps from the cache.
+    Removes all pixmaps from the cache, and all entries from the cache
+    partitions. The limits, eviction policies and counters are kept.
 */
 
 void QPixmapCache::clear()
@@ -579,6 +894,11 @@ void QPixmapCache::clear()
     QT_TRY {
         if (pm_cache.exists())
             pm_cache->clear();
+        if (pm_cache_partitions.exists()) {
+            const QList<QPixmapCachePartition *> partitions = pm_cache_partitions->all();
+            for (QPixmapCachePartition *partition : partitions)
+                partition->clear();
+        }
     } QT_CATCH(const std::bad_alloc &) {
         // if we ran out of memory during pm_cache(), it's no leak,
         // so just ignore it.
@@ -599,6 +919,250 @@ Q_AUTOTEST_EXPORT int qt_qpixmapcache_qpixmapcache_total_used() // for tst_qpixm
     return (pm_cache()->totalCost()+1023) / 1024;
 }
 
+/*!
+    \enum QPixmapCache::EvictionPolicy
+    \since 6.10
+
+    This enum describes which entries a cache partition removes when it
+    exceeds its limit.
+
+    \value LeastRecentlyUsed The entries that were used least recently are
+           removed first.
+    \value CostAware The entries are ranked by the time since their last
+           use multiplied by their size, so that a large pixmap that is
+           rarely used goes before many small ones.
+
+    \sa setPartitionEvictionPolicy()
+*/
+
+/*!
+    \class QPixmapCache::Statistics
+    \inmodule QtGui
+    \since 6.10
+
+    \brief The Statistics class holds the counters of a cache partition or
+    of the default cache.
+
+    \c hits and \c misses count the lookups, \c insertions and
+    \c evictions the entries that were added and the entries that were
+    removed to make room. Entries that are removed or replaced on request
+    are not counted as evictions. \c residentBytes is the size of the
+    entries in the cache, \c byteLimit the limit it is kept under, and
+    \c entryCount the number of entries.
+
+    \sa statistics()
+*/
+
+/*!
+    \since 6.10
+
+    Returns the names of the cache partitions that have been used, sorted.
+*/
+QStringList QPixmapCache::partitions()
+{
+    return pm_cache_partitions()->names();
+}
+
+/*!
+    \since 6.10
+
+    Sets the limit of \a partition to \a bytes. If the partition holds more
+    than that, entries are evicted right away. A limit of 0 disables the
+    partition.
+
+    \sa partitionLimit()
+*/
+void QPixmapCache::setPartitionLimit(const QString &partition, qint64 bytes)
+{
+    QPixmapCachePartition *p = pm_cache_partitions()->partition(partition);
+    p->limit.storeRelaxed(qMax<qint64>(0, bytes));
+    p->evict();
+}
+
+/*!
+    \since 6.10
+
+    Returns the limit of \a partition in bytes. The default limit is
+    10 MB.
+
+    \sa setPartitionLimit()
+*/
+qint64 QPixmapCache::partitionLimit(const QString &partition)
+{
+    return pm_cache_partitions()->partition(partition)->limit.loadRelaxed();
+}
+
+/*!
+    \since 6.10
+
+    Sets the eviction policy of \a partition to \a policy. The default is
+    EvictionPolicy::LeastRecentlyUsed.
+*/
+void QPixmapCache::setPartitionEvictionPolicy(const QString &partition, EvictionPolicy policy)
+{
+    pm_cache_partitions()->partition(partition)->policy.storeRelaxed(int(policy));
+}
+
+/*!
+    \since 6.10
+
+    Returns the eviction policy of \a partition.
+*/
+QPixmapCache::EvictionPolicy QPixmapCache::partitionEvictionPolicy(const QString &partition)
+{
+    return EvictionPolicy(pm_cache_partitions()->partition(partition)->policy.loadRelaxed());
+}
+
+/*!
+    \since 6.10
+
+    Looks for the pixmap associated with \a key in \a partition. If the
+    pixmap is found, the function sets \a pixmap to it and returns \c true;
+    otherwise it returns \c false.
+*/
+bool QPixmapCache::find(const QString &partition, const QString &key, QPixmap *pixmap)
+{
+    if (key.isEmpty() || !qt_pixmapcache_thread_test())
+        return false;
+    return pm_cache_partitions()->partition(partition)->find(key, pixmap);
+}
+
+/*!
+    \since 6.10
+
+    Inserts a copy of \a pixmap associated with \a key into \a partition,
+    replacing the entry for \a key, and evicts entries from the partition
+    if it exceeds its limit. Returns \c false if the pixmap is larger than
+    the limit of the partition.
+*/
+bool QPixmapCache::insert(const QString &partition, const QString &key, const QPixmap &pixmap)
+{
+    if (key.isEmpty() || !qt_pixmapcache_thread_test())
+        return false;
+    QPixmapCachePartition::Entry entry;
+    entry.pixmap = pixmap;
+    entry.cost = byteCost(pixmap);
+    entry.isPixmap = true;
+    return pm_cache_partitions()->partition(partition)->insert(key, std::move(entry));
+}
+
+/*!
+    \since 6.10
+
+    Looks for the image associated with \a key in \a partition. If the
+    image is found, the function sets \a image to it and returns \c true;
+    otherwise it returns \c false.
+
+    This function can be called from any thread.
+*/
+bool QPixmapCache::findImage(const QString &partition, const QString &key, QImage *image)
+{
+    if (key.isEmpty())
+        return false;
+    return pm_cache_partitions()->partition(partition)->find(key, image);
+}
+
+/*!
+    \since 6.10
+
+    Inserts a copy of \a image associated with \a key into \a partition,
+    replacing the entry for \a key, and evicts entries from the partition
+    if it exceeds its limit. Returns \c false if the image is larger than
+    the limit of the partition, or if \a key refers to a pixmap and the
+    function is not called from the main thread.
+
+    This function can be called from any thread.
+*/
+bool QPixmapCache::insertImage(const QString &partition, const QString &key, const QImage &image)
+{
+    if (key.isEmpty())
+        return false;
+    QPixmapCachePartition::Entry entry;
+    entry.image = image;
+    entry.cost = qMax<qint64>(1, image.sizeInBytes());
+    return pm_cache_partitions()->partition(partition)->insert(key, std::move(entry));
+}
+
+/*!
+    \since 6.10
+
+    Removes the entry associated with \a key from \a partition. Pixmaps
+    are only removed from the main thread.
+*/
+void QPixmapCache::remove(const QString &partition, const QString &key)
+{
+    if (key.isEmpty())
+        return;
+    pm_cache_partitions()->partition(partition)->remove(key);
+}
+
+/*!
+    \since 6.10
+
+    Removes all entries from \a partition. Pixmaps are only removed from
+    the main thread. The limit, the eviction policy and the counters of
+    the partition are kept.
+*/
+void QPixmapCache::clearPartition(const QString &partition)
+{
+    pm_cache_partitions()->partition(partition)->clear();
+}
+
+/*!
+    \since 6.10
+
+    Returns the counters of the default cache, the one that pixmaps
+    inserted without a partition go to. Outside the main thread, the
+    counters are all zero.
+*/
+QPixmapCache::Statistics QPixmapCache::statistics()
+{
+    Statistics statistics;
+    if (!qt_pixmapcache_thread_test())
+        return statistics;
+    const QPMCache *cache = pm_cache();
+    statistics.hits = cache->hits;
+    statistics.misses = cache->misses;
+    statistics.insertions = cache->insertions;
+    statistics.evictions = cache->evictions;
+    statistics.residentBytes = qint64(cache->totalCost()) * 1024;
+    statistics.byteLimit = qint64(cache->maxCost()) * 1024;
+    statistics.entryCount = cache->size();
+    return statistics;
+}
+
+/*!
+    \since 6.10
+
+    Returns the counters of \a partition.
+*/
+QPixmapCache::Statistics QPixmapCache::statistics(const QString &partition)
+{
+    return pm_cache_partitions()->partition(partition)->statistics();
+}
+
+/*!
+    \since 6.10
+
+    Prints the counters of the default cache and of every partition with
+    qDebug(), one line per cache.
+*/
+void QPixmapCache::dumpStatistics()
+{
+    const auto print = [](const QString &name, const Statistics &s) {
+        qDebug("QPixmapCache %s: %lld entries, %lld of %lld bytes, %llu hits, %llu misses, "
+               "%llu insertions, %llu evictions",
+               qPrintable(name), qlonglong(s.entryCount), qlonglong(s.residentBytes),
+               qlonglong(s.byteLimit), qulonglong(s.hits), qulonglong(s.misses),
+               qulonglong(s.insertions), qulonglong(s.evictions));
+    };
+    if (qt_pixmapcache_thread_test())
+        print(QStringLiteral("(default)"), statistics());
+    const QStringList names = partitions();
+    for (const QString &name : names)
+        print(u'"' + name + u'"', statistics(name));
+}
+
 /*!
    \fn QPixmapCache::KeyData::KeyData()
 
@@ -6,6 +6,7 @@
 
 #include <QtGui/qtguiglobal.h>
 #include <QtGui/qpixmap.h>
+#include <QtGui/qimage.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -40,6 +41,22 @@ public:
         friend class QPixmapCache;
     };
 
+    enum class EvictionPolicy {
+        LeastRecentlyUsed,
+        CostAware
+    };
+
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 insertions = 0;
+        quint64 evictions = 0;
+        qint64 residentBytes = 0;
+        qint64 byteLimit = 0;
+        qsizetype entryCount = 0;
+    };
+
     static int cacheLimit();
     static void setCacheLimit(int);
     static bool find(const QString &key, QPixmap *pixmap);
@@ -54,6 +71,22 @@ public:
     static void remove(const QString &key);
     static void remove(const Key &key);
     static void clear();
+
+    static QStringList partitions();
+    static void setPartitionLimit(const QString &partition, qint64 bytes);
+    static qint64 partitionLimit(const QString &partition);
+    static void setPartitionEvictionPolicy(const QString &partition, EvictionPolicy policy);
+    static EvictionPolicy partitionEvictionPolicy(const QString &partition);
+    static bool find(const QString &partition, const QString &key, QPixmap *pixmap);
+    static bool insert(const QString &partition, const QString &key, const QPixmap &pixmap);
+    static bool findImage(const QString &partition, const QString &key, QImage *image);
+    static bool insertImage(const QString &partition, const QString &key, const QImage &image);
+    static void remove(const QString &partition, const QString &key);
+    static void clearPartition(const QString &partition);
+
+    static Statistics statistics();
+    static Statistics statistics(const QString &partition);
+    static void dumpStatistics();
 };
 Q_DECLARE_SHARED(QPixmapCache::Key)
 
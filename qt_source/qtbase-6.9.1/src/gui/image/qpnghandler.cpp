@@ -16,10 +16,19 @@
 #include <private/qimage_p.h> // for qt_getImageText
 
 #include <qcolorspace.h>
+#include <qendian.h>
+#include <qsemaphore.h>
+#include <qthreadpool.h>
 #include <private/qcolorspace_p.h>
+#include <private/qguiapplication_p.h>
+#include <private/qimagedecimator_p.h>
 
 #include <png.h>
 #include <pngconf.h>
+#include <zlib.h>
+
+#include <deque>
+#include <memory>
 
 #if PNG_LIBPNG_VER >= 10400 && PNG_LIBPNG_VER <= 10502 \
         && defined(PNG_PEDANTIC_WARNINGS_SUPPORTED)
@@ -93,6 +102,11 @@ public:
     png_info *end_info;
     png_byte **row_pointers;
 
+    QRect clipRect;
+    QSize scaledSize;
+    QByteArray rowBuffer;
+    std::unique_ptr<QImageDecimator> decimator;
+
     bool readPngHeader();
     bool readPngImage(QImage *image);
     void readPngTexts(png_info *info);
@@ -123,6 +137,10 @@ public:
     bool writeImage(const QImage& img, int compression, const QString &description)
         { return writeImage(img, compression, description, 0, 0); }
 
+    bool writeHeader(const QImage &image, const QSize &size, int compression_in,
+                     const QString &description, int off_x, int off_y,
+                     png_structp *png_ptr_out, png_infop *info_ptr_out);
+
     QIODevice* device() { return dev; }
 
 private:
@@ -182,7 +200,7 @@ void qpiw_flush_fn(png_structp /* png_ptr */)
 }
 
 static
-bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr)
+bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr, const QSize &targetSize)
 {
     png_uint_32 width = 0;
     png_uint_32 height = 0;
@@ -194,7 +212,7 @@ bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr)
     png_colorp palette = nullptr;
     int num_palette;
     png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
-    QSize size(width, height);
+    QSize size = targetSize.isValid() ? targetSize : QSize(width, height);
     png_set_interlace_handling(png_ptr);
 
     if (color_type == PNG_COLOR_TYPE_GRAY) {
@@ -270,7 +288,8 @@ bool setup_qt(QImage& image, png_structp png_ptr, png_infop info_ptr)
             png_set_packing(png_ptr);
         png_read_update_info(png_ptr, info_ptr);
         png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type, nullptr, nullptr, nullptr);
-        size = QSize(width, height);
+        if (!targetSize.isValid())
+            size = QSize(width, height);
         QImage::Format format = bit_depth == 1 ? QImage::Format_Mono : QImage::Format_Indexed8;
         if (!QImageIOHandler::allocateImage(size, format, &image))
             return false;
@@ -509,6 +528,8 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
         png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
         png_ptr = nullptr;
         delete[] row_pointers;
+        rowBuffer.clear();
+        decimator.reset();
         state = Error;
         return false;
     }
@@ -521,7 +542,22 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
         colorSpaceState = GammaChrm;
     }
 
-    if (!setup_qt(*outImage, png_ptr, info_ptr)) {
+    // Interlaced images are decoded in full, and cropped and scaled after.
+    const QSize imageSize(png_get_image_width(png_ptr, info_ptr),
+                          png_get_image_height(png_ptr, info_ptr));
+    const QRect sourceRect = QImageDecimator::sourceRect(imageSize, clipRect);
+    const QSize targetSize = QImageDecimator::targetSize(sourceRect, scaledSize);
+    const bool partial = sourceRect.size() != imageSize || targetSize != imageSize;
+    const bool region = partial
+            && png_get_interlace_type(png_ptr, info_ptr) == PNG_INTERLACE_NONE;
+    if (partial && sourceRect.isEmpty()) {
+        png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+        png_ptr = nullptr;
+        state = Error;
+        return false;
+    }
+
+    if (!setup_qt(*outImage, png_ptr, info_ptr, region ? targetSize : QSize())) {
         png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
         png_ptr = nullptr;
         delete[] row_pointers;
@@ -541,12 +577,25 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
     png_get_oFFs(png_ptr, info_ptr, &offset_x, &offset_y, &unit_type);
     uchar *data = outImage->bits();
     qsizetype bpl = outImage->bytesPerLine();
-    row_pointers = new png_bytep[height];
+    uint rowsRead = height;
+    if (region) {
+        // Only the rows down to the bottom of the clip rectangle are read.
+        decimator.reset(new QImageDecimator(outImage, sourceRect));
+        rowBuffer.resize(png_get_rowbytes(png_ptr, info_ptr));
+        for (rowsRead = 0; rowsRead < height && !decimator->isDone(); ++rowsRead) {
+            png_read_row(png_ptr, reinterpret_cast<png_bytep>(rowBuffer.data()), nullptr);
+            decimator->addRow(rowsRead, reinterpret_cast<const uchar *>(rowBuffer.constData()));
+        }
+        decimator.reset();
+        rowBuffer.clear();
+    } else {
+        row_pointers = new png_bytep[height];
 
-    for (uint y = 0; y < height; y++)
-        row_pointers[y] = data + y * bpl;
+        for (uint y = 0; y < height; y++)
+            row_pointers[y] = data + y * bpl;
 
-    png_read_image(png_ptr, row_pointers);
+        png_read_image(png_ptr, row_pointers);
+    }
 
     outImage->setDotsPerMeterX(png_get_x_pixels_per_meter(png_ptr,info_ptr));
     outImage->setDotsPerMeterY(png_get_y_pixels_per_meter(png_ptr,info_ptr));
@@ -557,9 +606,9 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
            // sanity check palette entries
     if (color_type == PNG_COLOR_TYPE_PALETTE && outImage->format() == QImage::Format_Indexed8) {
         int color_table_size = outImage->colorCount();
-        for (int y=0; y<(int)height; ++y) {
+        for (int y=0; y<outImage->height(); ++y) {
             uchar *p = FAST_SCAN_LINE(data, bpl, y);
-            uchar *end = p + width;
+            uchar *end = p + outImage->width();
             while (p < end) {
                 if (*p >= color_table_size)
                     *p = 0;
@@ -568,10 +617,26 @@ bool QPngHandlerPrivate::readPngImage(QImage *outImage)
         }
     }
 
-    state = ReadingEnd;
-    png_read_end(png_ptr, end_info);
+    if (partial && !region) {
+        *outImage = QImageDecimator::decimate(*outImage, sourceRect, targetSize);
+        if (outImage->isNull()) {
+            png_destroy_read_struct(&png_ptr, &info_ptr, &end_info);
+            png_ptr = nullptr;
+            delete[] row_pointers;
+            row_pointers = nullptr;
+            state = Error;
+            return false;
+        }
+    }
+
+    // The chunks after the image data are not reached when the rows below
+    // the clip rectangle are skipped.
+    if (rowsRead == height) {
+        state = ReadingEnd;
+        png_read_end(png_ptr, end_info);
 
-    readPngTexts(end_info);
+        readPngTexts(end_info);
+    }
     for (int i = 0; i < readTexts.size()-1; i+=2)
         outImage->setText(readTexts.at(i), readTexts.at(i+1));
 
@@ -630,6 +695,366 @@ QImage::Format QPngHandlerPrivate::readImageFormat()
         return format;
 }
 
+// Returns the format whose scanlines hold the bytes of a row of the PNG
+// image written from image, or Format_Invalid if the rows have to be
+// written through libpng.
+static QImage::Format png_row_format(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_Invalid:
+    case QImage::Format_Mono:
+    case QImage::Format_MonoLSB:
+    case QImage::Format_Grayscale16:
+    case QImage::Format_RGBX64:
+    case QImage::Format_RGBA64:
+    case QImage::Format_RGBA64_Premultiplied:
+        return QImage::Format_Invalid;
+    case QImage::Format_Indexed8:
+    case QImage::Format_Grayscale8:
+        return image.format();
+    default:
+        return image.hasAlphaChannel() ? QImage::Format_RGBA8888 : QImage::Format_RGB888;
+    }
+}
+
+static inline uchar png_paeth(int a, int b, int c)
+{
+    const int p = a + b - c;
+    const int pa = qAbs(p - a);
+    const int pb = qAbs(p - b);
+    const int pc = qAbs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+static inline quint64 png_filter_cost(const uchar *filtered, qsizetype n)
+{
+    quint64 cost = 0;
+    for (qsizetype i = 0; i < n; ++i)
+        cost += filtered[i] < 128 ? filtered[i] : 256 - filtered[i];
+    return cost;
+}
+
+// Stores the filter type and the filtered bytes of the n bytes of row in out.
+// With scratch space for four rows, the filter is chosen the way libpng
+// chooses it, by the smallest sum of the filtered bytes taken as signed
+// values; otherwise the row is not filtered.
+static void png_filter_row(uchar *out, const uchar *row, const uchar *prior, qsizetype n,
+                           int bpp, uchar *scratch)
+{
+    out[0] = 0;
+    memcpy(out + 1, row, n);
+    if (!scratch)
+        return;
+
+    uchar *sub = scratch;
+    uchar *up = scratch + n;
+    uchar *average = scratch + 2 * n;
+    uchar *paeth = scratch + 3 * n;
+    for (qsizetype i = 0; i < n; ++i) {
+        const int a = i >= bpp ? row[i - bpp] : 0;
+        const int b = prior[i];
+        const int c = i >= bpp ? prior[i - bpp] : 0;
+        sub[i] = row[i] - a;
+        up[i] = row[i] - b;
+        average[i] = row[i] - ((a + b) >> 1);
+        paeth[i] = row[i] - png_paeth(a, b, c);
+    }
+
+    quint64 best = png_filter_cost(row, n);
+    for (int filter = 1; filter <= 4; ++filter) {
+        const uchar *filtered = scratch + (filter - 1) * n;
+        const quint64 cost = png_filter_cost(filtered, n);
+        if (cost < best) {
+            best = cost;
+            out[0] = filter;
+            memcpy(out + 1, filtered, n);
+        }
+    }
+}
+
+/*
+    Writes the image data of a PNG file as a series of bands of rows that
+    are filtered and deflated concurrently in the Qt GUI thread pool.
+
+    Every band is compressed as a raw deflate stream of its own that ends
+    with a sync flush, which leaves it byte aligned and not final, so the
+    streams can be concatenated into the zlib stream of the IDAT chunks.
+    The Adler-32 checksums of the bands are combined into the checksum of
+    the whole stream. Finished bands are written in order while later bands
+    are still being encoded, and the number of bands in flight is bounded,
+    so memory use does not depend on the height of the image.
+*/
+class QPngImageDataEncoder
+{
+public:
+    QPngImageDataEncoder(QIODevice *device, QImage::Format rowFormat, int width, int compression);
+    ~QPngImageDataEncoder();
+
+    static bool isParallel(int width, int height);
+
+    bool addRows(const QImage &rows);
+    bool finish();
+
+private:
+    Q_DISABLE_COPY_MOVE(QPngImageDataEncoder)
+
+    struct Band
+    {
+        QImage source;
+        int y = 0;
+        int height = 0;
+        QImage prior;           // holds the row above the band, if any
+        int priorY = -1;
+        QByteArray data;        // the deflated rows
+        uLong adler = 1;
+        qsizetype length = 0;   // the size of the filtered rows
+        bool ok = false;
+        QSemaphore done;
+    };
+
+    enum {
+        BandSize = 512 * 1024,  // filtered bytes per band
+        ChunkSize = 256 * 1024  // data bytes per IDAT chunk
+    };
+
+    void encode(Band *band) const;
+    bool writeBand(Band *band);
+    bool writeData(const char *data, qsizetype length);
+    bool writeChunk(const char *type, const char *data, qsizetype length);
+
+    QIODevice *m_device;
+    QImage::Format m_rowFormat;
+    int m_width;
+    int m_level;
+    int m_bytesPerPixel;
+    int m_bandHeight;
+    QImage m_previous;
+    int m_previousY = -1;
+    std::deque<std::unique_ptr<Band>> m_pending;
+    qsizetype m_maxPending = 1;
+    QThreadPool *m_threadPool = nullptr;
+    QByteArray m_buffer;
+    uLong m_adler = 1;
+    bool m_ok = true;
+};
+
+QPngImageDataEncoder::QPngImageDataEncoder(QIODevice *device, QImage::Format rowFormat, int width,
+                                           int compression)
+    : m_device(device), m_rowFormat(rowFormat), m_width(width),
+      m_level(compression < 0 ? Z_DEFAULT_COMPRESSION : qMin(compression, 9))
+{
+    m_bytesPerPixel = rowFormat == QImage::Format_RGBA8888 ? 4
+                    : rowFormat == QImage::Format_RGB888 ? 3 : 1;
+    const qsizetype rowBytes = qsizetype(width) * m_bytesPerPixel + 1;
+    m_bandHeight = int(qMax<qsizetype>(1, BandSize / rowBytes));
+
+#if QT_CONFIG(qtgui_threadpool)
+    m_threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    if (m_threadPool && m_threadPool->contains(QThread::currentThread()))
+        m_threadPool = nullptr;
+    if (m_threadPool)
+        m_maxPending = 2 * qMax(1, m_threadPool->maxThreadCount());
+#endif
+
+    // The zlib header; the window size is 32 kB and the level is a hint.
+    const int level = m_level == Z_DEFAULT_COMPRESSION ? 6 : m_level;
+    const int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    const int cmf = 0x78;
+    int flg = flevel << 6;
+    flg |= 31 - (cmf * 256 + flg) % 31;
+    m_buffer.append(char(cmf));
+    m_buffer.append(char(flg));
+}
+
+QPngImageDataEncoder::~QPngImageDataEncoder()
+{
+    for (const auto &band : m_pending)
+        band->done.acquire();
+}
+
+/*
+    Returns \c true if an image of the given size is large enough to be
+    encoded in parallel, and there is a thread pool to encode it in.
+*/
+bool QPngImageDataEncoder::isParallel(int width, int height)
+{
+#if QT_CONFIG(qtgui_threadpool)
+    if (qsizetype(width) * height < 1024 * 1024)
+        return false;
+    QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    return threadPool && threadPool->maxThreadCount() > 1
+        && !threadPool->contains(QThread::currentThread());
+#else
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+    return false;
+#endif
+}
+
+// Filters and deflates the rows of band; runs in the thread pool.
+void QPngImageDataEncoder::encode(Band *band) const
+{
+    const auto rowsOf = [this](const QImage &source, int y, int height) {
+        QImage view(source.constScanLine(y), source.width(), height, source.bytesPerLine(),
+                    source.format());
+        if (source.format() == QImage::Format_Indexed8)
+            view.setColorTable(source.colorTable());
+        view.setColorSpace(source.colorSpace());
+        return view.format() == m_rowFormat ? view : view.convertToFormat(m_rowFormat);
+    };
+
+    const QImage rows = rowsOf(band->source, band->y, band->height);
+    const QImage prior = band->prior.isNull() ? QImage() : rowsOf(band->prior, band->priorY, 1);
+    if (rows.isNull() || (!band->prior.isNull() && prior.isNull()))
+        return;
+
+    const qsizetype rowBytes = qsizetype(m_width) * m_bytesPerPixel;
+    const bool adaptive = m_level != 0 && m_rowFormat != QImage::Format_Indexed8;
+    QByteArray filtered((rowBytes + 1) * band->height, Qt::Uninitialized);
+    QByteArray scratch(adaptive ? 4 * rowBytes : 0, Qt::Uninitialized);
+    const QByteArray zeros(prior.isNull() ? rowBytes : 0, '\0');
+    const uchar *above = prior.isNull() ? reinterpret_cast<const uchar *>(zeros.constData())
+                                        : prior.constScanLine(0);
+    uchar *out = reinterpret_cast<uchar *>(filtered.data());
+    for (int y = 0; y < band->height; ++y) {
+        const uchar *row = rows.constScanLine(y);
+        png_filter_row(out, row, above, rowBytes, m_bytesPerPixel,
+                       adaptive ? reinterpret_cast<uchar *>(scratch.data()) : nullptr);
+        above = row;
+        out += rowBytes + 1;
+    }
+    band->length = filtered.size();
+    band->adler = adler32(adler32(0, nullptr, 0),
+                          reinterpret_cast<const Bytef *>(filtered.constData()), uInt(filtered.size()));
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, m_level, Z_DEFLATED, -MAX_WBITS, 8,
+                     adaptive ? Z_FILTERED : Z_DEFAULT_STRATEGY) != Z_OK) {
+        return;
+    }
+    band->data.resize(qsizetype(deflateBound(&stream, uLong(filtered.size()))) + 16);
+    stream.next_in = reinterpret_cast<Bytef *>(filtered.data());
+    stream.avail_in = uInt(filtered.size());
+    stream.next_out = reinterpret_cast<Bytef *>(band->data.data());
+    stream.avail_out = uInt(band->data.size());
+    int result;
+    for (;;) {
+        result = deflate(&stream, Z_SYNC_FLUSH);
+        if (result != Z_OK || (stream.avail_in == 0 && stream.avail_out != 0))
+            break;
+        const qsizetype written = band->data.size() - stream.avail_out;
+        band->data.resize(band->data.size() * 2);
+        stream.next_out = reinterpret_cast<Bytef *>(band->data.data()) + written;
+        stream.avail_out = uInt(band->data.size() - written);
+    }
+    band->data.resize(band->data.size() - stream.avail_out);
+    deflateEnd(&stream);
+    band->ok = result == Z_OK;
+}
+
+/*
+    Encodes the rows of \a rows, which follow the rows added before.
+    Returns \c false if the image data could not be written.
+*/
+bool QPngImageDataEncoder::addRows(const QImage &rows)
+{
+    for (int y = 0; y < rows.height() && m_ok; y += m_bandHeight) {
+        auto band = std::make_unique<Band>();
+        band->source = rows;
+        band->y = y;
+        band->height = qMin(m_bandHeight, rows.height() - y);
+        band->prior = m_previous;
+        band->priorY = m_previousY;
+        m_previous = rows;
+        m_previousY = y + band->height - 1;
+
+        Band *b = band.get();
+        m_pending.push_back(std::move(band));
+        if (m_threadPool) {
+            m_threadPool->start([this, b]() {
+                encode(b);
+                b->done.release();
+            });
+        } else {
+            encode(b);
+            b->done.release();
+        }
+
+        while (!m_pending.empty() && m_pending.front()->done.tryAcquire())
+            m_ok = writeBand(m_pending.front().get()) && m_ok;
+        while (qsizetype(m_pending.size()) > m_maxPending) {
+            m_pending.front()->done.acquire();
+            m_ok = writeBand(m_pending.front().get()) && m_ok;
+        }
+    }
+    return m_ok;
+}
+
+// Writes the first pending band, which has been encoded, and drops it.
+bool QPngImageDataEncoder::writeBand(Band *band)
+{
+    const bool ok = band->ok
+        && writeData(band->data.constData(), band->data.size());
+    m_adler = adler32_combine(m_adler, band->adler, band->length);
+    m_pending.pop_front();
+    return ok;
+}
+
+/*
+    Writes the remaining image data and the end of the file. Returns
+    \c false if the image data could not be written.
+*/
+bool QPngImageDataEncoder::finish()
+{
+    while (!m_pending.empty()) {
+        m_pending.front()->done.acquire();
+        m_ok = writeBand(m_pending.front().get()) && m_ok;
+    }
+    if (!m_ok)
+        return false;
+
+    // An empty final block with fixed codes ends the deflate stream.
+    const uchar trailer[6] = { 0x03, 0x00, uchar(m_adler >> 24), uchar(m_adler >> 16),
+                               uchar(m_adler >> 8), uchar(m_adler) };
+    if (!writeData(reinterpret_cast<const char *>(trailer), sizeof(trailer)))
+        return false;
+    if (!m_buffer.isEmpty() && !writeChunk("IDAT", m_buffer.constData(), m_buffer.size()))
+        return false;
+    m_buffer.clear();
+    return writeChunk("IEND", nullptr, 0);
+}
+
+bool QPngImageDataEncoder::writeData(const char *data, qsizetype length)
+{
+    m_buffer.append(data, length);
+    qsizetype written = 0;
+    while (m_buffer.size() - written >= ChunkSize) {
+        if (!writeChunk("IDAT", m_buffer.constData() + written, ChunkSize))
+            return false;
+        written += ChunkSize;
+    }
+    m_buffer.remove(0, written);
+    return true;
+}
+
+bool QPngImageDataEncoder::writeChunk(const char *type, const char *data, qsizetype length)
+{
+    uchar header[8];
+    qToBigEndian<quint32>(quint32(length), header);
+    memcpy(header + 4, type, 4);
+    uLong crc = crc32(crc32(0, nullptr, 0), header + 4, 4);
+    if (length)
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(data), uInt(length));
+    uchar trailer[4];
+    qToBigEndian<quint32>(quint32(crc), trailer);
+    return m_device->write(reinterpret_cast<const char *>(header), 8) == 8
+        && (!length || m_device->write(data, length) == length)
+        && m_device->write(reinterpret_cast<const char *>(trailer), 4) == 4;
+}
+
 QPNGImageWriter::QPNGImageWriter(QIODevice* iod) :
     dev(iod),
     frames_written(0),
@@ -727,8 +1152,12 @@ bool QPNGImageWriter::writeImage(const QImage& image, int off_x, int off_y)
     return writeImage(image, -1, QString(), off_x, off_y);
 }
 
-bool QPNGImageWriter::writeImage(const QImage& image, int compression_in, const QString &description,
-                                 int off_x_in, int off_y_in)
+// Writes the signature and all chunks that precede the image data of an
+// image of the given size with the format and metadata of image, and
+// returns the write structures that are set up to write its rows.
+bool QPNGImageWriter::writeHeader(const QImage& image, const QSize &size, int compression_in,
+                                  const QString &description, int off_x_in, int off_y_in,
+                                  png_structp *png_ptr_out, png_infop *info_ptr_out)
 {
     QPoint offset = image.offset();
     int off_x = off_x_in + offset.x();
@@ -802,7 +1231,7 @@ bool QPNGImageWriter::writeImage(const QImage& image, int compression_in, const
         break;
     }
 
-    png_set_IHDR(png_ptr, info_ptr, image.width(), image.height(),
+    png_set_IHDR(png_ptr, info_ptr, size.width(), size.height(),
                  bpc, // per channel
                  color_type, 0, 0, 0);       // sets #channels
 
@@ -951,6 +1380,37 @@ bool QPNGImageWriter::writeImage(const QImage& image, int compression_in, const
         png_write_chunk(png_ptr, const_cast<png_bytep>((const png_byte *)"gIFg"), data, 4);
     }
 
+    *png_ptr_out = png_ptr;
+    *info_ptr_out = info_ptr;
+    return true;
+}
+
+bool QPNGImageWriter::writeImage(const QImage& image, int compression_in, const QString &description,
+                                 int off_x_in, int off_y_in)
+{
+    png_structp png_ptr = nullptr;
+    png_infop info_ptr = nullptr;
+    if (!writeHeader(image, image.size(), compression_in, description, off_x_in, off_y_in,
+                     &png_ptr, &info_ptr)) {
+        return false;
+    }
+
+    const QImage::Format rowFormat = png_row_format(image);
+    if (rowFormat != QImage::Format_Invalid
+        && QPngImageDataEncoder::isParallel(image.width(), image.height())) {
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        QPngImageDataEncoder encoder(dev, rowFormat, image.width(), compression_in);
+        if (!encoder.addRows(image) || !encoder.finish())
+            return false;
+        frames_written++;
+        return true;
+    }
+
+    if (setjmp(png_jmpbuf(png_ptr))) {
+        png_destroy_write_struct(&png_ptr, &info_ptr);
+        return false;
+    }
+
     int height = image.height();
     int width = image.width();
     switch (image.format()) {
@@ -1026,6 +1486,185 @@ static bool write_png_image(const QImage &image, QIODevice *device,
     return writer.writeImage(image, compression, description);
 }
 
+class QPngBandWriterPrivate
+{
+public:
+    explicit QPngBandWriterPrivate(QIODevice *device)
+        : writer(device)
+    { }
+
+    QPNGImageWriter writer;
+    std::unique_ptr<QPngImageDataEncoder> encoder;
+    QSize size;
+    int compression = -1;
+    QString description;
+    int rowsWritten = 0;
+    bool error = false;
+};
+
+/*!
+    \class QPngBandWriter
+    \internal
+    \inmodule QtGui
+    \since 6.10
+
+    \brief The QPngBandWriter class writes a PNG image band by band.
+
+    Very large images, such as snapshots of a layout that are rendered in
+    strips, do not have to be assembled in memory before they are saved.
+    After begin(), every call to writeBand() adds the rows of a band to the
+    image; the bands are filtered and compressed in the Qt GUI thread pool
+    while the next ones are being rendered, and written to the device in
+    order as soon as they are done. end() finishes the file once all rows
+    have been written.
+
+    Only images with 8 bits per channel can be written, that is, the
+    format passed to begin() must not be an indexed, monochrome or 16-bit
+    format. The bands can be of any format; they are converted as needed.
+*/
+
+/*!
+    Constructs a writer that writes to \a device.
+*/
+QPngBandWriter::QPngBandWriter(QIODevice *device)
+    : d(new QPngBandWriterPrivate(device))
+{
+}
+
+/*!
+    Destroys the writer. An image that has not been ended is left
+    incomplete.
+*/
+QPngBandWriter::~QPngBandWriter()
+{
+    delete d;
+}
+
+/*!
+    Sets the compression of the image to \a compression, in the range 0 to
+    100 as for QImageWriter::setCompression(). The default, -1, uses the
+    default compression of zlib.
+*/
+void QPngBandWriter::setCompression(int compression)
+{
+    d->compression = compression;
+}
+
+int QPngBandWriter::compression() const
+{
+    return d->compression;
+}
+
+/*!
+    Sets the text that is stored in the image to \a description, in the
+    format described by QImageWriter::setText().
+*/
+void QPngBandWriter::setDescription(const QString &description)
+{
+    d->description = description;
+}
+
+QString QPngBandWriter::description() const
+{
+    return d->description;
+}
+
+/*!
+    Writes the header of an image of the given \a size whose rows have the
+    given \a format and \a colorSpace. Returns \c false if the format is
+    not supported or the header could not be written.
+*/
+bool QPngBandWriter::begin(const QSize &size, QImage::Format format, const QColorSpace &colorSpace)
+{
+    if (d->encoder || size.isEmpty() || format == QImage::Format_Indexed8) {
+        d->error = true;
+        return false;
+    }
+
+    QImage prototype(1, 1, format);
+    const QImage::Format rowFormat = png_row_format(prototype);
+    if (rowFormat == QImage::Format_Invalid) {
+        d->error = true;
+        return false;
+    }
+    if (colorSpace.isValid())
+        prototype.setColorSpace(colorSpace);
+
+    int compression = d->compression;
+    if (compression >= 0)
+        compression = (qMin(compression, 100) * 9) / 91; // map [0,100] -> [0,9]
+
+    png_structp png_ptr = nullptr;
+    png_infop info_ptr = nullptr;
+    if (!d->writer.writeHeader(prototype, size, compression, d->description, 0, 0,
+                               &png_ptr, &info_ptr)) {
+        d->error = true;
+        return false;
+    }
+    png_destroy_write_struct(&png_ptr, &info_ptr);
+
+    d->encoder.reset(new QPngImageDataEncoder(d->writer.device(), rowFormat, size.width(),
+                                              compression));
+    d->size = size;
+    d->rowsWritten = 0;
+    d->error = false;
+    return true;
+}
+
+/*!
+    Adds the rows of \a band to the image, below the rows written before.
+    The band must be as wide as the image. Returns \c false if the band
+    does not fit the image or the image data could not be written.
+
+    The band is shared with the writer until it has been compressed;
+    modifying it afterwards detaches it.
+*/
+bool QPngBandWriter::writeBand(const QImage &band)
+{
+    if (!d->encoder || d->error || band.isNull() || band.width() != d->size.width()
+        || band.height() > d->size.height() - d->rowsWritten) {
+        d->error = true;
+        return false;
+    }
+    if (!d->encoder->addRows(band)) {
+        d->error = true;
+        return false;
+    }
+    d->rowsWritten += band.height();
+    return true;
+}
+
+/*!
+    Writes the rest of the image data and the end of the file. Returns
+    \c false if not all rows of the image have been written, or if the
+    data could not be written.
+*/
+bool QPngBandWriter::end()
+{
+    if (!d->encoder)
+        return false;
+    const bool ok = !d->error && d->rowsWritten == d->size.height() && d->encoder->finish();
+    d->encoder.reset();
+    d->error = !ok;
+    return ok;
+}
+
+/*!
+    Returns the number of rows that have been written.
+*/
+int QPngBandWriter::rowsWritten() const
+{
+    return d->rowsWritten;
+}
+
+/*!
+    Returns \c true if a call to begin(), writeBand() or end() failed.
+*/
+bool QPngBandWriter::hasError() const
+{
+    return d->error;
+}
+
 QPngHandler::QPngHandler()
     : d(new QPngHandlerPrivate(this))
 {
@@ -1080,7 +1719,9 @@ bool QPngHandler::supportsOption(ImageOption option) const
         || option == ImageFormat
         || option == Quality
         || option == CompressionRatio
-        || option == Size;
+        || option == Size
+        || option == ClipRect
+        || option == ScaledSize;
 }
 
 QVariant QPngHandler::option(ImageOption option) const
@@ -1103,6 +1744,10 @@ QVariant QPngHandler::option(ImageOption option) const
                      png_get_image_height(d->png_ptr, d->info_ptr));
     else if (option == ImageFormat)
         return d->readImageFormat();
+    else if (option == ClipRect)
+        return d->clipRect;
+    else if (option == ScaledSize)
+        return d->scaledSize;
     return QVariant();
 }
 
@@ -1116,6 +1761,10 @@ void QPngHandler::setOption(ImageOption option, const QVariant &value)
         d->compression = value.toInt();
     else if (option == Description)
         d->description = value.toString();
+    else if (option == ClipRect)
+        d->clipRect = value.toRect();
+    else if (option == ScaledSize)
+        d->scaledSize = value.toSize();
 }
 
 QT_END_NAMESPACE
@@ -269,6 +269,42 @@ static bool read_pbm_body(QIODevice *device, char type, int w, int h, int mcc, Q
     return true;
 }
 
+// Maps the raw pixel data of a PBM, PGM or PPM file whose layout matches a
+// QImage format: bitmaps, and gray and color images with a maximum value of
+// 255. Color images become RGB888 rather than RGB32.
+static bool map_pbm_body(QIODevice *device, char type, int w, int h, int mcc, QImage *outImage)
+{
+    QImage::Format format;
+    qsizetype bpl;
+    switch (type) {
+    case '4':
+        format = QImage::Format_Mono;
+        bpl = (qsizetype(w) + 7) / 8;
+        break;
+    case '5':
+        format = QImage::Format_Grayscale8;
+        bpl = w;
+        break;
+    case '6':
+        format = QImage::Format_RGB888;
+        bpl = qsizetype(w) * 3;
+        break;
+    default:
+        return false;
+    }
+    if (type != '4' && mcc != 255)
+        return false;
+
+    const qint64 offset = device->pos();
+    QImage image = qt_mapImage(device, offset, QSize(w, h), bpl, format);
+    if (image.isNull() || !device->seek(offset + bpl * h))
+        return false;
+    if (format == QImage::Format_Mono)
+        image.setColorTable({ qRgb(255, 255, 255), qRgb(0, 0, 0) });
+    *outImage = image;
+    return true;
+}
+
 static bool write_pbm_image(QIODevice *out, const QImage &sourceImage, QByteArrayView sourceFormat)
 {
     QByteArray str;
@@ -421,7 +457,7 @@ static bool write_pbm_image(QIODevice *out, const QImage &sourceImage, QByteArra
 }
 
 QPpmHandler::QPpmHandler()
-    : state(Ready)
+    : state(Ready), memoryMapping(false)
 {
 }
 
@@ -486,7 +522,8 @@ bool QPpmHandler::read(QImage *image)
         return false;
     }
 
-    if (!read_pbm_body(device(), type, width, height, mcc, image)) {
+    if (!(memoryMapping && map_pbm_body(device(), type, width, height, mcc, image))
+        && !read_pbm_body(device(), type, width, height, mcc, image)) {
         state = Error;
         return false;
     }
@@ -504,7 +541,8 @@ bool QPpmHandler::supportsOption(ImageOption option) const
 {
     return option == SubType
         || option == Size
-        || option == ImageFormat;
+        || option == ImageFormat
+        || option == MemoryMappedReading;
 }
 
 QVariant QPpmHandler::option(ImageOption option) const
@@ -540,6 +578,8 @@ QVariant QPpmHandler::option(ImageOption option) const
                 break;
         }
         return format;
+    } else if (option == MemoryMappedReading) {
+        return memoryMapping;
     }
     return QVariant();
 }
@@ -548,6 +588,8 @@ void QPpmHandler::setOption(ImageOption option, const QVariant &value)
 {
     if (option == SubType)
         subType = value.toByteArray().toLower();
+    else if (option == MemoryMappedReading)
+        memoryMapping = value.toBool();
 }
 
 QT_END_NAMESPACE
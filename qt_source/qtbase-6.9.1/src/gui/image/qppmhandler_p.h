@@ -49,6 +49,7 @@ private:
     int width;
     int height;
     int mcc;
+    bool memoryMapping;
     mutable QByteArray subType;
 };
 
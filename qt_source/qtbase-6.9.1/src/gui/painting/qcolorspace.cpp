@@ -474,9 +474,65 @@ void QColorSpacePrivate::setTransferFunction()
     lut.generated.storeRelease(0);
 }
 
+namespace {
+// The most recently used transformations between color spaces. Entries are
+// found by comparing the color spaces by value, so a transform is also
+// reused for color spaces that are equal but were created separately, for
+// instance for every image loaded with the same ICC profile. Reusing the
+// transform also reuses the lookup tables it has generated. Each entry keeps
+// references to its color spaces to compare them with.
+struct QColorTransformCache
+{
+    struct Entry
+    {
+        QExplicitlySharedDataPointer<const QColorSpacePrivate> in;
+        QExplicitlySharedDataPointer<const QColorSpacePrivate> out;
+        QColorTransform transform;
+    };
+    static constexpr qsizetype MaximumSize = 16;
+
+    QMutex mutex;
+    QList<Entry> entries; // most recently used first
+};
+}
+
+Q_GLOBAL_STATIC(QColorTransformCache, qt_color_transform_cache)
+
 QColorTransform QColorSpacePrivate::transformationToColorSpace(const QColorSpacePrivate *out) const
 {
     Q_ASSERT(out);
+    const auto matches = [](const QColorSpacePrivate *cached, const QColorSpacePrivate *colorSpace) {
+        return cached == colorSpace || cached->equals(colorSpace);
+    };
+    QColorTransformCache *cache = qt_color_transform_cache();
+    if (cache) {
+        QMutexLocker locker(&cache->mutex);
+        for (qsizetype i = 0; i < cache->entries.size(); ++i) {
+            const QColorTransformCache::Entry &entry = cache->entries.at(i);
+            if (matches(entry.in.constData(), this) && matches(entry.out.constData(), out)) {
+                if (i > 0)
+                    cache->entries.move(i, 0);
+                return cache->entries.constFirst().transform;
+            }
+        }
+    }
+
+    // Identity transforms are null, and are cached as well, since finding
+    // out that a transform is the identity takes as long as creating it.
+    QColorTransform combined = createTransformationToColorSpace(out);
+    if (cache) {
+        QMutexLocker locker(&cache->mutex);
+        if (cache->entries.size() >= QColorTransformCache::MaximumSize)
+            cache->entries.removeLast();
+        cache->entries.prepend({ QExplicitlySharedDataPointer<const QColorSpacePrivate>(this),
+                                 QExplicitlySharedDataPointer<const QColorSpacePrivate>(out),
+                                 combined });
+    }
+    return combined;
+}
+
+QColorTransform QColorSpacePrivate::createTransformationToColorSpace(const QColorSpacePrivate *out) const
+{
     QColorTransform combined;
     auto ptr = new QColorTransformPrivate;
     combined.d = ptr;
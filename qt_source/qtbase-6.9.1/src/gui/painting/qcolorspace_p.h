@@ -70,6 +70,7 @@ public:
                                    const QList<uint16_t> &greenTransferFunctionTable,
                                    const QList<uint16_t> &blueTransferFunctionTable);
     QColorTransform transformationToColorSpace(const QColorSpacePrivate *out) const;
+    QColorTransform createTransformationToColorSpace(const QColorSpacePrivate *out) const;
     QColorTransform transformationToXYZ() const;
 
     bool isThreeComponentMatrix() const;
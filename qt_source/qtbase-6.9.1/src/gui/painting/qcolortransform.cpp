@@ -71,6 +71,222 @@ void QColorTransformPrivate::updateLutsOut() const
     colorSpaceOut->lut.generated.storeRelease(1);
 }
 
+Q_CONSTINIT static QBasicMutex s_lut3dLock;
+
+/*!
+    \internal
+    Returns \c true if 8-bit RGB data can be converted through a 3D lookup
+    table. Transforms between matrix based color spaces are cheap already;
+    those involving a color space described by element lists (LUT based ICC
+    profiles) evaluate their elements for every pixel.
+*/
+bool QColorTransformPrivate::canUseLut3D() const
+{
+    return colorSpaceIn->colorModel == QColorSpace::ColorModel::Rgb
+        && colorSpaceOut->colorModel == QColorSpace::ColorModel::Rgb
+        && (!colorSpaceIn->isThreeComponentMatrix() || !colorSpaceOut->isThreeComponentMatrix());
+}
+
+/*!
+    \internal
+    Bakes the transform into a lookup table of Lut3DSize nodes per axis,
+    sampled with the full precision pipeline.
+*/
+void QColorTransformPrivate::updateLut3D() const
+{
+    if (lut3dGenerated.loadAcquire())
+        return;
+    QMutexLocker lock(&s_lut3dLock);
+    if (lut3dGenerated.loadRelaxed())
+        return;
+
+    constexpr int N = Lut3DSize;
+    constexpr qsizetype nodes = N * N * N;
+    QList<QRgba64> grid(nodes);
+    qsizetype i = 0;
+    for (int r = 0; r < N; ++r) {
+        for (int g = 0; g < N; ++g) {
+            for (int b = 0; b < N; ++b)
+                grid[i++] = QRgba64::fromRgba64(r * 65535 / (N - 1), g * 65535 / (N - 1),
+                                                b * 65535 / (N - 1), 65535);
+        }
+    }
+    apply(grid.data(), grid.constData(), nodes, InputOpaque);
+
+    // The padding lets the vectorized lookup read 32 bits at the last node.
+    lut3d.resize(3 * nodes + 2);
+    quint16 *red = lut3d.data();
+    quint16 *green = red + nodes;
+    quint16 *blue = green + nodes;
+    for (i = 0; i < nodes; ++i) {
+        red[i] = grid[i].red();
+        green[i] = grid[i].green();
+        blue[i] = grid[i].blue();
+    }
+
+    lut3dGenerated.storeRelease(1);
+}
+
+// Maps an 8-bit value onto the 32 intervals of the lookup table, as the
+// interval index in the upper and the fraction of 256 in the lower bits.
+static inline int lut3DPosition(int v)
+{
+    return (v * 2056 + 32) >> 6;
+}
+
+static inline QRgb lut3DLookup(QRgb p, const quint16 *lut)
+{
+    constexpr int N = QColorTransformPrivate::Lut3DSize;
+    constexpr int nodes = N * N * N;
+    const int pr = lut3DPosition(qRed(p));
+    const int pg = lut3DPosition(qGreen(p));
+    const int pb = lut3DPosition(qBlue(p));
+    const int ir = qMin(pr >> 8, N - 2);
+    const int ig = qMin(pg >> 8, N - 2);
+    const int ib = qMin(pb >> 8, N - 2);
+    const int fr = pr - (ir << 8);
+    const int fg = pg - (ig << 8);
+    const int fb = pb - (ib << 8);
+
+    // Tetrahedral interpolation: walk from the lower to the upper corner of
+    // the cube along the axes in the order of decreasing fraction.
+    const int hi = qMax(fr, qMax(fg, fb));
+    const int lo = qMin(fr, qMin(fg, fb));
+    const int mid = fr + fg + fb - hi - lo;
+    const int maxStride = (fr >= fg && fr >= fb) ? N * N : (fg >= fb ? N : 1);
+    const int minStride = (fb <= fg && fb <= fr) ? 1 : (fg <= fr ? N : N * N);
+    const int v0 = ir * N * N + ig * N + ib;
+    const int v1 = v0 + maxStride;
+    const int v3 = v0 + N * N + N + 1;
+    const int v2 = v3 - minStride;
+    const int w0 = 256 - hi;
+    const int w1 = hi - mid;
+    const int w2 = mid - lo;
+    const int w3 = lo;
+
+    int c[3];
+    for (int i = 0; i < 3; ++i) {
+        const quint16 *plane = lut + i * nodes;
+        const int v = (w0 * plane[v0] + w1 * plane[v1] + w2 * plane[v2] + w3 * plane[v3] + 128) >> 8;
+        c[i] = (v + 128 - ((v + 128) >> 8)) >> 8;
+    }
+    return qRgba(c[0], c[1], c[2], qAlpha(p));
+}
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+// lut3DPosition() for eight values, with the interval index stored in
+// \a index and the fraction returned.
+QT_FUNCTION_TARGET(ARCH_HASWELL)
+static inline __m256i lut3DPosition_avx2(__m256i v, __m256i *index)
+{
+    const __m256i p = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(2056)),
+                                                         _mm256_set1_epi32(32)), 6);
+    *index = _mm256_min_epi32(_mm256_srli_epi32(p, 8),
+                              _mm256_set1_epi32(QColorTransformPrivate::Lut3DSize - 2));
+    return _mm256_sub_epi32(p, _mm256_slli_epi32(*index, 8));
+}
+
+// Converts the pixels in groups of eight with the arithmetic of
+// lut3DLookup() and returns the number of pixels done.
+QT_FUNCTION_TARGET(ARCH_HASWELL)
+static qsizetype lut3DLookup_avx2(QRgb *dst, const QRgb *src, qsizetype count,
+                                  const quint16 *lut, bool opaque)
+{
+    constexpr int N = QColorTransformPrivate::Lut3DSize;
+    constexpr int nodes = N * N * N;
+    const __m256i vff = _mm256_set1_epi32(0xff);
+    const __m256i vffff = _mm256_set1_epi32(0xffff);
+    const __m256i v128 = _mm256_set1_epi32(128);
+    const __m256i v256 = _mm256_set1_epi32(256);
+    const __m256i vone = _mm256_set1_epi32(1);
+    const __m256i vn = _mm256_set1_epi32(N);
+    const __m256i vnn = _mm256_set1_epi32(N * N);
+    const __m256i vdiagonal = _mm256_set1_epi32(N * N + N + 1);
+    const __m256i valphaMask = _mm256_set1_epi32(int(0xff000000));
+
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i ir, ig, ib;
+        const __m256i fr = lut3DPosition_avx2(_mm256_and_si256(_mm256_srli_epi32(p, 16), vff), &ir);
+        const __m256i fg = lut3DPosition_avx2(_mm256_and_si256(_mm256_srli_epi32(p, 8), vff), &ig);
+        const __m256i fb = lut3DPosition_avx2(_mm256_and_si256(p, vff), &ib);
+
+        const __m256i hi = _mm256_max_epi32(fr, _mm256_max_epi32(fg, fb));
+        const __m256i lo = _mm256_min_epi32(fr, _mm256_min_epi32(fg, fb));
+        const __m256i mid = _mm256_sub_epi32(_mm256_add_epi32(fr, _mm256_add_epi32(fg, fb)),
+                                             _mm256_add_epi32(hi, lo));
+        // All ones where the first operand is not smaller than the second.
+        const __m256i rgeg = _mm256_xor_si256(_mm256_cmpgt_epi32(fg, fr), _mm256_set1_epi32(-1));
+        const __m256i rgeb = _mm256_xor_si256(_mm256_cmpgt_epi32(fb, fr), _mm256_set1_epi32(-1));
+        const __m256i ggeb = _mm256_xor_si256(_mm256_cmpgt_epi32(fb, fg), _mm256_set1_epi32(-1));
+        const __m256i maxStride = _mm256_blendv_epi8(_mm256_blendv_epi8(vone, vn, ggeb), vnn,
+                                                     _mm256_and_si256(rgeg, rgeb));
+        const __m256i minStride = _mm256_blendv_epi8(_mm256_blendv_epi8(vnn, vn, rgeg), vone,
+                                                     _mm256_and_si256(ggeb, rgeb));
+
+        const __m256i v0 = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(ir, vnn),
+                                                             _mm256_mullo_epi32(ig, vn)), ib);
+        const __m256i v1 = _mm256_add_epi32(v0, maxStride);
+        const __m256i v3 = _mm256_add_epi32(v0, vdiagonal);
+        const __m256i v2 = _mm256_sub_epi32(v3, minStride);
+        const __m256i w0 = _mm256_sub_epi32(v256, hi);
+        const __m256i w1 = _mm256_sub_epi32(hi, mid);
+        const __m256i w2 = _mm256_sub_epi32(mid, lo);
+
+        __m256i c[3];
+        for (int j = 0; j < 3; ++j) {
+            const int *plane = reinterpret_cast<const int *>(lut + j * nodes);
+            const __m256i c0 = _mm256_and_si256(_mm256_i32gather_epi32(plane, v0, 2), vffff);
+            const __m256i c1 = _mm256_and_si256(_mm256_i32gather_epi32(plane, v1, 2), vffff);
+            const __m256i c2 = _mm256_and_si256(_mm256_i32gather_epi32(plane, v2, 2), vffff);
+            const __m256i c3 = _mm256_and_si256(_mm256_i32gather_epi32(plane, v3, 2), vffff);
+            __m256i v = _mm256_add_epi32(_mm256_mullo_epi32(w0, c0), _mm256_mullo_epi32(w1, c1));
+            v = _mm256_add_epi32(v, _mm256_mullo_epi32(w2, c2));
+            v = _mm256_add_epi32(v, _mm256_mullo_epi32(lo, c3));
+            v = _mm256_add_epi32(_mm256_srli_epi32(_mm256_add_epi32(v, v128), 8), v128);
+            c[j] = _mm256_srli_epi32(_mm256_sub_epi32(v, _mm256_srli_epi32(v, 8)), 8);
+        }
+
+        __m256i result = opaque ? valphaMask : _mm256_and_si256(p, valphaMask);
+        result = _mm256_or_si256(result, _mm256_slli_epi32(c[0], 16));
+        result = _mm256_or_si256(result, _mm256_slli_epi32(c[1], 8));
+        result = _mm256_or_si256(result, c[2]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), result);
+    }
+    return i;
+}
+#endif
+
+/*!
+    \internal
+    Converts \a count pixels from \a src to \a dst through the 3D lookup
+    table, which has to be generated.
+*/
+void QColorTransformPrivate::applyLut3D(QRgb *dst, const QRgb *src, qsizetype count,
+                                        TransformFlags flags) const
+{
+    const quint16 *lut = lut3d.constData();
+    const bool opaque = flags & InputOpaque;
+    qsizetype i = 0;
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (!(flags & InputPremultiplied) && qCpuHasFeature(ArchHaswell))
+        i = lut3DLookup_avx2(dst, src, count, lut, opaque);
+#endif
+    for (; i < count; ++i) {
+        QRgb p = src[i];
+        if (opaque)
+            p |= 0xff000000;
+        else if (flags & InputPremultiplied)
+            p = qUnpremultiply(p);
+        dst[i] = lut3DLookup(p, lut);
+    }
+    if ((flags & OutputPremultiplied) && !opaque) {
+        for (i = 0; i < count; ++i)
+            dst[i] = qPremultiply(dst[i]);
+    }
+}
+
 /*!
     \class QColorTransform
     \brief The QColorTransform class is a transformation between color spaces.
@@ -1970,6 +2186,14 @@ void QColorTransformPrivate::pcsAdapt(QColorVector *buffer, qsizetype count) con
 template<typename D, typename S>
 void QColorTransformPrivate::apply(D *dst, const S *src, qsizetype count, TransformFlags flags) const
 {
+    if constexpr (std::is_same_v<D, QRgb> && std::is_same_v<S, QRgb>) {
+        if ((flags & AllowLut3D) && canUseLut3D()) {
+            updateLut3D();
+            applyLut3D(dst, src, count, flags);
+            return;
+        }
+    }
+
     if (colorSpaceIn->isThreeComponentMatrix())
         updateLutsIn();
     if (colorSpaceOut->isThreeComponentMatrix())
@@ -2001,6 +2225,10 @@ void QColorTransformPrivate::apply(D *dst, const S *src, qsizetype count, Transf
     \value InputPremultiplied The input is premultiplied.
     \value OutputPremultiplied The output should be premultiplied.
     \value Premultiplied Both input and output should both be premultiplied.
+    \value AllowLut3D The 8-bit RGB data may be converted through a lookup table
+           baked from the transform, trading a little precision for speed
+           on large images. QImage sets it when it is passed
+           Qt::ApproximateColorTransform.
 */
 
 /*!
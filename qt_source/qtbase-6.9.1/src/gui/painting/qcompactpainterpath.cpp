@@ -0,0 +1,536 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qcompactpainterpath_p.h"
+
+#include <qpainter.h>
+#include <private/qpainter_p.h>
+#include <private/qpainterpath_p.h>
+#include <private/qpaintengineex_p.h>
+
+#include <QtCore/qset.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QCompactPainterPath
+    \internal
+    \inmodule QtGui
+
+    \brief The QCompactPainterPath class is a painter path with single
+    precision storage for scenes with very many path elements.
+
+    QPainterPath stores every element as two doubles and a type, which
+    together with padding takes 24 bytes. QCompactPainterPath stores the
+    coordinates as floats and the type as a byte, 9 bytes per element.
+
+    The elements live in immutable chunks that are shared between paths:
+    addPath() references the chunks of the other path instead of copying
+    its elements, and elements appended to a path never modify a chunk
+    that another path references. This makes it cheap to build many paths
+    out of a common set of subpaths.
+
+    Painting goes through qt_draw_compact_path(), which converts the float
+    storage into a QVectorPath for QPaintEngineEx based engines without
+    going through QPainterPath. The stroker and rasterizer only take qreal
+    coordinates, so this copies the elements on every draw.
+*/
+
+static inline bool isValidCoord(qreal c)
+{
+    return qIsFinite(c) && qAbs(c) < qreal(1e16);
+}
+
+static inline bool hasValidCoords(const QPointF &p)
+{
+    return isValidCoord(p.x()) && isValidCoord(p.y());
+}
+
+QCompactPainterPath::QCompactPainterPath()
+    : d(new QCompactPainterPathPrivate)
+{
+}
+
+/*!
+    Constructs a compact copy of \a path. Coordinates are rounded to single
+    precision.
+*/
+QCompactPainterPath::QCompactPainterPath(const QPainterPath &path)
+    : d(new QCompactPainterPathPrivate)
+{
+    d->fillRule = path.fillRule();
+    const int count = path.elementCount();
+    if (count == 0)
+        return;
+
+    QCompactPainterPathChunk *chunk = new QCompactPainterPathChunk;
+    chunk->coordinates.resize(2 * count);
+    chunk->types.resize(count);
+    float *coordinates = chunk->coordinates.data();
+    quint8 *types = chunk->types.data();
+    for (int i = 0; i < count; ++i) {
+        const QPainterPath::Element &e = path.elementAt(i);
+        coordinates[2 * i] = float(e.x);
+        coordinates[2 * i + 1] = float(e.y);
+        types[i] = quint8(e.type);
+        if (e.type == QPainterPath::MoveToElement) {
+            d->startX = coordinates[2 * i];
+            d->startY = coordinates[2 * i + 1];
+        }
+    }
+    d->segments.append({ QExplicitlySharedDataPointer<QCompactPainterPathChunk>(chunk), 0, count });
+    d->elementCount = count;
+    d->dirtyControlBounds = true;
+}
+
+QCompactPainterPath::QCompactPainterPath(const QCompactPainterPath &other) = default;
+
+QCompactPainterPath &QCompactPainterPath::operator=(const QCompactPainterPath &other) = default;
+
+QCompactPainterPath::~QCompactPainterPath() = default;
+
+/*!
+    Returns the element at index \a i. This walks the shared segments and is
+    meant for inspection, not for iterating over large paths; use
+    forEachRun() for that.
+*/
+QPainterPath::Element QCompactPainterPath::elementAt(qsizetype i) const
+{
+    Q_ASSERT(i >= 0 && i < d->elementCount);
+    for (const QCompactPainterPathPrivate::Segment &segment : d->segments) {
+        if (i < segment.count) {
+            const qsizetype index = segment.begin + i;
+            const float *coordinates = segment.chunk->coordinates.constData() + 2 * index;
+            return { coordinates[0], coordinates[1],
+                     QPainterPath::ElementType(segment.chunk->types.at(index)) };
+        }
+        i -= segment.count;
+    }
+    return { 0, 0, QPainterPath::MoveToElement };
+}
+
+QPointF QCompactPainterPath::currentPosition() const
+{
+    if (d->segments.isEmpty())
+        return QPointF();
+    const QCompactPainterPathPrivate::Segment &segment = d->segments.constLast();
+    const float *coordinates = segment.chunk->coordinates.constData()
+            + 2 * (segment.begin + segment.count - 1);
+    return QPointF(coordinates[0], coordinates[1]);
+}
+
+void QCompactPainterPath::setFillRule(Qt::FillRule fillRule)
+{
+    if (d->fillRule != fillRule)
+        d->fillRule = fillRule;
+}
+
+/*
+    Appends an element, either to the chunk at the end of the path if no
+    other path references it, or to a new chunk.
+*/
+void QCompactPainterPath::append(float x, float y, QPainterPath::ElementType type)
+{
+    QCompactPainterPathPrivate *dd = d.data();
+    if (dd->segments.isEmpty()
+        || dd->segments.constLast().chunk->ref.loadRelaxed() != 1
+        || dd->segments.constLast().begin + dd->segments.constLast().count
+               != dd->segments.constLast().chunk->types.size()) {
+        dd->segments.append({ QExplicitlySharedDataPointer<QCompactPainterPathChunk>(
+                                      new QCompactPainterPathChunk), 0, 0 });
+    }
+
+    QCompactPainterPathPrivate::Segment &segment = dd->segments.last();
+    segment.chunk->coordinates.append(x);
+    segment.chunk->coordinates.append(y);
+    segment.chunk->types.append(quint8(type));
+    ++segment.count;
+    ++dd->elementCount;
+    dd->dirtyControlBounds = true;
+}
+
+/*
+    Drops the last element from the path. The chunk holding it is left
+    alone if another path references it.
+*/
+void QCompactPainterPath::removeLastElement()
+{
+    QCompactPainterPathPrivate *dd = d.data();
+    QCompactPainterPathPrivate::Segment &segment = dd->segments.last();
+    if (segment.chunk->ref.loadRelaxed() == 1
+        && segment.begin + segment.count == segment.chunk->types.size()) {
+        segment.chunk->coordinates.resize(segment.chunk->coordinates.size() - 2);
+        segment.chunk->types.removeLast();
+    }
+    if (--segment.count == 0)
+        dd->segments.removeLast();
+    --dd->elementCount;
+    dd->dirtyControlBounds = true;
+}
+
+void QCompactPainterPath::ensureStart()
+{
+    if (d->elementCount == 0) {
+        append(0, 0, QPainterPath::MoveToElement);
+        d->startX = 0;
+        d->startY = 0;
+    }
+}
+
+void QCompactPainterPath::maybeMoveTo()
+{
+    if (d->requireMoveTo) {
+        const QPointF p = currentPosition();
+        append(float(p.x()), float(p.y()), QPainterPath::MoveToElement);
+        d->startX = float(p.x());
+        d->startY = float(p.y());
+        d->requireMoveTo = false;
+    }
+}
+
+/*
+    Returns the type of the last element, or LineToElement if the path is
+    empty. Unlike elementAt(), this does not walk the segments.
+*/
+QPainterPath::ElementType QCompactPainterPath::lastElementType() const
+{
+    if (d->segments.isEmpty())
+        return QPainterPath::LineToElement;
+    const QCompactPainterPathPrivate::Segment &segment = d->segments.constLast();
+    return QPainterPath::ElementType(segment.chunk->types.at(segment.begin + segment.count - 1));
+}
+
+bool QCompactPainterPath::isClosed() const
+{
+    const QPointF p = currentPosition();
+    return float(p.x()) == d->startX && float(p.y()) == d->startY;
+}
+
+/*!
+    Starts a new subpath at \a p.
+
+    \sa QPainterPath::moveTo()
+*/
+void QCompactPainterPath::moveTo(const QPointF &p)
+{
+    if (!hasValidCoords(p)) {
+#ifndef QT_NO_DEBUG
+        qWarning("QCompactPainterPath::moveTo: Adding point with invalid coordinates, ignoring call");
+#endif
+        return;
+    }
+
+    d->requireMoveTo = false;
+    if (lastElementType() == QPainterPath::MoveToElement)
+        removeLastElement();
+    append(float(p.x()), float(p.y()), QPainterPath::MoveToElement);
+    d->startX = float(p.x());
+    d->startY = float(p.y());
+}
+
+/*!
+    Adds a straight line from the current position to \a p.
+
+    \sa QPainterPath::lineTo()
+*/
+void QCompactPainterPath::lineTo(const QPointF &p)
+{
+    if (!hasValidCoords(p)) {
+#ifndef QT_NO_DEBUG
+        qWarning("QCompactPainterPath::lineTo: Adding point with invalid coordinates, ignoring call");
+#endif
+        return;
+    }
+
+    ensureStart();
+    maybeMoveTo();
+    const float x = float(p.x());
+    const float y = float(p.y());
+    const QPointF last = currentPosition();
+    if (float(last.x()) == x && float(last.y()) == y)
+        return;
+    append(x, y, QPainterPath::LineToElement);
+}
+
+/*!
+    Adds a quadratic Bezier curve from the current position to \a endPoint
+    with the control point \a c.
+
+    \sa QPainterPath::quadTo()
+*/
+void QCompactPainterPath::quadTo(const QPointF &c, const QPointF &e)
+{
+    if (!hasValidCoords(c) || !hasValidCoords(e)) {
+#ifndef QT_NO_DEBUG
+        qWarning("QCompactPainterPath::quadTo: Adding point with invalid coordinates, ignoring call");
+#endif
+        return;
+    }
+
+    ensureStart();
+    maybeMoveTo();
+    const QPointF prev = currentPosition();
+    if (prev == c && c == e)
+        return;
+
+    const QPointF c1((prev.x() + 2 * c.x()) / 3, (prev.y() + 2 * c.y()) / 3);
+    const QPointF c2((e.x() + 2 * c.x()) / 3, (e.y() + 2 * c.y()) / 3);
+    cubicTo(c1, c2, e);
+}
+
+/*!
+    Adds a cubic Bezier curve from the current position to \a endPoint with
+    the control points \a c1 and \a c2.
+
+    \sa QPainterPath::cubicTo()
+*/
+void QCompactPainterPath::cubicTo(const QPointF &c1, const QPointF &c2, const QPointF &e)
+{
+    if (!hasValidCoords(c1) || !hasValidCoords(c2) || !hasValidCoords(e)) {
+#ifndef QT_NO_DEBUG
+        qWarning("QCompactPainterPath::cubicTo: Adding point with invalid coordinates, ignoring call");
+#endif
+        return;
+    }
+
+    ensureStart();
+    maybeMoveTo();
+
+    // Abort on empty curve as a stroker cannot handle this and the
+    // curve is irrelevant anyway.
+    const QPointF last = currentPosition();
+    if (last == c1 && c1 == c2 && c2 == e)
+        return;
+
+    append(float(c1.x()), float(c1.y()), QPainterPath::CurveToElement);
+    append(float(c2.x()), float(c2.y()), QPainterPath::CurveToDataElement);
+    append(float(e.x()), float(e.y()), QPainterPath::CurveToDataElement);
+}
+
+/*!
+    Closes the current subpath by drawing a line to its start, and marks
+    the path so that the next element starts a new subpath.
+
+    \sa QPainterPath::closeSubpath()
+*/
+void QCompactPainterPath::closeSubpath()
+{
+    if (isEmpty())
+        return;
+
+    d->requireMoveTo = true;
+    if (!isClosed())
+        append(d->startX, d->startY, QPainterPath::LineToElement);
+}
+
+/*!
+    Adds \a rect as a closed subpath.
+
+    \sa QPainterPath::addRect()
+*/
+void QCompactPainterPath::addRect(const QRectF &rect)
+{
+    if (!hasValidCoords(rect.topLeft()) || !hasValidCoords(rect.bottomRight())) {
+#ifndef QT_NO_DEBUG
+        qWarning("QCompactPainterPath::addRect: Adding point with invalid coordinates, ignoring call");
+#endif
+        return;
+    }
+
+    if (rect.isNull())
+        return;
+
+    moveTo(rect.topLeft());
+    const float x1 = float(rect.left());
+    const float y1 = float(rect.top());
+    const float x2 = float(rect.right());
+    const float y2 = float(rect.bottom());
+    append(x2, y1, QPainterPath::LineToElement);
+    append(x2, y2, QPainterPath::LineToElement);
+    append(x1, y2, QPainterPath::LineToElement);
+    append(x1, y1, QPainterPath::LineToElement);
+    d->requireMoveTo = true;
+}
+
+/*!
+    Adds \a other to this path. The elements of \a other are shared, not
+    copied.
+
+    \sa QPainterPath::addPath()
+*/
+void QCompactPainterPath::addPath(const QCompactPainterPath &other)
+{
+    if (other.isEmpty())
+        return;
+
+    // Remove last moveto so we don't get multiple moveto's
+    if (lastElementType() == QPainterPath::MoveToElement)
+        removeLastElement();
+
+    QCompactPainterPathPrivate *dd = d.data();
+    dd->segments.append(other.d->segments);
+    dd->elementCount += other.d->elementCount;
+    dd->startX = other.d->startX;
+    dd->startY = other.d->startY;
+    dd->requireMoveTo = other.isClosed();
+    dd->dirtyControlBounds = true;
+}
+
+/*!
+    Returns the rectangle containing all the points and control points of
+    the path.
+*/
+QRectF QCompactPainterPath::controlPointRect() const
+{
+    if (!d->dirtyControlBounds)
+        return d->controlBounds;
+
+    QRectF bounds;
+    if (d->elementCount > 0) {
+        float minX = d->segments.constFirst().chunk->coordinates.at(2 * d->segments.constFirst().begin);
+        float minY = d->segments.constFirst().chunk->coordinates.at(2 * d->segments.constFirst().begin + 1);
+        float maxX = minX;
+        float maxY = minY;
+        forEachRun([&](const float *coordinates, const quint8 *, qsizetype count) {
+            for (qsizetype i = 0; i < count; ++i) {
+                minX = qMin(minX, coordinates[2 * i]);
+                maxX = qMax(maxX, coordinates[2 * i]);
+                minY = qMin(minY, coordinates[2 * i + 1]);
+                maxY = qMax(maxY, coordinates[2 * i + 1]);
+            }
+        });
+        bounds = QRectF(qreal(minX), qreal(minY), qreal(maxX) - minX, qreal(maxY) - minY);
+    }
+
+    // The cache is not part of the value of the path, so updating it in a
+    // shared private is fine.
+    QCompactPainterPathPrivate *dd = const_cast<QCompactPainterPathPrivate *>(d.constData());
+    dd->controlBounds = bounds;
+    dd->dirtyControlBounds = false;
+    return bounds;
+}
+
+/*!
+    Returns the number of bytes used by the element storage the path
+    references, counting chunks shared with other paths in full.
+*/
+qsizetype QCompactPainterPath::memoryUsage() const
+{
+    qsizetype bytes = sizeof(QCompactPainterPathPrivate)
+            + d->segments.capacity() * sizeof(QCompactPainterPathPrivate::Segment);
+    QSet<const QCompactPainterPathChunk *> seen;
+    for (const QCompactPainterPathPrivate::Segment &segment : d->segments) {
+        const QCompactPainterPathChunk *chunk = segment.chunk.data();
+        if (seen.contains(chunk))
+            continue;
+        seen.insert(chunk);
+        bytes += sizeof(QCompactPainterPathChunk)
+                + chunk->coordinates.capacity() * sizeof(float)
+                + chunk->types.capacity() * sizeof(quint8);
+    }
+    return bytes;
+}
+
+/*!
+    Returns a QPainterPath with the same elements.
+*/
+QPainterPath QCompactPainterPath::toPainterPath() const
+{
+    QPainterPath path;
+    path.setFillRule(d->fillRule);
+    path.reserve(int(d->elementCount));
+    QPointF curve[2];
+    int curveIndex = -1;
+    forEachRun([&](const float *coordinates, const quint8 *types, qsizetype count) {
+        for (qsizetype i = 0; i < count; ++i) {
+            const QPointF p(coordinates[2 * i], coordinates[2 * i + 1]);
+            switch (QPainterPath::ElementType(types[i])) {
+            case QPainterPath::MoveToElement:
+                path.moveTo(p);
+                break;
+            case QPainterPath::LineToElement:
+                path.lineTo(p);
+                break;
+            case QPainterPath::CurveToElement:
+                curve[0] = p;
+                curveIndex = 1;
+                break;
+            case QPainterPath::CurveToDataElement:
+                if (curveIndex == 1) {
+                    curve[1] = p;
+                    curveIndex = 2;
+                } else if (curveIndex == 2) {
+                    path.cubicTo(curve[0], curve[1], p);
+                    curveIndex = -1;
+                }
+                break;
+            }
+        }
+    });
+    return path;
+}
+
+QVectorPathConverter::QVectorPathData::QVectorPathData(const QCompactPainterPath &path)
+    : elements(path.elementCount()), points(path.elementCount() * 2), flags(0)
+{
+    qsizetype index = 0;
+    bool isLines = true;
+    path.forEachRun([&](const float *coordinates, const quint8 *types, qsizetype count) {
+        qreal *pts = points.data() + 2 * index;
+        QPainterPath::ElementType *elms = elements.data() + index;
+        for (qsizetype i = 0; i < 2 * count; ++i)
+            pts[i] = coordinates[i];
+        for (qsizetype i = 0; i < count; ++i) {
+            elms[i] = QPainterPath::ElementType(types[i]);
+            if (elms[i] == QPainterPath::CurveToElement)
+                flags |= QVectorPath::CurvedShapeMask;
+            // Only alternating moveTo/lineTo pairs make a LinesHint path.
+            isLines = isLines && elms[i] == QPainterPath::ElementType((index + i) % 2);
+        }
+        index += count;
+    });
+
+    if (path.fillRule() == Qt::WindingFill)
+        flags |= QVectorPath::WindingFill;
+    else
+        flags |= QVectorPath::OddEvenFill;
+
+    if (isLines)
+        flags |= QVectorPath::LinesShapeMask;
+    else
+        flags |= QVectorPath::AreaShapeMask | QVectorPath::NonConvexShapeMask;
+}
+
+QVectorPathConverter::QVectorPathConverter(const QCompactPainterPath &path)
+    : pathData(path),
+      path(pathData.points.data(), int(pathData.elements.size()), pathData.elements.data(),
+           pathData.flags)
+{
+}
+
+/*!
+    \internal
+
+    Draws \a path with the current pen and brush of \a painter. Engines
+    based on QPaintEngineEx get the path as a QVectorPath built straight
+    from the float storage; other engines go through QPainterPath.
+*/
+void qt_draw_compact_path(QPainter *painter, const QCompactPainterPath &path)
+{
+    QPainterPrivate *d = QPainterPrivate::get(painter);
+    if (!d->engine) {
+        qWarning("qt_draw_compact_path: Painter not active");
+        return;
+    }
+    if (path.isEmpty())
+        return;
+
+    if (d->extended) {
+        QVectorPathConverter converter(path);
+        d->extended->draw(converter.vectorPath());
+        return;
+    }
+    painter->drawPath(path.toPainterPath());
+}
+
+QT_END_NAMESPACE
@@ -46,6 +46,12 @@ inline static FDot16 FDot16FixedDiv(int x, int y)
 #endif
 }
 
+static inline int swapCaps(int caps)
+{
+    return ((caps & QCosmeticStroker::CapBegin) << 1) |
+           ((caps & QCosmeticStroker::CapEnd) >> 1);
+}
+
 typedef void (*DrawPixel)(QCosmeticStroker *stroker, int x, int y, int coverage);
 
 namespace {
@@ -251,6 +257,11 @@ void QCosmeticStroker::setup()
 
     stroke = strokeLine(strokeSelection);
 
+    // solid aliased hairlines on 32-bit targets under scale and translate
+    // transforms are mostly axis aligned, see fillAxisAlignedLine()
+    fastHairlines = strokeSelection == (Aliased|Solid|FastDraw)
+                    && state->matrix.type() <= QTransform::TxScale;
+
     qreal width = state->lastPen.widthF();
     if (width == 0)
         opacity = 256;
@@ -349,6 +360,11 @@ void QCosmeticStroker::drawLine(const QPointF &p1, const QPointF &p2)
         return;
     }
 
+    drawMappedLine(start, end);
+}
+
+void QCosmeticStroker::drawMappedLine(const QPointF &start, const QPointF &end)
+{
     patternOffset = state->lastPen.dashOffset()*64;
     lastPixel.x = INT_MIN;
     lastPixel.y = INT_MIN;
@@ -359,6 +375,143 @@ void QCosmeticStroker::drawLine(const QPointF &p1, const QPointF &p2)
     current_span = 0;
 }
 
+void QCosmeticStroker::drawLines(const QLine *lines, int num)
+{
+    drawLinesImpl(lines, num);
+}
+
+void QCosmeticStroker::drawLines(const QLineF *lines, int num)
+{
+    drawLinesImpl(lines, num);
+}
+
+template <typename Line>
+void QCosmeticStroker::drawLinesImpl(const Line *lines, int num)
+{
+    for (int i = 0; i < num; ++i) {
+        const QPointF p1 = lines[i].p1();
+        const QPointF p2 = lines[i].p2();
+        const QPointF start = p1 * state->matrix;
+        const QPointF end = p2 * state->matrix;
+
+        if (start == end) {
+            drawPoints(&p1, 1);
+            continue;
+        }
+
+        if (fastHairlines && (start.x() == end.x() || start.y() == end.y()))
+            fillAxisAlignedLine(start.x(), start.y(), end.x(), end.y());
+        else
+            drawMappedLine(start, end);
+    }
+}
+
+static inline void fillHairlineRun(uint *dest, int count, int stride, uint color)
+{
+    if (qAlpha(color) == 255) {
+        if (stride == 1) {
+            qt_memfill32(dest, color, count);
+        } else {
+            for (int i = 0; i < count; ++i, dest += stride)
+                *dest = color;
+        }
+    } else {
+        for (int i = 0; i < count; ++i, dest += stride)
+            *dest = sourceOver(*dest, color);
+    }
+}
+
+/*
+   Fills a horizontal or vertical line as a single run. This is the aliased
+   drawLine() specialized for a zero slope: it touches exactly the same
+   pixels, including the cap and direction handling, but writes them with
+   qt_memfill32() instead of one clip check and store per pixel.
+  */
+void QCosmeticStroker::fillAxisAlignedLine(qreal rx1, qreal ry1, qreal rx2, qreal ry2)
+{
+    int caps = drawCaps ? CapBegin|CapEnd : 0;
+    lastPixel.x = INT_MIN;
+    lastPixel.y = INT_MIN;
+
+    if (clipLine(rx1, ry1, rx2, ry2))
+        return;
+
+    int x1 = toF26Dot6(rx1);
+    int y1 = toF26Dot6(ry1);
+    int x2 = toF26Dot6(rx2);
+    int y2 = toF26Dot6(ry2);
+
+    if (x1 == x2 && y1 != y2) {
+        // vertical
+        Direction dir = TopToBottom;
+        bool swapped = false;
+        if (y1 > y2) {
+            swapped = true;
+            qSwap(y1, y2);
+            caps = swapCaps(caps);
+            dir = BottomToTop;
+        }
+        if ((lastDir ^ VerticalMask) == dir)
+            caps |= swapped ? CapEnd : CapBegin;
+        if (caps & CapBegin)
+            y1 -= 32;
+        if (caps & CapEnd)
+            y2 += 32;
+
+        const int y = (y1 + 32) >> 6;
+        const int ys = (y2 + 32) >> 6;
+        if (y == ys)
+            return;
+
+        const int x = x1 >> 6;
+        lastDir = dir;
+        lastAxisAligned = true;
+        lastPixel.x = x;
+        lastPixel.y = swapped ? y : ys - 1;
+
+        if (x < clip.left() || x > clip.right())
+            return;
+        const int top = qMax(y, clip.top());
+        const int bottom = qMin(ys, clip.bottom() + 1);
+        if (top < bottom)
+            fillHairlineRun(pixels + top * ppl + x, bottom - top, ppl, color);
+    } else if (y1 == y2 && x1 != x2) {
+        // horizontal
+        Direction dir = LeftToRight;
+        bool swapped = false;
+        if (x1 > x2) {
+            swapped = true;
+            qSwap(x1, x2);
+            caps = swapCaps(caps);
+            dir = RightToLeft;
+        }
+        if ((lastDir ^ HorizontalMask) == dir)
+            caps |= swapped ? CapEnd : CapBegin;
+        if (caps & CapBegin)
+            x1 -= 32;
+        if (caps & CapEnd)
+            x2 += 32;
+
+        const int x = (x1 + 32) >> 6;
+        const int xs = (x2 + 32) >> 6;
+        if (x == xs)
+            return;
+
+        const int y = y1 >> 6;
+        lastDir = dir;
+        lastAxisAligned = true;
+        lastPixel.x = swapped ? x : xs - 1;
+        lastPixel.y = y;
+
+        if (y < clip.top() || y > clip.bottom())
+            return;
+        const int left = qMax(x, clip.left());
+        const int right = qMin(xs, clip.right() + 1);
+        if (left < right)
+            fillHairlineRun(pixels + y * ppl + left, right - left, 1, color);
+    }
+}
+
 void QCosmeticStroker::drawPoints(const QPoint *points, int num)
 {
     const QPoint *end = points + num;
@@ -683,12 +836,6 @@ void QCosmeticStroker::renderCubicSubdivision(QCosmeticStroker::PointF *points,
     stroke(this, points[3].x, points[3].y, points[0].x, points[0].y, caps);
 }
 
-static inline int swapCaps(int caps)
-{
-    return ((caps & QCosmeticStroker::CapBegin) << 1) |
-           ((caps & QCosmeticStroker::CapEnd) >> 1);
-}
-
 // adjust line by half a pixel
 static inline void capAdjust(int caps, int &x1, int &x2, FDot16 &y, FDot16 yinc)
 {
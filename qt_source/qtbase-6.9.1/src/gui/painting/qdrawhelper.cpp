@@ -2621,6 +2621,25 @@ static const uint *QT_FASTCALL fetchTransformedBilinear(uint *buffer, const Oper
 }
 
 #if QT_CONFIG(raster_64bit)
+// Interpolates a rotated or sheared span from the pixel pairs in buf1 and buf2.
+static void QT_FASTCALL interpolate_4_pixels_rgb64_span(QRgba64 *b, const QRgba64 *buf1, const QRgba64 *buf2,
+                                                        int len, int &fx, int &fy, int fdx, int fdy)
+{
+#if defined(QT_COMPILER_SUPPORTS_AVX2)
+    extern void QT_FASTCALL interpolate_4_pixels_rgb64_span_avx2(QRgba64 *b, const QRgba64 *buf1, const QRgba64 *buf2,
+                                                                 int len, int &fx, int &fy, int fdx, int fdy);
+    if (qCpuHasFeature(ArchHaswell))
+        return interpolate_4_pixels_rgb64_span_avx2(b, buf1, buf2, len, fx, fy, fdx, fdy);
+#endif
+    for (int i = 0; i < len; ++i) {
+        const int distx = (fx & 0x0000ffff);
+        const int disty = (fy & 0x0000ffff);
+        b[i] = interpolate_4_pixels_rgb64(buf1 + i*2, buf2 + i*2, distx, disty);
+        fx += fdx;
+        fy += fdy;
+    }
+}
+
 template<TextureBlendType blendType>
 static const QRgba64 *QT_FASTCALL fetchTransformedBilinear64_uint32(QRgba64 *buffer, const QSpanData *data,
                                                                     int y, int x, int length)
@@ -2702,13 +2721,7 @@ static const QRgba64 *QT_FASTCALL fetchTransformedBilinear64_uint32(QRgba64 *buf
                 convert(buf1, sbuf1, len * 2, clut, nullptr);
                 convert(buf2, sbuf2, len * 2, clut, nullptr);
 
-                for (int i = 0; i < len; ++i) {
-                    const int distx = (fx & 0x0000ffff);
-                    const int disty = (fy & 0x0000ffff);
-                    b[i] = interpolate_4_pixels_rgb64(buf1 + i*2, buf2 + i*2, distx, disty);
-                    fx += fdx;
-                    fy += fdy;
-                }
+                interpolate_4_pixels_rgb64_span(b, buf1, buf2, len, fx, fy, fdx, fdy);
 
                 length -= len;
                 b += len;
@@ -2825,13 +2838,7 @@ static const QRgba64 *QT_FASTCALL fetchTransformedBilinear64_uint64(QRgba64 *buf
                 convert(buf1, len * 2);
                 convert(buf2, len * 2);
 
-                for (int i = 0; i < len; ++i) {
-                    int distx = (fx & 0x0000ffff);
-                    int disty = (fy & 0x0000ffff);
-                    b[i] = interpolate_4_pixels_rgb64(buf1 + i*2, buf2 + i*2, distx, disty);
-                    fx += fdx;
-                    fy += fdy;
-                }
+                interpolate_4_pixels_rgb64_span(b, buf1, buf2, len, fx, fy, fdx, fdy);
 
                 length -= len;
                 b += len;
@@ -6802,9 +6809,12 @@ static void qInitDrawhelperFunctions()
                                                                                        int &fx, int &fy, int fdx, int /*fdy*/);
         extern void QT_FASTCALL fetchTransformedBilinearARGB32PM_fast_rotate_helper_avx2(uint *b, uint *end, const QTextureData &image,
                                                                                          int &fx, int &fy, int fdx, int fdy);
+        extern void QT_FASTCALL fetchTransformedBilinearARGB32PM_rotate_helper_avx2(uint *b, uint *end, const QTextureData &image,
+                                                                                    int &fx, int &fy, int fdx, int fdy);
 
         bilinearFastTransformHelperARGB32PM[0][SimpleScaleTransform] = fetchTransformedBilinearARGB32PM_simple_scale_helper_avx2;
         bilinearFastTransformHelperARGB32PM[0][DownscaleTransform] = fetchTransformedBilinearARGB32PM_downscale_helper_avx2;
+        bilinearFastTransformHelperARGB32PM[0][RotateTransform] = fetchTransformedBilinearARGB32PM_rotate_helper_avx2;
         bilinearFastTransformHelperARGB32PM[0][FastRotateTransform] = fetchTransformedBilinearARGB32PM_fast_rotate_helper_avx2;
 
         extern void QT_FASTCALL convertARGB32ToARGB32PM_avx2(uint *buffer, int count, const QList<QRgb> *);
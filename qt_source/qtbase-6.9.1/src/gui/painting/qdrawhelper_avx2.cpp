@@ -1097,6 +1097,189 @@ void QT_FASTCALL fetchTransformedBilinearARGB32PM_fast_rotate_helper_avx2(uint *
     }
 }
 
+// Interpolates 8 pixels with 8-bit weights, in the same order and with the
+// same rounding as interpolate_4_pixels(): first vertically, then horizontally.
+// The weights hold the distance in both 16-bit halves of each 32-bit lane.
+inline static __m256i Q_DECL_VECTORCALL
+interpolate_4_pixels_avx2(__m256i tl, __m256i tr, __m256i bl, __m256i br,
+                          __m256i distx, __m256i disty, __m256i colorMask, __m256i v_256)
+{
+    const __m256i idistx = _mm256_sub_epi16(v_256, distx);
+    const __m256i idisty = _mm256_sub_epi16(v_256, disty);
+
+    const auto vertical = [&](__m256i t, __m256i b, __m256i &rb, __m256i &ag) {
+        rb = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_and_si256(t, colorMask), idisty),
+                              _mm256_mullo_epi16(_mm256_and_si256(b, colorMask), disty));
+        ag = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_srli_epi16(t, 8), idisty),
+                              _mm256_mullo_epi16(_mm256_srli_epi16(b, 8), disty));
+        rb = _mm256_srli_epi16(rb, 8);
+        ag = _mm256_srli_epi16(ag, 8);
+    };
+    __m256i leftRB, leftAG, rightRB, rightAG;
+    vertical(tl, bl, leftRB, leftAG);
+    vertical(tr, br, rightRB, rightAG);
+
+    __m256i rRB = _mm256_add_epi16(_mm256_mullo_epi16(leftRB, idistx), _mm256_mullo_epi16(rightRB, distx));
+    __m256i rAG = _mm256_add_epi16(_mm256_mullo_epi16(leftAG, idistx), _mm256_mullo_epi16(rightAG, distx));
+    rRB = _mm256_srli_epi16(rRB, 8);
+    rAG = _mm256_andnot_si256(colorMask, rAG);
+    return _mm256_or_si256(rRB, rAG);
+}
+
+// Used when zooming in more than 8 times, where the position needs 8 bits of
+// precision; see fetchTransformedBilinearARGB32PM_fast_rotate_helper_avx2()
+// for the 4-bit variant.
+void QT_FASTCALL fetchTransformedBilinearARGB32PM_rotate_helper_avx2(uint *b, uint *end, const QTextureData &image,
+                                                                     int &fx, int &fy, int fdx, int fdy)
+{
+    const qint64 min_fx = qint64(image.x1) * FixedScale;
+    const qint64 max_fx = qint64(image.x2 - 1) * FixedScale;
+    const qint64 min_fy = qint64(image.y1) * FixedScale;
+    const qint64 max_fy = qint64(image.y2 - 1) * FixedScale;
+    // first handle the possibly bounded part in the beginning
+    while (b < end) {
+        int x1 = (fx >> 16);
+        int x2;
+        int y1 = (fy >> 16);
+        int y2;
+        fetchTransformedBilinear_pixelBounds(image.width, image.x1, image.x2 - 1, x1, x2);
+        fetchTransformedBilinear_pixelBounds(image.height, image.y1, image.y2 - 1, y1, y2);
+        if (x1 != x2 && y1 != y2)
+            break;
+        const uint *s1 = (const uint *)image.scanLine(y1);
+        const uint *s2 = (const uint *)image.scanLine(y2);
+        int distx = (fx & 0x0000ffff) >> 8;
+        int disty = (fy & 0x0000ffff) >> 8;
+        *b = interpolate_4_pixels(s1[x1], s1[x2], s2[x1], s2[x2], distx, disty);
+        fx += fdx;
+        fy += fdy;
+        ++b;
+    }
+    uint *boundedEnd = end;
+    if (fdx > 0)
+        boundedEnd = qMin(boundedEnd, b + (max_fx - fx) / fdx);
+    else if (fdx < 0)
+        boundedEnd = qMin(boundedEnd, b + (min_fx - fx) / fdx);
+    if (fdy > 0)
+        boundedEnd = qMin(boundedEnd, b + (max_fy - fy) / fdy);
+    else if (fdy < 0)
+        boundedEnd = qMin(boundedEnd, b + (min_fy - fy) / fdy);
+
+    // The gathers take 32-bit pixel offsets.
+    const qsizetype pixelsPerLine = image.bytesPerLine / 4;
+    if (qint64(pixelsPerLine) * image.height >= std::numeric_limits<int>::max())
+        boundedEnd = b;
+
+    // until boundedEnd we can now have a fast middle part without boundary checks
+    const __m256i colorMask = _mm256_set1_epi32(0x00ff00ff);
+    const __m256i v_256 = _mm256_set1_epi16(256);
+    const __m256i v_fdx = _mm256_set1_epi32(fdx * 8);
+    const __m256i v_fdy = _mm256_set1_epi32(fdy * 8);
+    const __m256i v_index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i v_one = _mm256_set1_epi32(1);
+    const __m256i v_ppl = _mm256_set1_epi32(int(pixelsPerLine));
+    const __m256i v_distMask = _mm256_set1_epi32(0xff);
+    __m256i v_fx = _mm256_set1_epi32(fx);
+    __m256i v_fy = _mm256_set1_epi32(fy);
+    v_fx = _mm256_add_epi32(v_fx, _mm256_mullo_epi32(_mm256_set1_epi32(fdx), v_index));
+    v_fy = _mm256_add_epi32(v_fy, _mm256_mullo_epi32(_mm256_set1_epi32(fdy), v_index));
+
+    const int *topData = (const int *)image.imageData;
+    const int *botData = (const int *)(image.imageData + image.bytesPerLine);
+
+    while (b < boundedEnd - 7) {
+        const __m256i left = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(v_fy, 16), v_ppl),
+                                              _mm256_srli_epi32(v_fx, 16));
+        const __m256i right = _mm256_add_epi32(left, v_one);
+        const __m256i tl = _mm256_i32gather_epi32(topData, left, 4);
+        const __m256i tr = _mm256_i32gather_epi32(topData, right, 4);
+        const __m256i bl = _mm256_i32gather_epi32(botData, left, 4);
+        const __m256i br = _mm256_i32gather_epi32(botData, right, 4);
+
+        __m256i v_distx = _mm256_and_si256(_mm256_srli_epi32(v_fx, 8), v_distMask);
+        __m256i v_disty = _mm256_and_si256(_mm256_srli_epi32(v_fy, 8), v_distMask);
+        v_distx = _mm256_or_si256(v_distx, _mm256_slli_epi32(v_distx, 16));
+        v_disty = _mm256_or_si256(v_disty, _mm256_slli_epi32(v_disty, 16));
+
+        _mm256_storeu_si256((__m256i *)b, interpolate_4_pixels_avx2(tl, tr, bl, br, v_distx, v_disty,
+                                                                    colorMask, v_256));
+        b += 8;
+        v_fx = _mm256_add_epi32(v_fx, v_fdx);
+        v_fy = _mm256_add_epi32(v_fy, v_fdy);
+    }
+    fx = _mm_extract_epi32(_mm256_castsi256_si128(v_fx) , 0);
+    fy = _mm_extract_epi32(_mm256_castsi256_si128(v_fy) , 0);
+
+    while (b < end) {
+        int x1 = (fx >> 16);
+        int x2;
+        int y1 = (fy >> 16);
+        int y2;
+
+        fetchTransformedBilinear_pixelBounds(image.width, image.x1, image.x2 - 1, x1, x2);
+        fetchTransformedBilinear_pixelBounds(image.height, image.y1, image.y2 - 1, y1, y2);
+
+        const uint *s1 = (const uint *)image.scanLine(y1);
+        const uint *s2 = (const uint *)image.scanLine(y2);
+
+        int distx = (fx & 0x0000ffff) >> 8;
+        int disty = (fy & 0x0000ffff) >> 8;
+        *b = interpolate_4_pixels(s1[x1], s1[x2], s2[x1], s2[x2], distx, disty);
+
+        fx += fdx;
+        fy += fdy;
+        ++b;
+    }
+}
+
+// Interpolates len pixels of a rotated or sheared RGBA64 span from the pixel
+// pairs fetched into buf1 (top) and buf2 (bottom), two pixels at a time, with
+// the same rounding as interpolate_4_pixels_rgb64().
+void QT_FASTCALL interpolate_4_pixels_rgb64_span_avx2(QRgba64 *b, const QRgba64 *buf1, const QRgba64 *buf2,
+                                                      int len, int &fx, int &fy, int fdx, int fdy)
+{
+    const auto pair = [](int d0, int d1) {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_set1_epi16(short(d0))),
+                                       _mm_set1_epi16(short(d1)), 1);
+    };
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i < len - 1; i += 2) {
+        const int distx0 = fx & 0x0000ffff;
+        const int disty0 = fy & 0x0000ffff;
+        const int distx1 = (fx + fdx) & 0x0000ffff;
+        const int disty1 = (fy + fdy) & 0x0000ffff;
+        fx += 2 * fdx;
+        fy += 2 * fdy;
+
+        // Each 128-bit lane holds the left and right pixel of one output pixel.
+        __m256i vt = _mm256_loadu_si256((const __m256i *)(buf1 + i * 2));
+        const __m256i vb = _mm256_loadu_si256((const __m256i *)(buf2 + i * 2));
+        const __m256i vdy = pair(disty0, disty1);
+        const __m256i vy = _mm256_add_epi16(_mm256_mulhi_epu16(vt, _mm256_sub_epi16(zero, vdy)),
+                                            _mm256_mulhi_epu16(vb, vdy));
+        // A distance of zero takes the top pixels as they are; 0x10000 does not fit.
+        vt = _mm256_blendv_epi8(vy, vt, _mm256_cmpeq_epi16(vdy, zero));
+
+        const __m256i vdx = _mm256_blend_epi32(pair(0x10000 - distx0, 0x10000 - distx1),
+                                               pair(distx0, distx1), 0xcc);
+        __m256i vx = _mm256_mulhi_epu16(vt, vdx);
+        vx = _mm256_add_epi16(vx, _mm256_srli_si256(vx, 8));
+        const __m256i keepLeft = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_set1_epi64x(distx0 ? 0 : -1)), _mm_set1_epi64x(distx1 ? 0 : -1), 1);
+        vt = _mm256_blendv_epi8(vx, vt, keepLeft);
+
+        // Pack the low halves of both lanes.
+        vt = _mm256_permute4x64_epi64(vt, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *)(b + i), _mm256_castsi256_si128(vt));
+    }
+    for (; i < len; ++i) {
+        b[i] = interpolate_4_pixels_rgb64(buf1 + i * 2, buf2 + i * 2, fx & 0x0000ffff, fy & 0x0000ffff);
+        fx += fdx;
+        fy += fdy;
+    }
+}
+
 static inline __m256i epilogueMaskFromCount(qsizetype count)
 {
     Q_ASSERT(count > 0);
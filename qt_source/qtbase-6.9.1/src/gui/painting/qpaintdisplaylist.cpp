@@ -0,0 +1,246 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpaintdisplaylist_p.h"
+
+#include <qpainter.h>
+#include <private/qfont_p.h>
+#include <private/qrtree_p.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QPaintDisplayList
+    \internal
+    \inmodule QtGui
+
+    \brief The QPaintDisplayList class is a paint device that retains the
+    commands painted on it for fast, repeated playback.
+
+    Unlike QPicture, which serializes commands into a byte stream that has
+    to be decoded in full on every playback, a display list keeps the
+    commands in typed arrays together with their bounds and indexes them
+    with an R-tree when painting ends. play() only visits the commands that
+    touch the exposed area and sends runs of commands sharing a state
+    straight to the paint engine of the target painter, so redrawing a small
+    part of a large scene costs in proportion to what is visible.
+
+    Text is recorded as filled paths. Commands whose bounds cannot be
+    computed, for instance under a perspective transform, are always
+    played.
+
+    Painting on a display list replaces its previous contents.
+*/
+
+QPaintDisplayList::QPaintDisplayList()
+    : m_engine(std::make_unique<QDisplayListPaintEngine>())
+{
+}
+
+QPaintDisplayList::~QPaintDisplayList()
+{
+    Q_ASSERT_X(!paintingActive(), "QPaintDisplayList::~QPaintDisplayList",
+               "Display list is still being painted on");
+}
+
+/*!
+    Returns \c true if the display list holds no commands.
+*/
+bool QPaintDisplayList::isEmpty() const
+{
+    return m_engine->recording().isEmpty();
+}
+
+/*!
+    Returns the number of recorded commands.
+*/
+qsizetype QPaintDisplayList::commandCount() const
+{
+    return m_engine->recording().size();
+}
+
+/*!
+    Returns the bounding rectangle of the recorded commands, not counting
+    the commands without bounds.
+*/
+QRect QPaintDisplayList::boundingRect() const
+{
+    return m_engine->boundingRect();
+}
+
+/*!
+    Removes all commands from the display list.
+*/
+void QPaintDisplayList::clear()
+{
+    if (paintingActive()) {
+        qWarning("QPaintDisplayList::clear: Cannot clear while painting");
+        return;
+    }
+    m_engine->clear();
+}
+
+/*!
+    Plays the display list on \a painter, on top of its current transform
+    and clip. Only the commands touching \a exposed, given in the logical
+    coordinates of \a painter, are played. If \a exposed is null the clip
+    of the painter is used instead, and without a clip everything is played.
+*/
+void QPaintDisplayList::play(QPainter *painter, const QRectF &exposed) const
+{
+    if (!painter || !painter->isActive()) {
+        qWarning("QPaintDisplayList::play: Painter not active");
+        return;
+    }
+    if (paintingActive()) {
+        qWarning("QPaintDisplayList::play: Cannot play while painting");
+        return;
+    }
+    m_engine->play(painter, exposed);
+}
+
+QPaintEngine *QPaintDisplayList::paintEngine() const
+{
+    return m_engine.get();
+}
+
+int QPaintDisplayList::metric(PaintDeviceMetric metric) const
+{
+    const QRect bounds = boundingRect();
+    switch (metric) {
+    case PdmWidth:
+        return bounds.width();
+    case PdmHeight:
+        return bounds.height();
+    case PdmWidthMM:
+        return int(25.4 / qt_defaultDpiX() * bounds.width());
+    case PdmHeightMM:
+        return int(25.4 / qt_defaultDpiY() * bounds.height());
+    case PdmDpiX:
+    case PdmPhysicalDpiX:
+        return qt_defaultDpiX();
+    case PdmDpiY:
+    case PdmPhysicalDpiY:
+        return qt_defaultDpiY();
+    case PdmNumColors:
+        return 16777216;
+    case PdmDepth:
+        return 24;
+    case PdmDevicePixelRatio:
+        return 1;
+    case PdmDevicePixelRatioScaled:
+        return 1 * QPaintDevice::devicePixelRatioFScale();
+    default:
+        qWarning("QPaintDisplayList::metric: Invalid metric command");
+    }
+    return 0;
+}
+
+class QDisplayListPaintEnginePrivate : public QRecordingPaintEnginePrivate
+{
+    Q_DECLARE_PUBLIC(QDisplayListPaintEngine)
+public:
+    void buildIndex();
+
+    QRTree<int> index;
+    QList<int> unbounded;
+};
+
+void QDisplayListPaintEnginePrivate::buildIndex()
+{
+    index.clear();
+    unbounded.clear();
+
+    QList<QRectF> rects;
+    QList<int> commands;
+    rects.reserve(recording.size());
+    commands.reserve(recording.size());
+    for (qsizetype i = 0; i < recording.size(); ++i) {
+        const QRect &bounds = recording.commands.at(i).bounds;
+        if (bounds.isNull()) {
+            unbounded.append(int(i));
+        } else {
+            rects.append(QRectF(bounds));
+            commands.append(int(i));
+        }
+    }
+    index.bulkLoad(rects.constData(), commands.constData(), rects.size());
+}
+
+/*!
+    \class QDisplayListPaintEngine
+    \internal
+    \inmodule QtGui
+
+    \brief The QDisplayListPaintEngine class records the commands of a
+    QPaintDisplayList and indexes them by their bounds.
+
+    \sa QPaintDisplayList
+*/
+
+QDisplayListPaintEngine::QDisplayListPaintEngine()
+    : QRecordingPaintEngine(*(new QDisplayListPaintEnginePrivate))
+{
+}
+
+QDisplayListPaintEngine::~QDisplayListPaintEngine()
+{
+}
+
+bool QDisplayListPaintEngine::begin(QPaintDevice *)
+{
+    clear();
+    return true;
+}
+
+bool QDisplayListPaintEngine::end()
+{
+    Q_D(QDisplayListPaintEngine);
+    d->buildIndex();
+    return true;
+}
+
+void QDisplayListPaintEngine::clear()
+{
+    Q_D(QDisplayListPaintEngine);
+    resetRecording();
+    d->index.clear();
+    d->unbounded.clear();
+}
+
+QRect QDisplayListPaintEngine::boundingRect() const
+{
+    Q_D(const QDisplayListPaintEngine);
+    return d->index.boundingRect().toRect();
+}
+
+void QDisplayListPaintEngine::play(QPainter *painter, const QRectF &exposed) const
+{
+    Q_D(const QDisplayListPaintEngine);
+    if (d->recording.isEmpty())
+        return;
+
+    QRectF area = exposed;
+    if (area.isNull() && painter->hasClipping())
+        area = painter->clipBoundingRect();
+    if (area.isNull()) {
+        d->recording.replay(painter);
+        return;
+    }
+
+    QList<int> commands = d->unbounded;
+    d->index.intersecting(area, [&commands](int command) {
+        commands.append(command);
+    });
+    if (commands.isEmpty())
+        return;
+
+    // Replay in recording order so that overlapping commands compose as
+    // they were painted.
+    std::sort(commands.begin(), commands.end());
+    d->recording.replay(painter, commands);
+}
+
+QT_END_NAMESPACE
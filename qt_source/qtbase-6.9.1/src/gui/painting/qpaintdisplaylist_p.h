@@ -0,0 +1,70 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPAINTDISPLAYLIST_P_H
+#define QPAINTDISPLAYLIST_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qpaintdevice.h>
+#include "private/qpaintrecording_p.h"
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QDisplayListPaintEngine;
+class QDisplayListPaintEnginePrivate;
+
+class Q_GUI_EXPORT QPaintDisplayList : public QPaintDevice
+{
+public:
+    QPaintDisplayList();
+    ~QPaintDisplayList() override;
+
+    bool isEmpty() const;
+    qsizetype commandCount() const;
+    QRect boundingRect() const;
+    void clear();
+
+    void play(QPainter *painter, const QRectF &exposed = QRectF()) const;
+
+    QPaintEngine *paintEngine() const override;
+
+protected:
+    int metric(PaintDeviceMetric metric) const override;
+
+private:
+    Q_DISABLE_COPY(QPaintDisplayList)
+
+    std::unique_ptr<QDisplayListPaintEngine> m_engine;
+};
+
+class Q_GUI_EXPORT QDisplayListPaintEngine : public QRecordingPaintEngine
+{
+    Q_DECLARE_PRIVATE(QDisplayListPaintEngine)
+public:
+    QDisplayListPaintEngine();
+    ~QDisplayListPaintEngine() override;
+
+    bool begin(QPaintDevice *device) override;
+    bool end() override;
+
+    void clear();
+    QRect boundingRect() const;
+    void play(QPainter *painter, const QRectF &exposed) const;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPAINTDISPLAYLIST_P_H
@@ -20,6 +20,8 @@
 //   #include <private/qpainter_p.h>
 #include <private/qtextengine_p.h>
 #include <private/qfontengine_p.h>
+#include <private/qsharedglyphcache_p.h>
+#include <private/qdistancefieldatlas_p.h>
 #include <private/qpixmap_raster_p.h>
 //   #include <private/qrasterizer_p.h>
 #include <private/qimage_p.h>
@@ -34,6 +36,13 @@
 //   #include "qbezier_p.h"
 #include "qoutlinemapper_p.h"
 
+#if QT_CONFIG(qtgui_threadpool)
+#include <qsemaphore.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <private/qguiapplication_p.h>
+#endif
+
 #include <limits.h>
 #include <algorithm>
 
@@ -417,6 +426,7 @@ bool QRasterPaintEngine::begin(QPaintDevice *device)
     s->brushData.setup(s->brush, s->intOpacity, s->composition_mode, s->flags.cosmetic_brush);
 
     d->rasterBuffer->compositionMode = QPainter::CompositionMode_SourceOver;
+    d->culledPrimitives = 0;
 
     setDirty(DirtyBrushOrigin);
 
@@ -1502,10 +1512,13 @@ void QRasterPaintEngine::drawRects(const QRectF *rects, int rectCount)
         ensureBrush();
         if (s->brushData.blend) {
             d->initializeRasterizer(&s->brushData);
+            const bool collapse = s->renderHints & QPainter::CollapseSubPixelPrimitives;
             for (int i = 0; i < rectCount; ++i) {
                 const QRectF &rect = rects[i].normalized();
                 if (rect.isEmpty())
                     continue;
+                if (collapse && d->collapseSubPixelPrimitive(s->matrix.mapRect(rect), &s->brushData))
+                    continue;
                 const QPointF a = s->matrix.map((rect.topLeft() + rect.bottomLeft()) * 0.5f);
                 const QPointF b = s->matrix.map((rect.topRight() + rect.bottomRight()) * 0.5f);
                 d->rasterizer->rasterizeLine(a, b, rect.height() / rect.width());
@@ -1548,6 +1561,12 @@ void QRasterPaintEngine::stroke(const QVectorPath &path, const QPen &pen)
     if (!s->penData.blend)
         return;
 
+    if ((s->renderHints & QPainter::CollapseSubPixelPrimitives)
+        && d->collapseSubPixelPrimitive(d->strokeDeviceBounds(path.controlPointRect(), s->lastPen),
+                                        &s->penData)) {
+        return;
+    }
+
     if (s->flags.fast_pen) {
         QCosmeticStroker stroker(s, d->deviceRect, d->deviceRectUnclipped);
         stroker.drawPath(path);
@@ -1644,6 +1663,11 @@ void QRasterPaintEngine::fill(const QVectorPath &path, const QBrush &brush)
     if (!s->brushData.blend)
         return;
 
+    if ((s->renderHints & QPainter::CollapseSubPixelPrimitives)
+        && d->collapseSubPixelPrimitive(s->matrix.mapRect(path.controlPointRect()), &s->brushData)) {
+        return;
+    }
+
     if (path.shape() == QVectorPath::RectangleHint) {
         if (!s->flags.antialiased && s->matrix.type() <= QTransform::TxScale) {
             const qreal *p = path.points();
@@ -1714,6 +1738,10 @@ void QRasterPaintEngine::fillRect(const QRectF &r, QSpanData *data)
         }
     }
     ensureRasterState();
+    if ((s->renderHints & QPainter::CollapseSubPixelPrimitives)
+        && d->collapseSubPixelPrimitive(s->matrix.mapRect(r.normalized()), data)) {
+        return;
+    }
     if (s->flags.tx_noshear) {
         d->initializeRasterizer(data);
         QRectF nr = r.normalized();
@@ -1783,6 +1811,57 @@ void QRasterPaintEngine::fillRect(const QRectF &r, const QColor &color)
     fillRect(r, &d->solid_color_filler);
 }
 
+/*!
+    \reimp
+*/
+void QRasterPaintEngine::fillRectBatch(const QRectF *rects, int rectCount,
+                                       const QColor *colors, int colorCount)
+{
+#ifdef QT_DEBUG_DRAW
+    qDebug() << "QRasterPaintEngine::fillRectBatch(): " << rectCount << colorCount;
+#endif
+    Q_ASSERT(isActive());
+    Q_ASSERT(colorCount == 1 || colorCount == rectCount);
+    Q_D(QRasterPaintEngine);
+    QRasterPaintEngineState *s = state();
+
+    QSpanData *filler = &d->solid_color_filler;
+    filler->clip = d->clip();
+    filler->adjustSpanMethods();
+
+    // Aliased rectangles under a scale and translate transform map straight
+    // to device rectangles, which fillRect_normalized() fills with the
+    // format's rect fill function when the color is opaque.
+    const bool direct = !s->flags.antialiased && s->matrix.type() <= QTransform::TxScale;
+    const qreal m11 = s->matrix.m11();
+    const qreal m22 = s->matrix.m22();
+    const qreal dx = s->matrix.dx();
+    const qreal dy = s->matrix.dy();
+    const bool skipTransparent = s->composition_mode == QPainter::CompositionMode_SourceOver;
+
+    const QColor *lastColor = nullptr;
+    bool visible = false;
+    for (int i = 0; i < rectCount; ++i) {
+        const QColor &color = colors[colorCount == 1 ? 0 : i];
+        if (!lastColor || color != *lastColor) {
+            filler->solidColor = qPremultiplyWithExtraAlpha(color, s->intOpacity);
+            visible = !skipTransparent || filler->solidColor.alphaF() > 0.0f;
+            lastColor = &color;
+        }
+        if (!visible)
+            continue;
+
+        const QRectF &r = rects[i];
+        if (direct) {
+            const QPointF tl(r.left() * m11 + dx, r.top() * m22 + dy);
+            const QPointF br(r.right() * m11 + dx, r.bottom() * m22 + dy);
+            fillRect_normalized(toNormalizedFillRect(QRectF(tl, br)), filler, d);
+        } else {
+            fillRect(r, filler);
+        }
+    }
+}
+
 static inline bool isAbove(const QPointF *a, const QPointF *b)
 {
     return a->y() < b->y();
@@ -1874,6 +1953,45 @@ void QRasterPaintEngine::fillPolygon(const QPointF *points, int pointCount, Poly
     d->rasterize(outline, brushBlend, &s->brushData, d->rasterBuffer.data());
 }
 
+template <typename Point>
+static QRectF polygonBoundingRect(const Point *points, int pointCount)
+{
+    qreal minX = points[0].x();
+    qreal maxX = minX;
+    qreal minY = points[0].y();
+    qreal maxY = minY;
+    for (int i = 1; i < pointCount; ++i) {
+        minX = qMin<qreal>(minX, points[i].x());
+        maxX = qMax<qreal>(maxX, points[i].x());
+        minY = qMin<qreal>(minY, points[i].y());
+        maxY = qMax<qreal>(maxY, points[i].y());
+    }
+    return QRectF(minX, minY, maxX - minX, maxY - minY);
+}
+
+/*
+    Draws the polygon as a single pixel if it is smaller than a pixel. The
+    pen takes precedence over the brush, as it is drawn on top.
+*/
+template <typename Point>
+bool QRasterPaintEngine::collapseSubPixelPolygon(const Point *points, int pointCount,
+                                                 PolygonDrawMode mode)
+{
+    Q_D(QRasterPaintEngine);
+    QRasterPaintEngineState *s = state();
+
+    ensurePen();
+    QSpanData *data = &s->penData;
+    if (!data->blend) {
+        if (mode == PolylineMode)
+            return false;
+        ensureBrush();
+        data = &s->brushData;
+    }
+    const QRectF bounds = polygonBoundingRect(points, pointCount);
+    return d->collapseSubPixelPrimitive(d->strokeDeviceBounds(bounds, s->lastPen), data);
+}
+
 /*!
     \reimp
 */
@@ -1895,6 +2013,11 @@ void QRasterPaintEngine::drawPolygon(const QPointF *points, int pointCount, Poly
         return;
     }
 
+    if ((s->renderHints & QPainter::CollapseSubPixelPrimitives)
+        && collapseSubPixelPolygon(points, pointCount, mode)) {
+        return;
+    }
+
     ensurePen();
     if (mode != PolylineMode) {
         // Do the fill...
@@ -1938,6 +2061,11 @@ void QRasterPaintEngine::drawPolygon(const QPoint *points, int pointCount, Polyg
         return;
     }
 
+    if ((s->renderHints & QPainter::CollapseSubPixelPrimitives)
+        && collapseSubPixelPolygon(points, pointCount, mode)) {
+        return;
+    }
+
     ensurePen();
 
     // Do the fill
@@ -2754,12 +2882,132 @@ void QRasterPaintEngine::alphaPenBlt(const void* src, int bpl, int depth, int rx
 /*!
     \internal
 */
+// Samples the field at (x, y) in field pixels with bilinear filtering;
+// everything outside the field is far outside the glyph.
+static inline float qt_sample_distance_field(const uchar *bits, int width, int height,
+                                             float x, float y)
+{
+    const int x0 = qFloor(x);
+    const int y0 = qFloor(y);
+    const float ax = x - x0;
+    const float ay = y - y0;
+    const auto at = [&](int px, int py) -> float {
+        return uint(px) < uint(width) && uint(py) < uint(height) ? bits[py * width + px] : 0.f;
+    };
+    const float top = at(x0, y0) + (at(x0 + 1, y0) - at(x0, y0)) * ax;
+    const float bottom = at(x0, y0 + 1) + (at(x0 + 1, y0 + 1) - at(x0, y0 + 1)) * ax;
+    return top + (bottom - top) * ay;
+}
+
+/*!
+    \internal
+
+    Returns whether the glyphs of \a fontEngine are drawn from distance
+    fields with the transform \a m.
+*/
+bool QRasterPaintEngine::useDistanceFieldText(QFontEngine *fontEngine, const QTransform &m) const
+{
+    Q_D(const QRasterPaintEngine);
+    const QRasterPaintEngineState *s = state();
+    return s && (s->renderHints & QPainter::DistanceFieldText)
+            && m.type() < QTransform::TxProject
+            && !d->mono_surface
+            && QDistanceFieldAtlas::supports(fontEngine);
+}
+
+/*!
+    \internal
+
+    Draws the \a numGlyphs \a glyphs of \a fontEngine at the device
+    \a positions from their distance fields. Each glyph is resampled at
+    the current scale, thresholded into a coverage mask and blended with
+    the pen like a cached glyph.
+*/
+void QRasterPaintEngine::drawDistanceFieldGlyphs(int numGlyphs, const glyph_t *glyphs,
+                                                 const QFixedPoint *positions,
+                                                 QFontEngine *fontEngine)
+{
+    QRasterPaintEngineState *s = state();
+    QDistanceFieldAtlas *atlas = QDistanceFieldAtlas::instance();
+
+    QVarLengthArray<QDistanceFieldAtlas::Glyph, 64> fields(numGlyphs);
+    atlas->glyphs(fontEngine, glyphs, numGlyphs, fields.data());
+
+    // Maps reference units, relative to the glyph origin, to device pixels.
+    const qreal scale = fontEngine->fontDef.pixelSize / atlas->referencePixelSize();
+    const QTransform toDevice(s->matrix.m11() * scale, s->matrix.m12() * scale,
+                              s->matrix.m21() * scale, s->matrix.m22() * scale, 0, 0);
+    bool invertible;
+    const QTransform toReference = toDevice.inverted(&invertible);
+    if (!invertible)
+        return;
+
+    // A field stores 127.5 on the outline and reaches 0 and 255 at spread()
+    // field pixels outside and inside. The coverage of a device pixel is
+    // one half on the outline and ramps over one device pixel.
+    const qreal fieldScale = atlas->fieldScale();
+    const float gain = float(2 * atlas->spread() * fieldScale
+                             * qSqrt(qAbs(toDevice.determinant())));
+    const float fieldStepXX = float(toReference.m11() / fieldScale);
+    const float fieldStepXY = float(toReference.m12() / fieldScale);
+    const float fieldStepYX = float(toReference.m21() / fieldScale);
+    const float fieldStepYY = float(toReference.m22() / fieldScale);
+
+    const QRect visible = clipBoundingRect().toAlignedRect();
+    QVarLengthArray<uchar, 4096> mask;
+    for (int i = 0; i < numGlyphs; ++i) {
+        const QDistanceFieldAtlas::Glyph &glyph = fields.at(i);
+        const QDistanceField &field = glyph.field;
+        if (field.isNull() || field.width() == 0 || field.height() == 0)
+            continue;
+
+        const QPointF origin = positions[i].toPointF();
+        const QRectF fieldRect(glyph.origin,
+                               QSizeF(field.width() * fieldScale, field.height() * fieldScale));
+        const QRect area = toDevice.mapRect(fieldRect).translated(origin).toAlignedRect() & visible;
+        if (area.isEmpty())
+            continue;
+
+        const QPointF start = (toReference.map(QPointF(area.left() + 0.5, area.top() + 0.5) - origin)
+                               - glyph.origin) / fieldScale - QPointF(0.5, 0.5);
+        const uchar *bits = field.constBits();
+        const int width = field.width();
+        const int height = field.height();
+
+        mask.resize(qsizetype(area.width()) * area.height());
+        uchar *dst = mask.data();
+        float rowX = float(start.x());
+        float rowY = float(start.y());
+        for (int y = 0; y < area.height(); ++y) {
+            float fx = rowX;
+            float fy = rowY;
+            for (int x = 0; x < area.width(); ++x) {
+                const float distance = qt_sample_distance_field(bits, width, height, fx, fy);
+                const float coverage = 127.5f + (distance - 127.5f) * gain;
+                *dst++ = uchar(qBound(0.f, coverage, 255.f) + 0.5f);
+                fx += fieldStepXX;
+                fy += fieldStepXY;
+            }
+            rowX += fieldStepYX;
+            rowY += fieldStepYY;
+        }
+
+        alphaPenBlt(mask.constData(), area.width(), 8, area.x(), area.y(),
+                    area.width(), area.height(), false);
+    }
+}
+
 bool QRasterPaintEngine::drawCachedGlyphs(int numGlyphs, const glyph_t *glyphs,
                                           const QFixedPoint *positions, QFontEngine *fontEngine)
 {
     Q_D(QRasterPaintEngine);
     QRasterPaintEngineState *s = state();
 
+    if (useDistanceFieldText(fontEngine, s->matrix)) {
+        drawDistanceFieldGlyphs(numGlyphs, glyphs, positions, fontEngine);
+        return true;
+    }
+
     bool verticalSubPixelPositions = fontEngine->supportsVerticalSubPixelPositions()
             && (s->renderHints & QPainter::VerticalSubpixelPositioning) != 0;
 
@@ -2772,29 +3020,49 @@ bool QRasterPaintEngine::drawCachedGlyphs(int numGlyphs, const glyph_t *glyphs,
         if (d_func()->mono_surface) // alphaPenBlt can handle mono, too
             neededFormat = QFontEngine::Format_Mono;
 
+        // Glyphs rendered by the font engines of other threads are reused
+        // from the shared cache.
+        QSharedGlyphCache *sharedCache = QSharedGlyphCache::instance();
+        const int sharedFontId = sharedCache->fontId(fontEngine, neededFormat, s->matrix);
+
         for (int i = 0; i < numGlyphs; i++) {
             QFixedPoint spp = fontEngine->subPixelPositionFor(positions[i]);
             if (!verticalSubPixelPositions)
                 spp.y = 0;
 
-            const QFontEngine::Glyph *alphaMap = fontEngine->glyphData(glyphs[i], spp, neededFormat, s->matrix);
-            if (!alphaMap)
-                continue;
+            QSharedGlyphCache::GlyphPointer sharedGlyph;
+            if (sharedFontId >= 0)
+                sharedGlyph = sharedCache->find(sharedFontId, glyphs[i], spp);
+            const QFontEngine::Glyph *alphaMap = nullptr;
+            if (!sharedGlyph) {
+                alphaMap = fontEngine->glyphData(glyphs[i], spp, neededFormat, s->matrix);
+                if (!alphaMap)
+                    continue;
+                if (sharedFontId >= 0)
+                    sharedGlyph = sharedCache->insert(sharedFontId, glyphs[i], spp, *alphaMap);
+            }
+
+            const uchar *data = sharedGlyph ? sharedGlyph->data.get() : alphaMap->data;
+            const int format = sharedGlyph ? sharedGlyph->format : alphaMap->format;
+            const int glyphX = sharedGlyph ? sharedGlyph->x : alphaMap->x;
+            const int glyphY = sharedGlyph ? sharedGlyph->y : alphaMap->y;
+            const int width = sharedGlyph ? sharedGlyph->width : alphaMap->width;
+            const int height = sharedGlyph ? sharedGlyph->height : alphaMap->height;
 
             int depth;
             int bytesPerLine;
-            switch (alphaMap->format) {
+            switch (format) {
             case QFontEngine::Format_Mono:
                 depth = 1;
-                bytesPerLine = ((alphaMap->width + 31) & ~31) >> 3;
+                bytesPerLine = ((width + 31) & ~31) >> 3;
                 break;
             case QFontEngine::Format_A8:
                 depth = 8;
-                bytesPerLine = (alphaMap->width + 3) & ~3;
+                bytesPerLine = (width + 3) & ~3;
                 break;
             case QFontEngine::Format_A32:
                 depth = 32;
-                bytesPerLine = alphaMap->width * 4;
+                bytesPerLine = width * 4;
                 break;
             default:
                 Q_UNREACHABLE();
@@ -2804,10 +3072,10 @@ bool QRasterPaintEngine::drawCachedGlyphs(int numGlyphs, const glyph_t *glyphs,
                     ? qFloor(positions[i].y)
                     : qRound(positions[i].y);
 
-            alphaPenBlt(alphaMap->data, bytesPerLine, depth,
-                        qFloor(positions[i].x) + alphaMap->x,
-                        qFloor(y) - alphaMap->y,
-                        alphaMap->width, alphaMap->height,
+            alphaPenBlt(data, bytesPerLine, depth,
+                        qFloor(positions[i].x) + glyphX,
+                        qFloor(y) - glyphY,
+                        width, height,
                         fontEngine->expectsGammaCorrectedBlending());
         }
 
@@ -3180,10 +3448,7 @@ void QRasterPaintEngine::drawLines(const QLine *lines, int lineCount)
 
     if (s->flags.fast_pen) {
         QCosmeticStroker stroker(s, d->deviceRect, d->deviceRectUnclipped);
-        for (int i=0; i<lineCount; ++i) {
-            const QLine &l = lines[i];
-            stroker.drawLine(l.p1(), l.p2());
-        }
+        stroker.drawLines(lines, lineCount);
     } else {
         QPaintEngineEx::drawLines(lines, lineCount);
     }
@@ -3256,10 +3521,7 @@ void QRasterPaintEngine::drawLines(const QLineF *lines, int lineCount)
         return;
     if (s->flags.fast_pen) {
         QCosmeticStroker stroker(s, d->deviceRect, d->deviceRectUnclipped);
-        for (int i=0; i<lineCount; ++i) {
-            QLineF line = lines[i];
-            stroker.drawLine(line.p1(), line.p2());
-        }
+        stroker.drawLines(lines, lineCount);
     } else {
         QPaintEngineEx::drawLines(lines, lineCount);
     }
@@ -3349,6 +3611,10 @@ bool QRasterPaintEngine::shouldDrawCachedGlyphs(QFontEngine *fontEngine, const Q
     if (m.type() >= QTransform::TxProject)
         return false;
 
+    // Distance fields serve every scale
+    if (useDistanceFieldText(fontEngine, m))
+        return true;
+
     // The font engine might not support filling the glyph cache
     // with the given transform applied, in which case we need to
     // fall back to the QPainterPath code-path. This does not apply
@@ -3501,6 +3767,105 @@ QRectF QRasterPaintEngine::clipBoundingRect() const
     return QRectF(clip->xmin, clip->ymin, clip->xmax - clip->xmin, clip->ymax - clip->ymin);
 }
 
+/*!
+    \internal
+
+    Returns the number of primitives that were drawn as a single pixel
+    because of the QPainter::CollapseSubPixelPrimitives render hint since
+    the engine was last begun or the count was reset.
+
+    \sa resetCulledPrimitiveCount()
+*/
+quint64 QRasterPaintEngine::culledPrimitiveCount() const
+{
+    Q_D(const QRasterPaintEngine);
+    return d->culledPrimitives;
+}
+
+/*!
+    \internal
+
+    Resets the culled primitive count to zero.
+
+    \sa culledPrimitiveCount()
+*/
+void QRasterPaintEngine::resetCulledPrimitiveCount()
+{
+    Q_D(QRasterPaintEngine);
+    d->culledPrimitives = 0;
+}
+
+/*
+    Implements the QPainter::CollapseSubPixelPrimitives render hint. If
+    \a deviceBounds fits in less than a pixel in both directions, a single
+    pixel is written through \a data at the center of the bounds and true is
+    returned; the caller then skips the outline mapper and the rasterizer.
+    Bounds without area, or with no coverage, produce no pixel.
+*/
+bool QRasterPaintEnginePrivate::collapseSubPixelPrimitive(const QRectF &deviceBounds,
+                                                          QSpanData *data)
+{
+    Q_Q(QRasterPaintEngine);
+    const QRasterPaintEngineState *s = q->state();
+
+    if (!(s->renderHints & QPainter::CollapseSubPixelPrimitives) || !data->blend)
+        return false;
+
+    const qreal w = deviceBounds.width();
+    const qreal h = deviceBounds.height();
+    if (!(w >= 0 && w < 1 && h >= 0 && h < 1))
+        return false;
+
+    const QPointF center = deviceBounds.center();
+    if (!qIsFinite(center.x()) || !qIsFinite(center.y()))
+        return false;
+
+    ++culledPrimitives;
+
+    // Primitives without area, such as empty rectangles or degenerate
+    // polygons, do not produce any pixels in the regular path either.
+    const int coverage = s->flags.antialiased ? qMin(qRound(w * h * 255), 255) : 255;
+    if (w == 0 || h == 0 || coverage == 0)
+        return true;
+
+    const int x = qFloor(center.x());
+    const int y = qFloor(center.y());
+    if (x < deviceRect.left() || x > deviceRect.right()
+        || y < deviceRect.top() || y > deviceRect.bottom()) {
+        return true;
+    }
+
+    QT_FT_Span span;
+    span.x = x;
+    span.y = y;
+    span.len = 1;
+    span.coverage = coverage;
+    data->blend(1, &span, data);
+    return true;
+}
+
+/*
+    Returns the device bounds of \a bounds stroked with \a pen, or of the
+    bounds themselves if the pen is empty.
+*/
+QRectF QRasterPaintEnginePrivate::strokeDeviceBounds(const QRectF &bounds, const QPen &pen) const
+{
+    Q_Q(const QRasterPaintEngine);
+    const QRasterPaintEngineState *s = q->state();
+
+    const QRectF r = s->matrix.mapRect(bounds);
+    if (qpen_style(pen) == Qt::NoPen)
+        return r;
+
+    qreal width = qpen_widthf(pen);
+    if (width == 0)
+        width = 1;
+    else if (!pen.isCosmetic())
+        width *= s->txscale;
+    const qreal margin = width / 2;
+    return r.adjusted(-margin, -margin, margin, margin);
+}
+
 void QRasterPaintEnginePrivate::initializeRasterizer(QSpanData *data)
 {
     Q_Q(QRasterPaintEngine);
@@ -3547,6 +3912,9 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
         return;
     }
 
+    if (rasterizeBands(outline, callback, spanData))
+        return;
+
     rasterize(outline, callback, (void *)spanData, rasterBuffer);
 }
 
@@ -3559,29 +3927,17 @@ static inline uchar *alignAddress(uchar *address, quintptr alignmentMask)
     return (uchar *)(((quintptr)address + alignmentMask) & ~alignmentMask);
 }
 
-void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
-                                          ProcessSpans callback,
-                                          void *userData, QRasterBuffer *)
-{
-    if (!callback || !outline)
-        return;
-
-    Q_Q(QRasterPaintEngine);
-    QRasterPaintEngineState *s = q->state();
-
-    if (!s->flags.antialiased) {
-        rasterizer->setAntialiased(s->flags.antialiased);
-        rasterizer->setClipRect(deviceRect);
-        rasterizer->initialize(callback, userData);
-
-        const Qt::FillRule fillRule = outline->flags == QT_FT_OUTLINE_NONE
-                                      ? Qt::WindingFill
-                                      : Qt::OddEvenFill;
-
-        rasterizer->rasterize(outline, fillRule);
-        return;
-    }
+/*
+    Scan converts \a outline with the antialiasing gray rasterizer, passing
+    the spans within \a clip_box to \a callback.
 
+    The gray rasterizer computes every scanline from the outline alone, so
+    rasterizing the rows of \a clip_box in separate calls gives the same
+    spans as a single call.
+*/
+static void rasterizeGray(QT_FT_Raster *raster, QT_FT_Outline *outline, ProcessSpans callback,
+                          void *data, const QT_FT_BBox &clip_box)
+{
     // Initial size for raster pool is MINIMUM_POOL_SIZE so as to
     // minimize memory reallocations. However if initial size for
     // raster pool is changed for lower value, reallocations will
@@ -3591,14 +3947,7 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
     uchar *rasterPoolBase = alignAddress(rasterPoolOnStack, 0xf);
     uchar *rasterPoolOnHeap = nullptr;
 
-    qt_ft_grays_raster.raster_reset(*grayRaster.data(), rasterPoolBase, rasterPoolSize);
-
-    void *data = userData;
-
-    QT_FT_BBox clip_box = { deviceRect.x(),
-                            deviceRect.y(),
-                            deviceRect.x() + deviceRect.width(),
-                            deviceRect.y() + deviceRect.height() };
+    qt_ft_grays_raster.raster_reset(*raster, rasterPoolBase, rasterPoolSize);
 
     QT_FT_Raster_Params rasterParams;
     rasterParams.target = nullptr;
@@ -3621,7 +3970,7 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
         rasterParams.flags |= (QT_FT_RASTER_FLAG_AA | QT_FT_RASTER_FLAG_DIRECT);
         rasterParams.gray_spans = callback;
         rasterParams.skip_spans = rendered_spans;
-        error = qt_ft_grays_raster.raster_render(*grayRaster.data(), &rasterParams);
+        error = qt_ft_grays_raster.raster_render(*raster, &rasterParams);
 
         // Out of memory, reallocate some more and try again...
         if (error == -6) { // ErrRaster_OutOfMemory from qgrayraster.c
@@ -3631,7 +3980,7 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
                 break;
             }
 
-            rendered_spans += q_gray_rendered_spans(*grayRaster.data());
+            rendered_spans += q_gray_rendered_spans(*raster);
 
             free(rasterPoolOnHeap);
             rasterPoolOnHeap = (uchar *)malloc(rasterPoolSize + 0xf);
@@ -3640,9 +3989,9 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
 
             rasterPoolBase = alignAddress(rasterPoolOnHeap, 0xf);
 
-            qt_ft_grays_raster.raster_done(*grayRaster.data());
-            qt_ft_grays_raster.raster_new(grayRaster.data());
-            qt_ft_grays_raster.raster_reset(*grayRaster.data(), rasterPoolBase, rasterPoolSize);
+            qt_ft_grays_raster.raster_done(*raster);
+            qt_ft_grays_raster.raster_new(raster);
+            qt_ft_grays_raster.raster_reset(*raster, rasterPoolBase, rasterPoolSize);
         } else {
             done = true;
         }
@@ -3651,6 +4000,104 @@ void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
     free(rasterPoolOnHeap);
 }
 
+void QRasterPaintEnginePrivate::rasterize(QT_FT_Outline *outline,
+                                          ProcessSpans callback,
+                                          void *userData, QRasterBuffer *)
+{
+    if (!callback || !outline)
+        return;
+
+    Q_Q(QRasterPaintEngine);
+    QRasterPaintEngineState *s = q->state();
+
+    if (!s->flags.antialiased) {
+        rasterizer->setAntialiased(s->flags.antialiased);
+        rasterizer->setClipRect(deviceRect);
+        rasterizer->initialize(callback, userData);
+
+        const Qt::FillRule fillRule = outline->flags == QT_FT_OUTLINE_NONE
+                                      ? Qt::WindingFill
+                                      : Qt::OddEvenFill;
+
+        rasterizer->rasterize(outline, fillRule);
+        return;
+    }
+
+    QT_FT_BBox clip_box = { deviceRect.x(),
+                            deviceRect.y(),
+                            deviceRect.x() + deviceRect.width(),
+                            deviceRect.y() + deviceRect.height() };
+
+    rasterizeGray(grayRaster.data(), outline, callback, userData, clip_box);
+}
+
+/*
+    Splits an antialiased fill that covers many scanlines into horizontal
+    bands and rasterizes them concurrently on the GUI thread pool. Every
+    band has its own gray raster and only blends its own scanlines, in
+    order, so the result is identical to a single pass. Returns false if the
+    fill was not split.
+*/
+bool QRasterPaintEnginePrivate::rasterizeBands(QT_FT_Outline *outline, ProcessSpans callback,
+                                               QSpanData *spanData)
+{
+#if QT_CONFIG(qtgui_threadpool)
+    constexpr int MinimumBandHeight = 128;
+
+    if (outline->n_points <= 0 || deviceRect.height() < 2 * MinimumBandHeight)
+        return false;
+
+    QT_FT_Pos minY = outline->points[0].y;
+    QT_FT_Pos maxY = minY;
+    for (int i = 1; i < outline->n_points; ++i) {
+        minY = qMin(minY, outline->points[i].y);
+        maxY = qMax(maxY, outline->points[i].y);
+    }
+    const int y1 = qMax(int(minY >> 6), deviceRect.top());
+    const int y2 = qMin(int((maxY + 63) >> 6), deviceRect.top() + deviceRect.height());
+    if (y2 - y1 < 2 * MinimumBandHeight)
+        return false;
+
+    QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    if (!threadPool || threadPool->contains(QThread::currentThread()))
+        return false;
+
+    const int segments = qMin(threadPool->maxThreadCount(), (y2 - y1) / MinimumBandHeight);
+    if (segments < 2)
+        return false;
+
+    // The clip spans are built lazily, make sure this happens before they
+    // are shared between the bands.
+    if (spanData->clip)
+        const_cast<QClipData *>(spanData->clip)->initialize();
+
+    const int left = deviceRect.x();
+    const int right = deviceRect.x() + deviceRect.width();
+    QSemaphore semaphore;
+    int y = y1;
+    for (int i = 0; i < segments; ++i) {
+        const int yn = (y2 - y) / (segments - i);
+        threadPool->start([&, y, yn]() {
+            QT_FT_Raster raster;
+            if (!qt_ft_grays_raster.raster_new(&raster)) {
+                const QT_FT_BBox clip_box = { left, y, right, y + yn };
+                rasterizeGray(&raster, outline, callback, spanData, clip_box);
+                qt_ft_grays_raster.raster_done(raster);
+            }
+            semaphore.release(1);
+        });
+        y += yn;
+    }
+    semaphore.acquire(segments);
+    return true;
+#else
+    Q_UNUSED(outline);
+    Q_UNUSED(callback);
+    Q_UNUSED(spanData);
+    return false;
+#endif
+}
+
 void QRasterPaintEnginePrivate::updateClipping()
 {
     Q_Q(QRasterPaintEngine);
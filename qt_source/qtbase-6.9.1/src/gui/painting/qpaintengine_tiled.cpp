@@ -0,0 +1,315 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpaintengine_tiled_p.h"
+
+#include <qpainter.h>
+
+#if QT_CONFIG(qtgui_threadpool)
+#include <qsemaphore.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <private/qguiapplication_p.h>
+#endif
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QTiledRasterPaintDevice
+    \internal
+    \inmodule QtGui
+
+    \brief The QTiledRasterPaintDevice class is a paint device that renders
+    into a QImage using several threads.
+
+    Painting on a QTiledRasterPaintDevice records the command stream instead
+    of rasterizing it right away. When the painter ends, or when the pending
+    command list grows too large, the stream is replayed in parallel into
+    horizontal bands of the target image, each band using its own
+    QRasterPaintEngine with its own clip and rasterizer state. Commands whose
+    device bounds do not touch a band are skipped for that band.
+
+    The bands share the scanlines of the target image and are only clipped,
+    never translated, so each band sees the same device coordinates as the
+    serial path. Aliased rasterization depends on the clip, though, so a
+    recording that contains aliased primitives is replayed serially, and the
+    result is always the same as painting on the image directly.
+
+    Text is rendered through thread-affine font engines, so text items act as
+    a barrier: the pending commands are flushed and the text item is drawn on
+    the calling thread.
+
+    The target image must not be used as a source image while painting.
+*/
+
+/*!
+    Constructs a paint device that renders into \a target. The image must
+    stay valid as long as the device is being painted on.
+*/
+QTiledRasterPaintDevice::QTiledRasterPaintDevice(QImage *target)
+    : m_target(target)
+{
+}
+
+QTiledRasterPaintDevice::~QTiledRasterPaintDevice()
+{
+    Q_ASSERT_X(!paintingActive(), "QTiledRasterPaintDevice::~QTiledRasterPaintDevice",
+               "Device is still being painted on");
+}
+
+/*!
+    Sets the number of bands the target is split into to \a count. A count
+    of 0, the default, uses one band per thread of the GUI thread pool.
+*/
+void QTiledRasterPaintDevice::setTileCount(int count)
+{
+    m_tileCount = qMax(0, count);
+}
+
+QPaintEngine *QTiledRasterPaintDevice::paintEngine() const
+{
+    if (!m_engine)
+        m_engine = std::make_unique<QTiledRasterPaintEngine>();
+    return m_engine.get();
+}
+
+int QTiledRasterPaintDevice::metric(PaintDeviceMetric metric) const
+{
+    if (!m_target)
+        return 0;
+    return qt_paint_device_metric(m_target, metric);
+}
+
+// Commands below this device height are not worth a band of their own.
+static constexpr int MinimumBandHeight = 32;
+// Upper bound of the recorded command list before it is flushed.
+static constexpr qsizetype MaxPendingCommands = 1 << 16;
+
+// Returns whether \a command produces the same pixels when it is clipped to
+// a band. QRasterizer and QCosmeticStroker clamp aliased edges to the clip
+// before rounding them, so only antialiased primitives, and rects and images
+// that are not rotated, are exact. Path clips are rasterized the same way.
+static bool isBandExact(const QPaintRecording &recording, const QPaintRecording::Command &command)
+{
+    const QPaintRecording::State &state = recording.states.at(command.state);
+    const bool antialiased = state.renderHints & QPainter::Antialiasing;
+    if (!antialiased) {
+        for (const QPainterClipInfo &info : recording.clips.at(state.clip).infos) {
+            if (info.clipType == QPainterClipInfo::PathClip
+                || info.matrix.type() > QTransform::TxScale) {
+                return false;
+            }
+        }
+    }
+
+    switch (command.type) {
+    case QPaintRecording::CommandType::FillRectBrush:
+    case QPaintRecording::CommandType::FillRectColor:
+    case QPaintRecording::CommandType::FillRectBatch:
+    case QPaintRecording::CommandType::DrawPixmapAt:
+    case QPaintRecording::CommandType::DrawPixmap:
+    case QPaintRecording::CommandType::DrawImageAt:
+    case QPaintRecording::CommandType::DrawImage:
+    case QPaintRecording::CommandType::DrawTiledPixmap:
+        return antialiased || state.matrix.type() <= QTransform::TxScale;
+    default:
+        return antialiased;
+    }
+}
+
+class QTiledRasterPaintEnginePrivate : public QRecordingPaintEnginePrivate
+{
+    Q_DECLARE_PUBLIC(QTiledRasterPaintEngine)
+public:
+    QImage *target = nullptr;
+    uchar *bits = nullptr;
+    int tileCount = 0;
+
+    QImage directImage;
+    std::unique_ptr<QPainter> directPainter;
+};
+
+/*!
+    \class QTiledRasterPaintEngine
+    \internal
+    \inmodule QtGui
+
+    \brief The QTiledRasterPaintEngine class records painting commands and
+    replays them in parallel into bands of a QImage.
+
+    \sa QTiledRasterPaintDevice
+*/
+
+QTiledRasterPaintEngine::QTiledRasterPaintEngine()
+    : QRecordingPaintEngine(*(new QTiledRasterPaintEnginePrivate))
+{
+    d_func()->maximumCommandCount = MaxPendingCommands;
+}
+
+QTiledRasterPaintEngine::~QTiledRasterPaintEngine()
+{
+}
+
+bool QTiledRasterPaintEngine::begin(QPaintDevice *device)
+{
+    Q_D(QTiledRasterPaintEngine);
+    QTiledRasterPaintDevice *tiledDevice = static_cast<QTiledRasterPaintDevice *>(device);
+    QImage *target = tiledDevice->target();
+    if (!target || target->isNull()) {
+        qWarning("QTiledRasterPaintEngine::begin: Cannot paint on a null image");
+        return false;
+    }
+
+    d->target = target;
+    d->tileCount = tiledDevice->tileCount();
+    d->bits = target->bits();
+    d->directImage = QImage(d->bits, target->width(), target->height(),
+                            target->bytesPerLine(), target->format());
+    d->directImage.setColorTable(target->colorTable());
+    d->directImage.setColorSpace(target->colorSpace());
+    d->directPainter = std::make_unique<QPainter>();
+    if (!d->directPainter->begin(&d->directImage)) {
+        d->directPainter.reset();
+        d->directImage = QImage();
+        return false;
+    }
+
+    gccaps &= ~PorterDuff;
+    if (target->hasAlphaChannel())
+        gccaps |= PorterDuff;
+
+    resetRecording();
+    return true;
+}
+
+bool QTiledRasterPaintEngine::end()
+{
+    Q_D(QTiledRasterPaintEngine);
+    flush();
+    d->directPainter->end();
+    d->directPainter.reset();
+    d->directImage = QImage();
+    d->bits = nullptr;
+    d->target = nullptr;
+    return true;
+}
+
+/*!
+    Replays all pending commands into the target image and clears the
+    recording.
+*/
+void QTiledRasterPaintEngine::flush()
+{
+    Q_D(QTiledRasterPaintEngine);
+    if (d->recording.isEmpty())
+        return;
+
+    const int width = d->target->width();
+    const int height = d->target->height();
+    int tiles = d->tileCount;
+
+#if QT_CONFIG(qtgui_threadpool)
+    QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    if (tiles == 0 && threadPool)
+        tiles = threadPool->maxThreadCount();
+    tiles = std::min(tiles, height / MinimumBandHeight);
+    if (tiles > 1) {
+        const auto &commands = d->recording.commands;
+        if (!std::all_of(commands.cbegin(), commands.cend(), [d](const auto &command) {
+                return isBandExact(d->recording, command);
+            })) {
+            tiles = 1;
+        }
+    }
+    if (tiles > 1 && threadPool && !threadPool->contains(QThread::currentThread())) {
+        const QImage::Format format = d->target->format();
+        const qsizetype bytesPerLine = d->target->bytesPerLine();
+        const QList<QRgb> colorTable = d->target->colorTable();
+        const QColorSpace colorSpace = d->target->colorSpace();
+        auto replayBand = [&](const QRect &band) {
+            QImage image(d->bits, width, height, bytesPerLine, format);
+            image.setColorTable(colorTable);
+            image.setColorSpace(colorSpace);
+            QPainter painter(&image);
+            // Bands are clipped rather than translated so that every band
+            // sees the device coordinates of the serial path.
+            painter.setClipRect(band);
+            d->recording.replay(&painter, band);
+        };
+
+        QSemaphore semaphore;
+        int y = 0;
+        for (int i = 0; i < tiles; ++i) {
+            int yn = (height - y) / (tiles - i);
+            threadPool->start([&, y, yn]() {
+                replayBand(QRect(0, y, width, yn));
+                semaphore.release(1);
+            });
+            y += yn;
+        }
+        semaphore.acquire(tiles);
+        resetRecording();
+        return;
+    }
+#else
+    Q_UNUSED(tiles);
+    Q_UNUSED(width);
+    Q_UNUSED(height);
+#endif
+
+    d->recording.replay(d->directPainter.get());
+    resetRecording();
+}
+
+void QTiledRasterPaintEngine::recordingFull()
+{
+    flush();
+}
+
+void QTiledRasterPaintEngine::drawTextItem(const QPointF &p, const QTextItem &textItem)
+{
+    Q_D(QTiledRasterPaintEngine);
+    flush();
+    QPainter *painter = d->directPainter.get();
+    painter->save();
+    d->recording.applyState(painter, QTransform(), d->recording.states.at(d->snapshotState()),
+                            nullptr);
+    static_cast<QPaintEngineEx *>(painter->paintEngine())->drawTextItem(p, textItem);
+    painter->restore();
+}
+
+void QTiledRasterPaintEngine::drawStaticTextItem(QStaticTextItem *textItem)
+{
+    Q_D(QTiledRasterPaintEngine);
+    flush();
+    QPainter *painter = d->directPainter.get();
+    painter->save();
+    d->recording.applyState(painter, QTransform(), d->recording.states.at(d->snapshotState()),
+                            nullptr);
+    static_cast<QPaintEngineEx *>(painter->paintEngine())->drawStaticTextItem(textItem);
+    painter->restore();
+}
+
+bool QTiledRasterPaintEngine::requiresPretransformedGlyphPositions(QFontEngine *fontEngine,
+                                                                   const QTransform &m) const
+{
+    Q_D(const QTiledRasterPaintEngine);
+    if (!d->directPainter)
+        return QPaintEngineEx::requiresPretransformedGlyphPositions(fontEngine, m);
+    return static_cast<QPaintEngineEx *>(d->directPainter->paintEngine())
+            ->requiresPretransformedGlyphPositions(fontEngine, m);
+}
+
+bool QTiledRasterPaintEngine::shouldDrawCachedGlyphs(QFontEngine *fontEngine,
+                                                     const QTransform &m) const
+{
+    Q_D(const QTiledRasterPaintEngine);
+    if (!d->directPainter)
+        return QPaintEngineEx::shouldDrawCachedGlyphs(fontEngine, m);
+    return static_cast<QPaintEngineEx *>(d->directPainter->paintEngine())
+            ->shouldDrawCachedGlyphs(fontEngine, m);
+}
+
+QT_END_NAMESPACE
@@ -9,8 +9,21 @@
 #include <private/qfontengine_p.h>
 #include <private/qstatictext_p.h>
 
+#include <qcache.h>
+#include <qmutex.h>
 #include <qvarlengtharray.h>
 #include <qdebug.h>
+#if QT_CONFIG(qtgui_threadpool)
+#include <qsemaphore.h>
+#include <qthread.h>
+#include <qthreadpool.h>
+#include <private/qguiapplication_p.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
 
 
 QT_BEGIN_NAMESPACE
@@ -328,6 +341,431 @@ static void qpaintengineex_cubicTo(qreal c1x, qreal c1y, qreal c2x, qreal c2y, q
     ((StrokeHandler *) data)->types.add(QPainterPath::CurveToDataElement);
 }
 
+/*
+    Outlines of long strokes are kept in a process-wide cache, keyed by the
+    path data and by everything the outline depends on: the pen, the part of
+    the transform used by the stroker and the clip used to drop dashes.
+
+    The path is hashed once per stroke. An entry keeps a copy of the path
+    and of the parameters it was stroked with, and a hit is only taken if
+    they compare equal, so a hash collision can never return the outline of
+    another path. An outline is only stored once the same hash missed
+    recently, so paths that are stroked once never pay for the copies.
+*/
+namespace {
+enum {
+    StrokeCacheThreshold = 1024,        // elements
+    StrokeCacheMaxCost = 16 * 1024,     // KB
+    StrokeCacheMissHistory = 64,        // hashes
+    ParallelStrokeThreshold = 16384,    // elements
+    MinimumStrokeRunLength = 2048       // elements
+};
+
+struct StrokeParameters
+{
+    qreal width = 0;
+    qreal miterLimit = 0;
+    qreal dashOffset = 0;
+    qreal scale = 0;
+    QRectF clipRect;
+    QTransform matrix;
+    QList<qreal> dashPattern;
+    int style = 0;
+    int capStyle = 0;
+    int joinStyle = 0;
+    uint hints = 0;
+    bool cosmetic = false;
+
+    friend bool operator==(const StrokeParameters &a, const StrokeParameters &b)
+    {
+        return a.width == b.width && a.miterLimit == b.miterLimit
+            && a.dashOffset == b.dashOffset && a.scale == b.scale
+            && a.clipRect == b.clipRect && a.matrix == b.matrix
+            && a.dashPattern == b.dashPattern && a.style == b.style
+            && a.capStyle == b.capStyle && a.joinStyle == b.joinStyle
+            && a.hints == b.hints && a.cosmetic == b.cosmetic;
+    }
+};
+
+// A stroke to look up, referring to the path data without copying it.
+struct StrokeCacheQuery
+{
+    const qreal *points = nullptr;
+    const QPainterPath::ElementType *types = nullptr;
+    int elementCount = 0;
+    StrokeParameters parameters;
+    size_t hash = 0;
+};
+
+struct StrokeOutline
+{
+    QList<qreal> sourcePoints;
+    QList<QPainterPath::ElementType> sourceTypes;
+    StrokeParameters parameters;
+
+    QList<qreal> pts;
+    QList<QPainterPath::ElementType> types;
+    uint flags;
+
+    bool matches(const StrokeCacheQuery &query) const
+    {
+        const qsizetype typeCount = query.types ? query.elementCount : 0;
+        return sourcePoints.size() == 2 * qsizetype(query.elementCount)
+            && sourceTypes.size() == typeCount
+            && parameters == query.parameters
+            && memcmp(sourcePoints.constData(), query.points,
+                      sourcePoints.size() * sizeof(qreal)) == 0
+            && (!typeCount || memcmp(sourceTypes.constData(), query.types,
+                                     typeCount * sizeof(QPainterPath::ElementType)) == 0);
+    }
+};
+
+class StrokeCache
+{
+public:
+    bool find(const StrokeCacheQuery &query, StrokeHandler *handler, uint *flags)
+    {
+        std::shared_ptr<const StrokeOutline> outline;
+        {
+            QMutexLocker locker(&mutex);
+            if (const auto *entry = cache.object(query.hash))
+                outline = *entry;
+        }
+        // The entry is immutable, so it is compared and copied unlocked.
+        if (!outline || !outline->matches(query))
+            return false;
+        handler->pts.resize(outline->pts.size());
+        handler->types.resize(outline->types.size());
+        memcpy(handler->pts.data(), outline->pts.constData(), outline->pts.size() * sizeof(qreal));
+        memcpy(handler->types.data(), outline->types.constData(),
+               outline->types.size() * sizeof(QPainterPath::ElementType));
+        *flags = outline->flags;
+        return true;
+    }
+
+    // Records a miss and returns whether the same hash missed recently.
+    bool isRepeatedMiss(const StrokeCacheQuery &query)
+    {
+        QMutexLocker locker(&mutex);
+        const auto end = recentMisses + StrokeCacheMissHistory;
+        size_t *it = std::find(recentMisses, end, query.hash);
+        if (it != end) {
+            *it = 0;
+            return true;
+        }
+        recentMisses[nextMiss] = query.hash;
+        nextMiss = (nextMiss + 1) % StrokeCacheMissHistory;
+        return false;
+    }
+
+    void insert(const StrokeCacheQuery &query, const StrokeHandler *handler, uint flags)
+    {
+        auto outline = std::make_shared<StrokeOutline>();
+        outline->sourcePoints = QList<qreal>(query.points, query.points + 2 * query.elementCount);
+        if (query.types)
+            outline->sourceTypes = QList<QPainterPath::ElementType>(query.types, query.types + query.elementCount);
+        outline->parameters = query.parameters;
+        outline->pts = QList<qreal>(handler->pts.data(), handler->pts.data() + handler->pts.size());
+        outline->types = QList<QPainterPath::ElementType>(handler->types.data(),
+                                                          handler->types.data() + handler->types.size());
+        outline->flags = flags;
+        const qsizetype bytes = (outline->sourcePoints.size() + outline->pts.size()) * sizeof(qreal)
+                + (outline->sourceTypes.size() + outline->types.size())
+                  * sizeof(QPainterPath::ElementType);
+        QMutexLocker locker(&mutex);
+        cache.insert(query.hash, new std::shared_ptr<const StrokeOutline>(std::move(outline)),
+                     1 + bytes / 1024);
+    }
+
+private:
+    QMutex mutex;
+    QCache<size_t, std::shared_ptr<const StrokeOutline>> cache{StrokeCacheMaxCost};
+    size_t recentMisses[StrokeCacheMissHistory] = {};
+    int nextMiss = 0;
+};
+} // unnamed namespace
+
+Q_GLOBAL_STATIC(StrokeCache, qt_stroke_cache)
+
+Q_GUI_EXPORT extern bool qt_scaleForTransform(const QTransform &transform, qreal *scale); // qtransform.cpp
+
+static StrokeCacheQuery qt_stroke_cache_query(const QVectorPath &path, const QPen &pen,
+                                              const QTransform &matrix, const QRectF &clipRect)
+{
+    StrokeCacheQuery query;
+    query.points = path.points();
+    query.types = path.elements();
+    query.elementCount = path.elementCount();
+
+    StrokeParameters &parameters = query.parameters;
+    parameters.width = pen.widthF();
+    parameters.miterLimit = pen.miterLimit();
+    parameters.style = int(pen.style());
+    parameters.capStyle = int(pen.capStyle());
+    parameters.joinStyle = int(pen.joinStyle());
+    parameters.cosmetic = pen.isCosmetic();
+    parameters.hints = path.hints() & (QVectorPath::ImplicitClose | QVectorPath::ExplicitOpen);
+    if (pen.style() > Qt::SolidLine) {
+        parameters.dashOffset = pen.dashOffset();
+        parameters.clipRect = clipRect;
+        parameters.dashPattern = pen.dashPattern();
+    }
+    if (pen.isCosmetic()) {
+        // Cosmetic pens are stroked in device coordinates.
+        parameters.matrix = matrix;
+    } else if (!qt_scaleForTransform(matrix, &parameters.scale)) {
+        // Otherwise only the curve flattening depends on the transform.
+        parameters.scale = 0;
+    }
+
+    size_t h = qHashBits(query.points, size_t(query.elementCount) * 2 * sizeof(qreal));
+    if (query.types)
+        h = qHashBits(query.types, size_t(query.elementCount) * sizeof(QPainterPath::ElementType), h);
+    h = qHashMulti(h, parameters.width, parameters.miterLimit, parameters.style,
+                   parameters.capStyle, parameters.joinStyle, parameters.cosmetic,
+                   parameters.hints, parameters.dashOffset, parameters.scale,
+                   parameters.clipRect.x(), parameters.clipRect.y(),
+                   parameters.clipRect.width(), parameters.clipRect.height(),
+                   parameters.matrix);
+    query.hash = qHashRange(parameters.dashPattern.cbegin(), parameters.dashPattern.cend(), h);
+    return query;
+}
+
+#if QT_CONFIG(qtgui_threadpool)
+namespace {
+// A run of elements stroked on its own. Runs that are not pieces hold
+// whole subpaths. Pieces of a solid subpath start or end halfway along the
+// segment they share with the neighbouring piece, where both get a flat
+// cap; pieces of a dashed subpath meet at a vertex inside a dash gap.
+struct StrokeRun
+{
+    int begin;
+    int end;
+    qreal dashOffset;
+    bool piece;
+    bool midStart;
+    bool midEnd;
+};
+} // unnamed namespace
+#endif
+
+/*
+    Strokes \a path into \a handler by splitting it into runs that are
+    stroked concurrently and concatenating their outlines in order. Long
+    open polylines are split into pieces as well. Since the outline is
+    filled with the winding rule, pieces that abut along a flat cap give
+    the same coverage as the outline of the whole subpath.
+
+    Only paths made of lines are handled, returns \c false if the path was
+    not stroked.
+*/
+static bool qt_stroke_in_parallel(const QVectorPath &path, const QStroker &config,
+                                  const QDashStroker *dashConfig, const QRectF &clipRect,
+                                  const QTransform *matrix, StrokeHandler *handler)
+{
+#if QT_CONFIG(qtgui_threadpool)
+    const int count = path.elementCount();
+    if (count < ParallelStrokeThreshold || path.hasImplicitClose())
+        return false;
+
+    QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    if (!threadPool || threadPool->contains(QThread::currentThread()))
+        return false;
+
+    const int segments = qMin(threadPool->maxThreadCount(), count / MinimumStrokeRunLength);
+    if (segments < 2)
+        return false;
+    const int target = (count + segments - 1) / segments;
+
+    const QPainterPath::ElementType *types = path.elements();
+    const qreal *points = path.points();
+    const auto pointAt = [points, matrix](int i) {
+        const QPointF p(points[2 * i], points[2 * i + 1]);
+        return matrix ? matrix->map(p) : p;
+    };
+
+    // Mirror the dash setup of QDashStroker::processCurrentSubpath() to
+    // find the dash phase at the vertices.
+    qreal dashes[32];
+    int dashCount = 0;
+    qreal sumLength = 0;
+    if (dashConfig) {
+        const QList<qfixed> pattern = dashConfig->dashPattern();
+        dashCount = qMin(pattern.size(), 32);
+        // An odd pattern is cycled without its last entry, which the
+        // phase below would not account for.
+        if (dashCount == 0 || dashCount % 2)
+            return false;
+        for (int i = 0; i < dashCount; ++i) {
+            dashes[i] = qMax(pattern.at(i), qreal(0)) * config.strokeWidth();
+            sumLength += dashes[i];
+        }
+        if (qFuzzyIsNull(sumLength))
+            return false;
+    }
+    const qreal margin = sumLength * qreal(0.001);
+    const auto insideGap = [&](qreal phase) {
+        int i = 0;
+        while (phase >= dashes[i]) {
+            phase -= dashes[i];
+            if (++i >= dashCount)
+                i = 0;
+        }
+        return (i & 1) && phase > margin && dashes[i] - phase > margin;
+    };
+    const auto startPhase = [&]() {
+        qreal phase = std::fmod(dashConfig->dashOffset() * config.strokeWidth(), sumLength);
+        return phase < 0 ? phase + sumLength : phase;
+    };
+
+    QList<StrokeRun> runs;
+    int s = 0;
+    while (s < count) {
+        int e = s + 1;
+        if (types) {
+            if (types[s] != QPainterPath::MoveToElement)
+                return false;
+            while (e < count && types[e] != QPainterPath::MoveToElement) {
+                if (types[e] != QPainterPath::LineToElement)
+                    return false;
+                ++e;
+            }
+        } else {
+            e = count;
+        }
+
+        const bool closed = !config.forceOpen() && pointAt(s) == pointAt(e - 1);
+        if (e - s <= target || (closed && !dashConfig)) {
+            if (!runs.isEmpty() && !runs.last().piece && runs.last().end - runs.last().begin < target)
+                runs.last().end = e;
+            else
+                runs.append({ s, e, 0, false, false, false });
+            s = e;
+            continue;
+        }
+
+        const int pieces = (e - s + target - 1) / target;
+        int pieceBegin = s;
+        bool midStart = false;
+        qreal pieceOffset = dashConfig ? dashConfig->dashOffset() : 0;
+        qreal phase = dashConfig ? startPhase() : 0;
+        QPointF prev = pointAt(s);
+        if (!qIsFinite(prev.x()) || !qIsFinite(prev.y()))
+            return false;
+        for (int v = s + 1, j = 1; v < e - 1; ++v) {
+            const QPointF p = pointAt(v);
+            if (!qIsFinite(p.x()) || !qIsFinite(p.y()))
+                return false;
+            if (dashConfig)
+                phase = std::fmod(phase + QLineF(prev, p).length(), sumLength);
+            if (j < pieces && v >= s + qint64(j) * (e - s) / pieces && v - pieceBegin > 2) {
+                if (dashConfig) {
+                    if (insideGap(phase)) {
+                        runs.append({ pieceBegin, v + 1, pieceOffset, true, false, false });
+                        pieceBegin = v;
+                        pieceOffset = phase / config.strokeWidth();
+                        ++j;
+                    }
+                } else {
+                    const QPointF mid = (prev + p) / 2;
+                    if (mid != prev && mid != p) {
+                        runs.append({ pieceBegin, v, 0, true, midStart, true });
+                        pieceBegin = v;
+                        midStart = true;
+                        ++j;
+                    }
+                }
+            }
+            prev = p;
+        }
+        runs.append({ pieceBegin, e, pieceOffset, true, midStart, false });
+        s = e;
+    }
+    if (runs.size() < 2)
+        return false;
+
+    std::vector<std::unique_ptr<StrokeHandler>> outlines(runs.size());
+    QSemaphore semaphore;
+    for (qsizetype i = 0; i < runs.size(); ++i) {
+        threadPool->start([&, i]() {
+            const StrokeRun &run = runs.at(i);
+            outlines[i] = std::make_unique<StrokeHandler>(2 * (run.end - run.begin) + 4);
+
+            QStroker stroker;
+            stroker.setMoveToHook(qpaintengineex_moveTo);
+            stroker.setLineToHook(qpaintengineex_lineTo);
+            stroker.setCubicToHook(qpaintengineex_cubicTo);
+            stroker.setStrokeWidth(config.strokeWidth());
+            stroker.setCapStyle(config.capStyle());
+            stroker.setJoinStyle(config.joinStyle());
+            stroker.setMiterLimit(config.miterLimit());
+            stroker.setForceOpen(config.forceOpen() || (run.piece && !dashConfig));
+            stroker.setFlatEnds(run.midStart, run.midEnd);
+
+            QDashStroker dasher(&stroker);
+            QStrokerOps *ops = &stroker;
+            if (dashConfig) {
+                dasher.setDashPattern(dashConfig->dashPattern());
+                dasher.setDashOffset(run.dashOffset);
+                if (!clipRect.isNull())
+                    dasher.setClipRect(clipRect);
+                ops = &dasher;
+            }
+
+            ops->begin(outlines[i].get());
+            if (!run.piece) {
+                for (int k = run.begin; k < run.end; ++k) {
+                    const QPointF p = pointAt(k);
+                    if (k == run.begin || (types && types[k] == QPainterPath::MoveToElement))
+                        ops->moveTo(p.x(), p.y());
+                    else
+                        ops->lineTo(p.x(), p.y());
+                }
+            } else {
+                const QPointF first = run.midStart
+                        ? (pointAt(run.begin - 1) + pointAt(run.begin)) / 2 : pointAt(run.begin);
+                ops->moveTo(first.x(), first.y());
+                for (int k = run.midStart ? run.begin : run.begin + 1; k < run.end; ++k) {
+                    const QPointF p = pointAt(k);
+                    ops->lineTo(p.x(), p.y());
+                }
+                if (run.midEnd) {
+                    const QPointF last = (pointAt(run.end - 1) + pointAt(run.end)) / 2;
+                    ops->lineTo(last.x(), last.y());
+                }
+            }
+            ops->end();
+            semaphore.release(1);
+        });
+    }
+    semaphore.acquire(runs.size());
+
+    qsizetype elementCount = 0;
+    for (const auto &outline : outlines)
+        elementCount += outline->types.size();
+    handler->pts.resize(2 * elementCount);
+    handler->types.resize(elementCount);
+    qreal *pts = handler->pts.data();
+    QPainterPath::ElementType *elementTypes = handler->types.data();
+    for (const auto &outline : outlines) {
+        const qsizetype n = outline->types.size();
+        memcpy(pts, outline->pts.data(), 2 * n * sizeof(qreal));
+        memcpy(elementTypes, outline->types.data(), n * sizeof(QPainterPath::ElementType));
+        pts += 2 * n;
+        elementTypes += n;
+    }
+    return true;
+#else
+    Q_UNUSED(path);
+    Q_UNUSED(config);
+    Q_UNUSED(dashConfig);
+    Q_UNUSED(clipRect);
+    Q_UNUSED(matrix);
+    Q_UNUSED(handler);
+    return false;
+#endif
+}
+
 QPaintEngineEx::QPaintEngineEx()
     : QPaintEngine(*new QPaintEngineExPrivate, AllFeatures)
 {
@@ -347,8 +785,6 @@ QPainterState *QPaintEngineEx::createState(QPainterState *orig) const
     return new QPainterState(orig);
 }
 
-Q_GUI_EXPORT extern bool qt_scaleForTransform(const QTransform &transform, qreal *scale); // qtransform.cpp
-
 void QPaintEngineEx::stroke(const QVectorPath &path, const QPen &inPen)
 {
 #ifdef QT_DEBUG_DRAW
@@ -450,120 +886,139 @@ void QPaintEngineEx::stroke(const QVectorPath &path, const QPen &inPen)
     if (d->stroker.capStyle() == Qt::RoundCap || d->stroker.joinStyle() == Qt::RoundJoin)
         flags |= QVectorPath::CurvedShapeMask;
 
+    const QDashStroker *dashConfig = d->activeStroker == &d->dasher ? &d->dasher : nullptr;
+    const bool cacheable = pointCount >= StrokeCacheThreshold;
+    StrokeCacheQuery cacheQuery;
+    if (cacheable)
+        cacheQuery = qt_stroke_cache_query(path, pen, state()->matrix, clipRect);
+    const bool cached = cacheable && qt_stroke_cache()->find(cacheQuery, d->strokeHandler, &flags);
+    const bool cacheOutline = cacheable && !cached && qt_stroke_cache()->isRepeatedMiss(cacheQuery);
+
     // ### Perspective Xforms are currently not supported...
     if (!pen.isCosmetic()) {
         // We include cosmetic pens in this case to avoid having to
         // change the current transform. Normal transformed,
         // non-cosmetic pens will be transformed as part of fill
         // later, so they are also covered here..
-        d->activeStroker->setCurveThresholdFromTransform(state()->matrix);
-        d->activeStroker->begin(d->strokeHandler);
-        if (types) {
-            while (points < lastPoint) {
-                switch (*types) {
-                case QPainterPath::MoveToElement:
-                    d->activeStroker->moveTo(points[0], points[1]);
-                    points += 2;
-                    ++types;
-                    break;
-                case QPainterPath::LineToElement:
-                    d->activeStroker->lineTo(points[0], points[1]);
-                    points += 2;
-                    ++types;
-                    break;
-                case QPainterPath::CurveToElement:
-                    d->activeStroker->cubicTo(points[0], points[1],
-                                              points[2], points[3],
-                                              points[4], points[5]);
-                    points += 6;
-                    types += 3;
-                    flags |= QVectorPath::CurvedShapeMask;
-                    break;
-                default:
-                    break;
-                }
-            }
-            if (path.hasImplicitClose())
-                d->activeStroker->lineTo(path.points()[0], path.points()[1]);
-
-        } else {
-            d->activeStroker->moveTo(points[0], points[1]);
-            points += 2;
-            while (points < lastPoint) {
-                d->activeStroker->lineTo(points[0], points[1]);
-                points += 2;
-            }
-            if (path.hasImplicitClose())
-                d->activeStroker->lineTo(path.points()[0], path.points()[1]);
-        }
-        d->activeStroker->end();
-
-        if (!d->strokeHandler->types.size()) // an empty path...
-            return;
-
-        QVectorPath strokePath(d->strokeHandler->pts.data(),
-                               d->strokeHandler->types.size(),
-                               d->strokeHandler->types.data(),
-                               flags);
-        fill(strokePath, pen.brush());
-    } else {
-        // For cosmetic pens we need a bit of trickery... We to process xform the input points
-        if (state()->matrix.type() >= QTransform::TxProject) {
-            QPainterPath painterPath = state()->matrix.map(path.convertToPainterPath());
-            d->activeStroker->strokePath(painterPath, d->strokeHandler, QTransform());
-        } else {
-            d->activeStroker->setCurveThresholdFromTransform(QTransform());
+        if (!cached && !qt_stroke_in_parallel(path, d->stroker, dashConfig, clipRect,
+                                              nullptr, d->strokeHandler)) {
+            d->activeStroker->setCurveThresholdFromTransform(state()->matrix);
             d->activeStroker->begin(d->strokeHandler);
             if (types) {
                 while (points < lastPoint) {
                     switch (*types) {
-                    case QPainterPath::MoveToElement: {
-                        QPointF pt = (*(const QPointF *) points) * state()->matrix;
-                        d->activeStroker->moveTo(pt.x(), pt.y());
+                    case QPainterPath::MoveToElement:
+                        d->activeStroker->moveTo(points[0], points[1]);
                         points += 2;
                         ++types;
                         break;
-                    }
-                    case QPainterPath::LineToElement: {
-                        QPointF pt = (*(const QPointF *) points) * state()->matrix;
-                        d->activeStroker->lineTo(pt.x(), pt.y());
+                    case QPainterPath::LineToElement:
+                        d->activeStroker->lineTo(points[0], points[1]);
                         points += 2;
                         ++types;
                         break;
-                    }
-                    case QPainterPath::CurveToElement: {
-                        QPointF c1 = ((const QPointF *) points)[0] * state()->matrix;
-                        QPointF c2 = ((const QPointF *) points)[1] * state()->matrix;
-                        QPointF e =  ((const QPointF *) points)[2] * state()->matrix;
-                        d->activeStroker->cubicTo(c1.x(), c1.y(), c2.x(), c2.y(), e.x(), e.y());
+                    case QPainterPath::CurveToElement:
+                        d->activeStroker->cubicTo(points[0], points[1],
+                                                  points[2], points[3],
+                                                  points[4], points[5]);
                         points += 6;
                         types += 3;
                         flags |= QVectorPath::CurvedShapeMask;
                         break;
-                    }
                     default:
                         break;
                     }
                 }
-                if (path.hasImplicitClose()) {
-                    QPointF pt = * ((const QPointF *) path.points()) * state()->matrix;
-                    d->activeStroker->lineTo(pt.x(), pt.y());
-                }
+                if (path.hasImplicitClose())
+                    d->activeStroker->lineTo(path.points()[0], path.points()[1]);
 
             } else {
-                QPointF p = ((const QPointF *)points)[0] * state()->matrix;
-                d->activeStroker->moveTo(p.x(), p.y());
+                d->activeStroker->moveTo(points[0], points[1]);
                 points += 2;
                 while (points < lastPoint) {
-                    QPointF p = ((const QPointF *)points)[0] * state()->matrix;
-                    d->activeStroker->lineTo(p.x(), p.y());
+                    d->activeStroker->lineTo(points[0], points[1]);
                     points += 2;
                 }
                 if (path.hasImplicitClose())
-                    d->activeStroker->lineTo(p.x(), p.y());
+                    d->activeStroker->lineTo(path.points()[0], path.points()[1]);
             }
             d->activeStroker->end();
         }
+        if (cacheOutline)
+            qt_stroke_cache()->insert(cacheQuery, d->strokeHandler, flags);
+
+        if (!d->strokeHandler->types.size()) // an empty path...
+            return;
+
+        QVectorPath strokePath(d->strokeHandler->pts.data(),
+                               d->strokeHandler->types.size(),
+                               d->strokeHandler->types.data(),
+                               flags);
+        fill(strokePath, pen.brush());
+    } else {
+        // For cosmetic pens we need a bit of trickery... We to process xform the input points
+        if (!cached) {
+            if (state()->matrix.type() >= QTransform::TxProject) {
+                QPainterPath painterPath = state()->matrix.map(path.convertToPainterPath());
+                d->activeStroker->strokePath(painterPath, d->strokeHandler, QTransform());
+            } else if (!qt_stroke_in_parallel(path, d->stroker, dashConfig, clipRect,
+                                              &state()->matrix, d->strokeHandler)) {
+                d->activeStroker->setCurveThresholdFromTransform(QTransform());
+                d->activeStroker->begin(d->strokeHandler);
+                if (types) {
+                    while (points < lastPoint) {
+                        switch (*types) {
+                        case QPainterPath::MoveToElement: {
+                            QPointF pt = (*(const QPointF *) points) * state()->matrix;
+                            d->activeStroker->moveTo(pt.x(), pt.y());
+                            points += 2;
+                            ++types;
+                            break;
+                        }
+                        case QPainterPath::LineToElement: {
+                            QPointF pt = (*(const QPointF *) points) * state()->matrix;
+                            d->activeStroker->lineTo(pt.x(), pt.y());
+                            points += 2;
+                            ++types;
+                            break;
+                        }
+                        case QPainterPath::CurveToElement: {
+                            QPointF c1 = ((const QPointF *) points)[0] * state()->matrix;
+                            QPointF c2 = ((const QPointF *) points)[1] * state()->matrix;
+                            QPointF e =  ((const QPointF *) points)[2] * state()->matrix;
+                            d->activeStroker->cubicTo(c1.x(), c1.y(), c2.x(), c2.y(), e.x(), e.y());
+                            points += 6;
+                            types += 3;
+                            flags |= QVectorPath::CurvedShapeMask;
+                            break;
+                        }
+                        default:
+                            break;
+                        }
+                    }
+                    if (path.hasImplicitClose()) {
+                        QPointF pt = * ((const QPointF *) path.points()) * state()->matrix;
+                        d->activeStroker->lineTo(pt.x(), pt.y());
+                    }
+
+                } else {
+                    QPointF p = ((const QPointF *)points)[0] * state()->matrix;
+                    d->activeStroker->moveTo(p.x(), p.y());
+                    points += 2;
+                    while (points < lastPoint) {
+                        QPointF p = ((const QPointF *)points)[0] * state()->matrix;
+                        d->activeStroker->lineTo(p.x(), p.y());
+                        points += 2;
+                    }
+                    if (path.hasImplicitClose())
+                        d->activeStroker->lineTo(p.x(), p.y());
+                }
+                d->activeStroker->end();
+            }
+
+            if (cacheOutline)
+                qt_stroke_cache()->insert(cacheQuery, d->strokeHandler, flags);
+        }
 
         QVectorPath strokePath(d->strokeHandler->pts.data(),
                                d->strokeHandler->types.size(),
@@ -697,6 +1152,15 @@ void QPaintEngineEx::fillRect(const QRectF &r, const QColor &color)
     fillRect(r, QBrush(color));
 }
 
+void QPaintEngineEx::fillRectBatch(const QRectF *rects, int rectCount,
+                                   const QColor *colors, int colorCount)
+{
+    Q_ASSERT(isActive());
+    Q_ASSERT(colorCount == 1 || colorCount == rectCount);
+    for (int i = 0; i < rectCount; ++i)
+        fillRect(rects[i], colors[colorCount == 1 ? 0 : i]);
+}
+
 void QPaintEngineEx::drawRects(const QRect *rects, int rectCount)
 {
     for (int i=0; i<rectCount; ++i) {
@@ -1415,6 +1415,23 @@ void QPainterPrivate::updateState(QPainterState *newState)
     independently of any active transformations.
     This value was added in Qt 6.4.
 
+    \value CollapseSubPixelPrimitives Indicates that the engine may draw
+    primitives that cover less than one device pixel as a single pixel,
+    skipping the full scan conversion. When antialiasing is enabled the
+    pixel coverage is estimated from the primitive's device bounds,
+    otherwise the pixel is filled. This trades accuracy for speed when
+    drawing many primitives at a small scale. Only the raster paint engine
+    honors this hint. Primitives without area are not drawn.
+    This value was added in Qt 6.10.
+
+    \value DistanceFieldText Indicates that the engine should draw text from
+    signed distance fields of the glyphs instead of rasterizing them for
+    every scale. One distance field per glyph serves all sizes and
+    transformations, which makes continuously zoomed text cheap, at the
+    cost of slightly rounded corners and no hinting. Color fonts are not
+    affected. Only the raster paint engine honors this hint.
+    This value was added in Qt 6.10.
+
     \sa renderHints(), setRenderHint(), {QPainter#Rendering
     Quality}{Rendering Quality}
 
@@ -5681,6 +5698,276 @@ void QPainter::drawText(const QPointF &p, const QString &str, int tf, int justif
     }
 }
 
+namespace {
+// Gathers the glyphs of many text fragments into one run per font engine
+// and color, so that each run reaches the paint engine in a single call.
+class QGlyphBatch
+{
+public:
+    explicit QGlyphBatch(QPainterPrivate *painter) : d(painter) {}
+
+    int colorIndex(const QColor &color);
+    void add(QFontEngine *fontEngine, int colorIndex, const glyph_t *glyphs,
+             const QFixedPoint *positions, qsizetype count);
+    void draw(QPainter *painter);
+
+private:
+    struct Run
+    {
+        QFontEngine *fontEngine;
+        int colorIndex;
+        bool pretransformed;
+        QList<glyph_t> glyphs;
+        QList<QFixedPoint> positions;
+    };
+
+    Run &runFor(QFontEngine *fontEngine, int colorIndex);
+
+    QPainterPrivate *d;
+    QList<Run> m_runs;
+    QHash<std::pair<QFontEngine *, int>, qsizetype> m_runIndex;
+    QList<QColor> m_colors;
+    QHash<quint64, int> m_colorIndex;
+};
+
+// Returns the index of color, or -1 for an invalid color, which stands for
+// the pen of the painter.
+int QGlyphBatch::colorIndex(const QColor &color)
+{
+    if (!color.isValid())
+        return -1;
+    const auto r = m_colorIndex.tryEmplace(quint64(color.rgba64()), int(m_colors.size()));
+    if (r.inserted)
+        m_colors.append(color);
+    return *r.iterator;
+}
+
+QGlyphBatch::Run &QGlyphBatch::runFor(QFontEngine *fontEngine, int colorIndex)
+{
+    const auto r = m_runIndex.tryEmplace({ fontEngine, colorIndex }, m_runs.size());
+    if (r.inserted) {
+        const bool pretransformed =
+                d->extended->requiresPretransformedGlyphPositions(fontEngine, d->state->matrix);
+        m_runs.append({ fontEngine, colorIndex, pretransformed, {}, {} });
+    }
+    return m_runs[*r.iterator];
+}
+
+// Adds glyphs at untransformed positions. The glyphs of a multi font engine
+// are split by the engine they come from.
+void QGlyphBatch::add(QFontEngine *fontEngine, int colorIndex, const glyph_t *glyphs,
+                      const QFixedPoint *positions, qsizetype count)
+{
+    const QTransform &transform = d->state->transform();
+    const bool isMulti = fontEngine->type() == QFontEngine::Multi;
+    qsizetype i = 0;
+    while (i < count) {
+        const uint which = isMulti ? glyphs[i] >> 24 : 0;
+        qsizetype end = i + 1;
+        if (isMulti) {
+            while (end < count && glyphs[end] >> 24 == which)
+                ++end;
+        } else {
+            end = count;
+        }
+
+        QFontEngine *engine = isMulti ? static_cast<QFontEngineMulti *>(fontEngine)->engine(which)
+                                      : fontEngine;
+        Run &run = runFor(engine, colorIndex);
+        for (qsizetype j = i; j < end; ++j) {
+            run.glyphs.append(isMulti ? glyphs[j] & 0xffffff : glyphs[j]);
+            if (run.pretransformed)
+                run.positions.append(QFixedPoint::fromPointF(transform.map(positions[j].toPointF())));
+            else
+                run.positions.append(positions[j]);
+        }
+        i = end;
+    }
+}
+
+void QGlyphBatch::draw(QPainter *painter)
+{
+    const QPen pen = d->state->pen;
+    for (Run &run : m_runs) {
+        if (run.colorIndex < 0) {
+            if (pen.style() == Qt::NoPen)
+                continue;
+            painter->setPen(pen);
+        } else {
+            painter->setPen(m_colors.at(run.colorIndex));
+        }
+        constexpr qsizetype maxChunk = std::numeric_limits<int>::max();
+        for (qsizetype i = 0; i < run.glyphs.size(); i += maxChunk) {
+            d->drawGlyphs(QPointF(), run.glyphs.constData() + i, run.positions.data() + i,
+                          int(qMin(run.glyphs.size() - i, maxChunk)), run.fontEngine,
+                          false, false, false);
+        }
+    }
+    painter->setPen(pen);
+}
+} // unnamed namespace
+
+/*!
+    \since 6.10
+
+    Draws each string in \a texts with its baseline starting at the
+    position at the same index in \a positions, using the current font,
+    transformation and layout direction. Each string is drawn in the color
+    at the same index in \a colors. If \a colors holds a single color, it is
+    used for all strings. If \a colors is empty, or for an invalid color,
+    the current pen is used.
+
+    The strings are shaped one after another, but their glyphs are grouped
+    by font and color and handed to the paint engine as one run per group,
+    so the cost of drawing does not grow with the number of strings. With
+    the raster paint engine each run is drawn from the glyph cache in one
+    pass, which makes this the preferred way to label large numbers of
+    objects.
+
+    Strings of different colors may be drawn in any order relative to each
+    other; strings of the same color are drawn in order. If the font is
+    underlined, overlined or struck out, or the paint engine cannot draw
+    glyphs directly, every string is drawn with drawText() instead.
+
+    \sa drawText(), drawGlyphRunBatch(), drawStaticText()
+*/
+void QPainter::drawTextBatch(QSpan<const QPointF> positions, QSpan<const QString> texts,
+                             QSpan<const QColor> colors)
+{
+    Q_D(QPainter);
+
+    if (!d->engine || texts.empty())
+        return;
+
+    if (positions.size() != texts.size()) {
+        qWarning("QPainter::drawTextBatch: The number of positions must match the number of texts");
+        return;
+    }
+    if (colors.size() > 1 && colors.size() != texts.size()) {
+        qWarning("QPainter::drawTextBatch: The number of colors must be 0, 1 or match the number of texts");
+        return;
+    }
+
+    const QFont &font = d->state->font;
+    if (!d->extended || font.underline() || font.overline() || font.strikeOut()) {
+        const QPen pen = d->state->pen;
+        for (qsizetype i = 0; i < texts.size(); ++i) {
+            const QColor color = colors.empty() ? QColor() : colors[colors.size() == 1 ? 0 : i];
+            setPen(color.isValid() ? QPen(color) : pen);
+            drawText(positions[i], texts[i]);
+        }
+        setPen(pen);
+        return;
+    }
+
+    QGlyphBatch batch(d);
+    QVarLengthArray<glyph_t> glyphs;
+    QVarLengthArray<QFixedPoint> glyphPositions;
+    for (qsizetype i = 0; i < texts.size(); ++i) {
+        const QString &text = texts[i];
+        if (text.isEmpty())
+            continue;
+        const int colorIndex = batch.colorIndex(colors.empty()
+                                                ? QColor() : colors[colors.size() == 1 ? 0 : i]);
+
+        Q_DECL_UNINITIALIZED QStackTextEngine engine(text, font);
+        engine.option.setTextDirection(d->state->layoutDirection);
+        engine.itemize();
+        QScriptLine line;
+        line.length = text.size();
+        engine.shapeLine(line);
+
+        const int nItems = engine.layoutData->items.size();
+        QVarLengthArray<int> visualOrder(nItems);
+        QVarLengthArray<uchar> levels(nItems);
+        for (int j = 0; j < nItems; ++j)
+            levels[j] = engine.layoutData->items[j].analysis.bidiLevel;
+        QTextEngine::bidiReorder(nItems, levels.data(), visualOrder.data());
+
+        QFixed x = QFixed::fromReal(positions[i].x());
+        const qreal y = positions[i].y();
+        for (int j = 0; j < nItems; ++j) {
+            const QScriptItem &si = engine.layoutData->items.at(visualOrder[j]);
+            if (si.analysis.flags < QScriptAnalysis::TabOrObject) {
+                QFontEngine *fontEngine = engine.fontEngine(si);
+                const QTextItem::RenderFlags flags = si.analysis.bidiLevel % 2
+                        ? QTextItem::RightToLeft : QTextItem::RenderFlags();
+                glyphs.clear();
+                glyphPositions.clear();
+                fontEngine->getGlyphPositions(engine.shapedGlyphs(&si),
+                                              QTransform::fromTranslate(x.toReal(), y), flags,
+                                              glyphs, glyphPositions);
+                batch.add(fontEngine, colorIndex, glyphs.constData(), glyphPositions.constData(),
+                          glyphs.size());
+            }
+            x += si.width;
+        }
+    }
+    batch.draw(this);
+}
+
+/*!
+    \since 6.10
+
+    Draws each glyph run in \a glyphRuns at the position at the same index
+    in \a positions, in the color at the same index in \a colors. If
+    \a colors holds a single color, it is used for all glyph runs. If
+    \a colors is empty, or for an invalid color, the current pen is used.
+
+    The glyphs are grouped by font and color and handed to the paint engine
+    as one run per group. Glyph runs of different colors may be drawn in
+    any order relative to each other. Glyph runs that are underlined,
+    overlined or struck out are drawn one by one with drawGlyphRun().
+
+    \sa drawGlyphRun(), drawTextBatch()
+*/
+#if !defined(QT_NO_RAWFONT)
+void QPainter::drawGlyphRunBatch(QSpan<const QPointF> positions, QSpan<const QGlyphRun> glyphRuns,
+                                 QSpan<const QColor> colors)
+{
+    Q_D(QPainter);
+
+    if (!d->engine || glyphRuns.empty())
+        return;
+
+    if (positions.size() != glyphRuns.size()) {
+        qWarning("QPainter::drawGlyphRunBatch: The number of positions must match the number of glyph runs");
+        return;
+    }
+    if (colors.size() > 1 && colors.size() != glyphRuns.size()) {
+        qWarning("QPainter::drawGlyphRunBatch: The number of colors must be 0, 1 or match the number of glyph runs");
+        return;
+    }
+
+    const QPen pen = d->state->pen;
+    QGlyphBatch batch(d);
+    QVarLengthArray<QFixedPoint> glyphPositions;
+    for (qsizetype i = 0; i < glyphRuns.size(); ++i) {
+        const QGlyphRun &glyphRun = glyphRuns[i];
+        const QColor color = colors.empty() ? QColor() : colors[colors.size() == 1 ? 0 : i];
+        const QRawFont font = glyphRun.rawFont();
+        if (!font.isValid())
+            continue;
+
+        if (!d->extended || glyphRun.underline() || glyphRun.overline() || glyphRun.strikeOut()) {
+            setPen(color.isValid() ? QPen(color) : pen);
+            drawGlyphRun(positions[i], glyphRun);
+            setPen(pen);
+            continue;
+        }
+
+        const QGlyphRunPrivate *glyphRun_d = QGlyphRunPrivate::get(glyphRun);
+        const int count = qMin(glyphRun_d->glyphIndexDataSize, glyphRun_d->glyphPositionDataSize);
+        glyphPositions.resize(count);
+        for (int j = 0; j < count; ++j)
+            glyphPositions[j] = QFixedPoint::fromPointF(positions[i] + glyphRun_d->glyphPositionData[j]);
+        batch.add(QRawFontPrivate::get(font)->fontEngine, batch.colorIndex(color),
+                  glyphRun_d->glyphIndexData, glyphPositions.constData(), count);
+    }
+    batch.draw(this);
+}
+#endif // QT_NO_RAWFONT
+
 void QPainter::drawText(const QRect &r, int flags, const QString &str, QRect *br)
 {
 #ifdef QT_DEBUG_DRAW
@@ -6871,6 +7158,54 @@ void QPainter::fillRect(const QRectF &r, const QColor &color)
     \since 5.12
 */
 
+/*!
+    \since 6.10
+
+    Fills each rectangle in \a rects with the color at the same index in
+    \a colors, using the current transformation, clip and composition mode.
+    If \a colors holds a single color, it is used for all rectangles.
+
+    The result is the same as calling fillRect() for every rectangle in
+    order, but the whole batch is handed to the paint engine at once. The
+    raster paint engine fills axis-aligned rectangles directly into the
+    destination without building a path per rectangle, which makes this
+    the preferred way to draw large numbers of colored rectangles.
+
+    \sa fillRect(), drawRects()
+*/
+void QPainter::drawRectBatch(QSpan<const QRectF> rects, QSpan<const QColor> colors)
+{
+    Q_D(QPainter);
+
+    if (!d->engine) {
+        qWarning("QPainter::drawRectBatch: Painter not active");
+        return;
+    }
+
+    if (rects.empty())
+        return;
+
+    if (colors.size() != 1 && colors.size() != rects.size()) {
+        qWarning("QPainter::drawRectBatch: The number of colors must be 1 or match the number of rectangles");
+        return;
+    }
+
+    const bool uniformColor = colors.size() == 1;
+    if (d->extended) {
+        constexpr qsizetype maxChunk = std::numeric_limits<int>::max();
+        for (qsizetype i = 0; i < rects.size(); i += maxChunk) {
+            const int count = int(qMin(rects.size() - i, maxChunk));
+            d->extended->fillRectBatch(rects.data() + i, count,
+                                       uniformColor ? colors.data() : colors.data() + i,
+                                       uniformColor ? 1 : count);
+        }
+        return;
+    }
+
+    for (qsizetype i = 0; i < rects.size(); ++i)
+        fillRect(rects[i], QBrush(colors[uniformColor ? 0 : i]));
+}
+
 /*!
     Sets the given render \a hint on the painter if \a on is true;
     otherwise clears the render hint.
@@ -0,0 +1,872 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpaintrecording_p.h"
+
+#include <qmath.h>
+#include <qpainter.h>
+#include <private/qoutlinemapper_p.h>
+#include <private/qpainterpath_p.h>
+#include <private/qvectorpath_p.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QPaintRecording
+    \internal
+    \inmodule QtGui
+
+    \brief The QPaintRecording class holds a stream of painting commands
+    in typed pools.
+
+    Every command refers to a snapshot of the painter state and to a range
+    of one of the geometry pools, so recording a command does not allocate
+    per primitive. Each command also carries its device bounds, which lets
+    replay skip everything outside the area of interest.
+
+    Replay composes the recorded transforms and clips with the state of the
+    target painter at the time replay starts, and leaves that state
+    untouched afterwards.
+*/
+
+void QPaintRecording::clear()
+{
+    commands.clear();
+    states.clear();
+    clips.clear();
+    pointsF.clear();
+    points.clear();
+    rectsF.clear();
+    rects.clear();
+    linesF.clear();
+    lines.clear();
+    elementTypes.clear();
+    brushes.clear();
+    pens.clear();
+    colors.clear();
+    pixmaps.clear();
+    images.clear();
+}
+
+/*
+    Applies \a state on top of the \a base transform of \a painter. Only the
+    parts that differ from \a previous are set; a null \a previous applies
+    everything, including the clip. The clip is intersected with whatever
+    clip the painter had when the replay started, so the caller must reset
+    the painter to that clip before passing a null \a previous.
+*/
+void QPaintRecording::applyState(QPainter *painter, const QTransform &base, const State &state,
+                                 const State *previous) const
+{
+    bool transformDirty = !previous || previous->matrix != state.matrix;
+
+    if (!previous) {
+        const Clip &clip = clips.at(state.clip);
+        if (clip.enabled) {
+            for (const QPainterClipInfo &info : clip.infos) {
+                // The painter only keeps the clips since the last replace,
+                // so a replace can only be the first entry.
+                Qt::ClipOperation op = info.operation;
+                if (op == Qt::NoClip)
+                    continue;
+                if (op == Qt::ReplaceClip)
+                    op = Qt::IntersectClip;
+                painter->setTransform(info.matrix * base);
+                switch (info.clipType) {
+                case QPainterClipInfo::RegionClip:
+                    painter->setClipRegion(info.region, op);
+                    break;
+                case QPainterClipInfo::PathClip:
+                    painter->setClipPath(info.path, op);
+                    break;
+                case QPainterClipInfo::RectClip:
+                    painter->setClipRect(info.rect, op);
+                    break;
+                case QPainterClipInfo::RectFClip:
+                    painter->setClipRect(info.rectf, op);
+                    break;
+                }
+            }
+            transformDirty = true;
+        }
+    }
+
+    if (transformDirty)
+        painter->setTransform(state.matrix * base);
+    if (!previous || !qpen_fast_equals(previous->pen, state.pen))
+        painter->setPen(state.pen);
+    if (!previous || !qbrush_fast_equals(previous->brush, state.brush))
+        painter->setBrush(state.brush);
+    if (!previous || previous->brushOrigin != state.brushOrigin)
+        painter->setBrushOrigin(state.brushOrigin);
+    if (!previous || !qbrush_fast_equals(previous->bgBrush, state.bgBrush))
+        painter->setBackground(state.bgBrush);
+    if (!previous || previous->bgMode != state.bgMode)
+        painter->setBackgroundMode(state.bgMode);
+    if (!previous || previous->opacity != state.opacity)
+        painter->setOpacity(state.opacity);
+    if (!previous || previous->compositionMode != state.compositionMode)
+        painter->setCompositionMode(state.compositionMode);
+    if (painter->renderHints() != state.renderHints) {
+        painter->setRenderHints(painter->renderHints(), false);
+        painter->setRenderHints(state.renderHints, true);
+    }
+}
+
+static void drawPolygonWithMode(QPainter *painter, const QPointF *points, int count,
+                                QPaintEngine::PolygonDrawMode mode)
+{
+    switch (mode) {
+    case QPaintEngine::OddEvenMode:
+        painter->drawPolygon(points, count, Qt::OddEvenFill);
+        break;
+    case QPaintEngine::WindingMode:
+        painter->drawPolygon(points, count, Qt::WindingFill);
+        break;
+    case QPaintEngine::ConvexMode:
+        painter->drawConvexPolygon(points, count);
+        break;
+    case QPaintEngine::PolylineMode:
+        painter->drawPolyline(points, count);
+        break;
+    }
+}
+
+static void drawPolygonWithMode(QPainter *painter, const QPoint *points, int count,
+                                QPaintEngine::PolygonDrawMode mode)
+{
+    switch (mode) {
+    case QPaintEngine::OddEvenMode:
+        painter->drawPolygon(points, count, Qt::OddEvenFill);
+        break;
+    case QPaintEngine::WindingMode:
+        painter->drawPolygon(points, count, Qt::WindingFill);
+        break;
+    case QPaintEngine::ConvexMode:
+        painter->drawConvexPolygon(points, count);
+        break;
+    case QPaintEngine::PolylineMode:
+        painter->drawPolyline(points, count);
+        break;
+    }
+}
+
+/*
+    Executes \a c. If \a engine is not null the command goes straight to the
+    engine, bypassing QPainter; otherwise it is drawn through \a painter.
+*/
+void QPaintRecording::execute(QPainter *painter, QPaintEngineEx *engine, const Command &c) const
+{
+    if (c.type == CommandType::Fill || c.type == CommandType::Stroke) {
+        const QVectorPath path(reinterpret_cast<const qreal *>(pointsF.constData() + c.offset),
+                               c.count,
+                               c.elements >= 0 ? elementTypes.constData() + c.elements : nullptr,
+                               c.mode);
+        if (engine) {
+            if (c.type == CommandType::Fill)
+                engine->fill(path, brushes.at(c.object));
+            else
+                engine->stroke(path, pens.at(c.object));
+        } else {
+            if (c.type == CommandType::Fill)
+                painter->fillPath(path.convertToPainterPath(), brushes.at(c.object));
+            else
+                painter->strokePath(path.convertToPainterPath(), pens.at(c.object));
+        }
+        return;
+    }
+
+    if (!engine) {
+        switch (c.type) {
+        case CommandType::FillRectBrush:
+            painter->fillRect(rectsF.at(c.offset), brushes.at(c.object));
+            break;
+        case CommandType::FillRectColor:
+            painter->fillRect(rectsF.at(c.offset), colors.at(c.object));
+            break;
+        case CommandType::FillRectBatch:
+            painter->drawRectBatch(QSpan<const QRectF>(rectsF.constData() + c.offset, c.count),
+                                   QSpan<const QColor>(colors.constData() + c.object,
+                                                       c.mode ? 1 : c.count));
+            break;
+        case CommandType::DrawRects:
+            painter->drawRects(rects.constData() + c.offset, c.count);
+            break;
+        case CommandType::DrawRectsF:
+            painter->drawRects(rectsF.constData() + c.offset, c.count);
+            break;
+        case CommandType::DrawLines:
+            painter->drawLines(lines.constData() + c.offset, c.count);
+            break;
+        case CommandType::DrawLinesF:
+            painter->drawLines(linesF.constData() + c.offset, c.count);
+            break;
+        case CommandType::DrawPoints:
+            painter->drawPoints(points.constData() + c.offset, c.count);
+            break;
+        case CommandType::DrawPointsF:
+            painter->drawPoints(pointsF.constData() + c.offset, c.count);
+            break;
+        case CommandType::DrawPolygon:
+            drawPolygonWithMode(painter, points.constData() + c.offset, c.count,
+                                QPaintEngine::PolygonDrawMode(c.mode));
+            break;
+        case CommandType::DrawPolygonF:
+            drawPolygonWithMode(painter, pointsF.constData() + c.offset, c.count,
+                                QPaintEngine::PolygonDrawMode(c.mode));
+            break;
+        case CommandType::DrawEllipse:
+            painter->drawEllipse(rectsF.at(c.offset));
+            break;
+        case CommandType::DrawPixmapAt:
+            painter->drawPixmap(pointsF.at(c.offset), pixmaps.at(c.object));
+            break;
+        case CommandType::DrawPixmap:
+            painter->drawPixmap(rectsF.at(c.offset), pixmaps.at(c.object), rectsF.at(c.offset + 1));
+            break;
+        case CommandType::DrawImageAt:
+            painter->drawImage(pointsF.at(c.offset), images.at(c.object));
+            break;
+        case CommandType::DrawImage:
+            painter->drawImage(rectsF.at(c.offset), images.at(c.object), rectsF.at(c.offset + 1),
+                               Qt::ImageConversionFlags(c.mode));
+            break;
+        case CommandType::DrawTiledPixmap:
+            painter->drawTiledPixmap(rectsF.at(c.offset), pixmaps.at(c.object),
+                                     rectsF.at(c.offset + 1).topLeft());
+            break;
+        case CommandType::Fill:
+        case CommandType::Stroke:
+            break;
+        }
+        return;
+    }
+
+    switch (c.type) {
+    case CommandType::FillRectBrush:
+        engine->fillRect(rectsF.at(c.offset), brushes.at(c.object));
+        break;
+    case CommandType::FillRectColor:
+        engine->fillRect(rectsF.at(c.offset), colors.at(c.object));
+        break;
+    case CommandType::FillRectBatch:
+        engine->fillRectBatch(rectsF.constData() + c.offset, c.count,
+                              colors.constData() + c.object, c.mode ? 1 : c.count);
+        break;
+    case CommandType::DrawRects:
+        engine->drawRects(rects.constData() + c.offset, c.count);
+        break;
+    case CommandType::DrawRectsF:
+        engine->drawRects(rectsF.constData() + c.offset, c.count);
+        break;
+    case CommandType::DrawLines:
+        engine->drawLines(lines.constData() + c.offset, c.count);
+        break;
+    case CommandType::DrawLinesF:
+        engine->drawLines(linesF.constData() + c.offset, c.count);
+        break;
+    case CommandType::DrawPoints:
+        engine->drawPoints(points.constData() + c.offset, c.count);
+        break;
+    case CommandType::DrawPointsF:
+        engine->drawPoints(pointsF.constData() + c.offset, c.count);
+        break;
+    case CommandType::DrawPolygon:
+        engine->drawPolygon(points.constData() + c.offset, c.count,
+                            QPaintEngine::PolygonDrawMode(c.mode));
+        break;
+    case CommandType::DrawPolygonF:
+        engine->drawPolygon(pointsF.constData() + c.offset, c.count,
+                            QPaintEngine::PolygonDrawMode(c.mode));
+        break;
+    case CommandType::DrawEllipse:
+        engine->drawEllipse(rectsF.at(c.offset));
+        break;
+    case CommandType::DrawPixmapAt:
+        engine->drawPixmap(pointsF.at(c.offset), pixmaps.at(c.object));
+        break;
+    case CommandType::DrawPixmap:
+        engine->drawPixmap(rectsF.at(c.offset), pixmaps.at(c.object), rectsF.at(c.offset + 1));
+        break;
+    case CommandType::DrawImageAt:
+        engine->drawImage(pointsF.at(c.offset), images.at(c.object));
+        break;
+    case CommandType::DrawImage:
+        engine->drawImage(rectsF.at(c.offset), images.at(c.object), rectsF.at(c.offset + 1),
+                          Qt::ImageConversionFlags(c.mode));
+        break;
+    case CommandType::DrawTiledPixmap:
+        engine->drawTiledPixmap(rectsF.at(c.offset), pixmaps.at(c.object),
+                                rectsF.at(c.offset + 1).topLeft());
+        break;
+    case CommandType::Fill:
+    case CommandType::Stroke:
+        break;
+    }
+}
+
+/*
+    Runs the commands produced by \a forEachCommand on \a painter. Runs of
+    commands sharing a state are sent to the paint engine back to back, and
+    only the state changes between runs go through QPainter.
+*/
+template <typename ForEach>
+void QPaintRecording::replayCommands(QPainter *painter, ForEach forEachCommand) const
+{
+    QPaintEngine *paintEngine = painter->paintEngine();
+    QPaintEngineEx *engine = paintEngine && paintEngine->isExtended()
+            ? static_cast<QPaintEngineEx *>(paintEngine) : nullptr;
+    const QTransform base = painter->transform();
+
+    painter->save();
+    const State *current = nullptr;
+    forEachCommand([&](const Command &command) {
+        const State &state = states.at(command.state);
+        if (&state != current) {
+            if (current && current->clip != state.clip) {
+                // Go back to the clip the replay started with.
+                painter->restore();
+                painter->save();
+                current = nullptr;
+            }
+            applyState(painter, base, state, current);
+            current = &state;
+        }
+        execute(painter, engine, command);
+    });
+    painter->restore();
+}
+
+/*
+    Replays the recording on \a painter. If \a deviceRect is not null, the
+    commands whose bounds do not touch it are skipped.
+*/
+void QPaintRecording::replay(QPainter *painter, const QRect &deviceRect) const
+{
+    replayCommands(painter, [&](auto &&run) {
+        for (const Command &command : commands) {
+            if (!deviceRect.isNull() && !command.bounds.isNull()
+                && !command.bounds.intersects(deviceRect)) {
+                continue;
+            }
+            run(command);
+        }
+    });
+}
+
+/*
+    Replays the commands listed in \a commandIndices, which must be sorted
+    in ascending order, on \a painter.
+*/
+void QPaintRecording::replay(QPainter *painter, const QList<int> &commandIndices) const
+{
+    replayCommands(painter, [&](auto &&run) {
+        for (int index : commandIndices)
+            run(commands.at(index));
+    });
+}
+
+template <typename T>
+static inline void appendRange(QList<T> &list, const T *items, qsizetype count)
+{
+    const qsizetype offset = list.size();
+    list.resize(offset + count);
+    std::copy(items, items + count, list.begin() + offset);
+}
+
+int QRecordingPaintEnginePrivate::snapshotState()
+{
+    Q_Q(QRecordingPaintEngine);
+    const QPainterState *s = q->state();
+
+    if (clipDirty || recording.clips.isEmpty()) {
+        recording.clips.append({ s->clipInfo, bool(s->clipEnabled), ++clipSerial });
+        clipDirty = false;
+        stateDirty = true;
+    }
+
+    if (stateDirty || recording.states.isEmpty()) {
+        recording.states.append({ s->pen, s->brush, s->brushOrigin, s->bgBrush, s->bgMode,
+                                  s->opacity, s->composition_mode, s->renderHints, s->matrix,
+                                  int(recording.clips.size() - 1) });
+        stateDirty = false;
+    }
+
+    return int(recording.states.size() - 1);
+}
+
+qreal QRecordingPaintEnginePrivate::penMargin(const QPen &pen) const
+{
+    Q_Q(const QRecordingPaintEngine);
+    if (pen.style() == Qt::NoPen)
+        return 0;
+
+    const qreal width = pen.widthF();
+    if (pen.isCosmetic())
+        return qMax(width, qreal(1));
+
+    const QTransform &m = q->state()->matrix;
+    const qreal scale = qSqrt(qMax(m.m11() * m.m11() + m.m12() * m.m12(),
+                                   m.m21() * m.m21() + m.m22() * m.m22()));
+    qreal factor = M_SQRT2;
+    if (pen.joinStyle() == Qt::MiterJoin || pen.joinStyle() == Qt::SvgMiterJoin)
+        factor = qMax(factor, pen.miterLimit());
+    return qMax(width * scale * factor / 2, qreal(1));
+}
+
+/*
+    Appends a command for the current state. \a bounds is in logical
+    coordinates; a null rect marks the command as unbounded. If \a pen is not
+    null the bounds are grown by the area the pen can touch.
+*/
+QPaintRecording::Command &QRecordingPaintEnginePrivate::addCommand(QPaintRecording::CommandType type,
+                                                                   const QRectF &bounds,
+                                                                   const QPen *pen)
+{
+    Q_Q(QRecordingPaintEngine);
+    if (maximumCommandCount > 0 && recording.commands.size() >= maximumCommandCount)
+        q->recordingFull();
+
+    QRect deviceBounds;
+    const QTransform &m = q->state()->matrix;
+    if (!bounds.isNull() && m.type() < QTransform::TxProject) {
+        const QRectF mapped = m.mapRect(bounds);
+        const qreal margin = (pen ? penMargin(*pen) : 0) + 2;
+        const QRectF limit(-QT_RASTER_COORD_LIMIT, -QT_RASTER_COORD_LIMIT,
+                           2 * QT_RASTER_COORD_LIMIT, 2 * QT_RASTER_COORD_LIMIT);
+        const QRectF grown = mapped.adjusted(-margin, -margin, margin, margin);
+        if (qIsFinite(grown.left()) && qIsFinite(grown.top())
+            && qIsFinite(grown.right()) && qIsFinite(grown.bottom())
+            && limit.contains(grown)) {
+            deviceBounds = grown.toAlignedRect();
+        }
+    }
+
+    recording.commands.append({ type, 0, snapshotState(), 0, -1, 0, -1, deviceBounds });
+    return recording.commands.last();
+}
+
+void QRecordingPaintEnginePrivate::addVectorPath(QPaintRecording::CommandType type,
+                                                 const QVectorPath &path, const QPen *pen)
+{
+    QPaintRecording::Command &command = addCommand(type, path.controlPointRect(), pen);
+    command.mode = path.hints();
+    command.count = path.elementCount();
+    command.offset = recording.pointsF.size();
+    const QPointF *pts = reinterpret_cast<const QPointF *>(path.points());
+    appendRange(recording.pointsF, pts, path.elementCount());
+    if (const QPainterPath::ElementType *types = path.elements()) {
+        command.elements = recording.elementTypes.size();
+        appendRange(recording.elementTypes, types, path.elementCount());
+    }
+}
+
+/*!
+    \class QRecordingPaintEngine
+    \internal
+    \inmodule QtGui
+
+    \brief The QRecordingPaintEngine class is the base of paint engines that
+    record into a QPaintRecording instead of drawing.
+
+    Subclasses implement begin() and end() and decide what to do with the
+    recording. Text is not recorded as such; it reaches the engine through
+    the path fallbacks of QPaintEngineEx unless a subclass overrides the
+    text functions.
+*/
+
+QRecordingPaintEngine::QRecordingPaintEngine(QRecordingPaintEnginePrivate &dd)
+    : QPaintEngineEx(dd)
+{
+}
+
+QRecordingPaintEngine::~QRecordingPaintEngine()
+{
+}
+
+const QPaintRecording &QRecordingPaintEngine::recording() const
+{
+    Q_D(const QRecordingPaintEngine);
+    return d->recording;
+}
+
+/*!
+    Clears the recording. Subsequent commands snapshot the painter state
+    again.
+*/
+void QRecordingPaintEngine::resetRecording()
+{
+    Q_D(QRecordingPaintEngine);
+    d->recording.clear();
+    d->stateDirty = true;
+    d->clipDirty = true;
+}
+
+/*!
+    Called before a command is recorded when the recording holds the
+    maximum number of commands. The default implementation does nothing,
+    letting the recording grow.
+*/
+void QRecordingPaintEngine::recordingFull()
+{
+}
+
+void QRecordingPaintEngine::penChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::brushChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::brushOriginChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::opacityChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::compositionModeChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::renderHintsChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::transformChanged()
+{
+    d_func()->stateDirty = true;
+}
+
+void QRecordingPaintEngine::clipEnabledChanged()
+{
+    d_func()->clipDirty = true;
+}
+
+void QRecordingPaintEngine::setState(QPainterState *s)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintEngineEx::setState(s);
+    d->stateDirty = true;
+    d->clipDirty = true;
+}
+
+void QRecordingPaintEngine::fill(const QVectorPath &path, const QBrush &brush)
+{
+    Q_D(QRecordingPaintEngine);
+    if (path.isEmpty() || brush.style() == Qt::NoBrush)
+        return;
+    d->addVectorPath(QPaintRecording::CommandType::Fill, path, nullptr);
+    d->recording.commands.last().object = d->recording.brushes.size();
+    d->recording.brushes.append(brush);
+}
+
+void QRecordingPaintEngine::stroke(const QVectorPath &path, const QPen &pen)
+{
+    Q_D(QRecordingPaintEngine);
+    if (path.isEmpty() || pen.style() == Qt::NoPen)
+        return;
+    d->addVectorPath(QPaintRecording::CommandType::Stroke, path, &pen);
+    d->recording.commands.last().object = d->recording.pens.size();
+    d->recording.pens.append(pen);
+}
+
+void QRecordingPaintEngine::clip(const QVectorPath &, Qt::ClipOperation)
+{
+    d_func()->clipDirty = true;
+}
+
+void QRecordingPaintEngine::clip(const QRect &, Qt::ClipOperation)
+{
+    d_func()->clipDirty = true;
+}
+
+void QRecordingPaintEngine::clip(const QRegion &, Qt::ClipOperation)
+{
+    d_func()->clipDirty = true;
+}
+
+void QRecordingPaintEngine::fillRect(const QRectF &rect, const QBrush &brush)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::FillRectBrush, rect.normalized(), nullptr);
+    command.offset = d->recording.rectsF.size();
+    command.object = d->recording.brushes.size();
+    d->recording.rectsF.append(rect);
+    d->recording.brushes.append(brush);
+}
+
+void QRecordingPaintEngine::fillRect(const QRectF &rect, const QColor &color)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::FillRectColor, rect.normalized(), nullptr);
+    command.offset = d->recording.rectsF.size();
+    command.object = d->recording.colors.size();
+    d->recording.rectsF.append(rect);
+    d->recording.colors.append(color);
+}
+
+template <typename T>
+static QRectF boundingRectOf(const T *items, int count)
+{
+    QRectF bounds;
+    for (int i = 0; i < count; ++i)
+        bounds |= QRectF(items[i]).normalized();
+    return bounds;
+}
+
+void QRecordingPaintEngine::fillRectBatch(const QRectF *rects, int rectCount,
+                                          const QColor *colors, int colorCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (rectCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::FillRectBatch,
+                          boundingRectOf(rects, rectCount), nullptr);
+    command.mode = colorCount == 1;
+    command.offset = d->recording.rectsF.size();
+    command.count = rectCount;
+    command.object = d->recording.colors.size();
+    appendRange(d->recording.rectsF, rects, rectCount);
+    appendRange(d->recording.colors, colors, colorCount);
+}
+
+template <typename Point>
+static QRectF boundingRectOfPoints(const Point *points, int count)
+{
+    if (count <= 0)
+        return QRectF();
+    qreal minX = points[0].x();
+    qreal maxX = minX;
+    qreal minY = points[0].y();
+    qreal maxY = minY;
+    for (int i = 1; i < count; ++i) {
+        minX = qMin<qreal>(minX, points[i].x());
+        maxX = qMax<qreal>(maxX, points[i].x());
+        minY = qMin<qreal>(minY, points[i].y());
+        maxY = qMax<qreal>(maxY, points[i].y());
+    }
+    // Degenerate point sets still need a non-null rect to stay bounded.
+    return QRectF(minX, minY, qMax<qreal>(maxX - minX, 1), qMax<qreal>(maxY - minY, 1));
+}
+
+template <typename Line>
+static QRectF boundingRectOfLines(const Line *lines, int count)
+{
+    if (count <= 0)
+        return QRectF();
+    qreal minX = qMin<qreal>(lines[0].x1(), lines[0].x2());
+    qreal maxX = qMax<qreal>(lines[0].x1(), lines[0].x2());
+    qreal minY = qMin<qreal>(lines[0].y1(), lines[0].y2());
+    qreal maxY = qMax<qreal>(lines[0].y1(), lines[0].y2());
+    for (int i = 1; i < count; ++i) {
+        minX = qMin<qreal>(minX, qMin(lines[i].x1(), lines[i].x2()));
+        maxX = qMax<qreal>(maxX, qMax(lines[i].x1(), lines[i].x2()));
+        minY = qMin<qreal>(minY, qMin(lines[i].y1(), lines[i].y2()));
+        maxY = qMax<qreal>(maxY, qMax(lines[i].y1(), lines[i].y2()));
+    }
+    return QRectF(minX, minY, qMax<qreal>(maxX - minX, 1), qMax<qreal>(maxY - minY, 1));
+}
+
+void QRecordingPaintEngine::drawRects(const QRect *rects, int rectCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (rectCount <= 0)
+        return;
+    QRectF bounds = boundingRectOf(rects, rectCount);
+    if (bounds.isNull())
+        bounds.setSize(QSizeF(1, 1));
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawRects, bounds, &state()->pen);
+    command.offset = d->recording.rects.size();
+    command.count = rectCount;
+    appendRange(d->recording.rects, rects, rectCount);
+}
+
+void QRecordingPaintEngine::drawRects(const QRectF *rects, int rectCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (rectCount <= 0)
+        return;
+    QRectF bounds = boundingRectOf(rects, rectCount);
+    if (bounds.isNull())
+        bounds.setSize(QSizeF(1, 1));
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawRectsF, bounds, &state()->pen);
+    command.offset = d->recording.rectsF.size();
+    command.count = rectCount;
+    appendRange(d->recording.rectsF, rects, rectCount);
+}
+
+void QRecordingPaintEngine::drawLines(const QLine *lines, int lineCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (lineCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawLines,
+                          boundingRectOfLines(lines, lineCount), &state()->pen);
+    command.offset = d->recording.lines.size();
+    command.count = lineCount;
+    appendRange(d->recording.lines, lines, lineCount);
+}
+
+void QRecordingPaintEngine::drawLines(const QLineF *lines, int lineCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (lineCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawLinesF,
+                          boundingRectOfLines(lines, lineCount), &state()->pen);
+    command.offset = d->recording.linesF.size();
+    command.count = lineCount;
+    appendRange(d->recording.linesF, lines, lineCount);
+}
+
+void QRecordingPaintEngine::drawPoints(const QPointF *points, int pointCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (pointCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawPointsF,
+                          boundingRectOfPoints(points, pointCount), &state()->pen);
+    command.offset = d->recording.pointsF.size();
+    command.count = pointCount;
+    appendRange(d->recording.pointsF, points, pointCount);
+}
+
+void QRecordingPaintEngine::drawPoints(const QPoint *points, int pointCount)
+{
+    Q_D(QRecordingPaintEngine);
+    if (pointCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawPoints,
+                          boundingRectOfPoints(points, pointCount), &state()->pen);
+    command.offset = d->recording.points.size();
+    command.count = pointCount;
+    appendRange(d->recording.points, points, pointCount);
+}
+
+void QRecordingPaintEngine::drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode)
+{
+    Q_D(QRecordingPaintEngine);
+    if (pointCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawPolygonF,
+                          boundingRectOfPoints(points, pointCount), &state()->pen);
+    command.mode = mode;
+    command.offset = d->recording.pointsF.size();
+    command.count = pointCount;
+    appendRange(d->recording.pointsF, points, pointCount);
+}
+
+void QRecordingPaintEngine::drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode)
+{
+    Q_D(QRecordingPaintEngine);
+    if (pointCount <= 0)
+        return;
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawPolygon,
+                          boundingRectOfPoints(points, pointCount), &state()->pen);
+    command.mode = mode;
+    command.offset = d->recording.points.size();
+    command.count = pointCount;
+    appendRange(d->recording.points, points, pointCount);
+}
+
+void QRecordingPaintEngine::drawEllipse(const QRectF &rect)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawEllipse, rect.normalized(),
+                          &state()->pen);
+    command.offset = d->recording.rectsF.size();
+    d->recording.rectsF.append(rect);
+}
+
+static QSizeF sourceExtent(const QSizeF &size, qreal devicePixelRatio)
+{
+    return devicePixelRatio < 1 ? size / devicePixelRatio : size;
+}
+
+void QRecordingPaintEngine::drawPixmap(const QPointF &pos, const QPixmap &pm)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawPixmapAt,
+                          QRectF(pos, sourceExtent(pm.size(), pm.devicePixelRatio())), nullptr);
+    command.offset = d->recording.pointsF.size();
+    command.object = d->recording.pixmaps.size();
+    d->recording.pointsF.append(pos);
+    d->recording.pixmaps.append(pm);
+}
+
+void QRecordingPaintEngine::drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawPixmap, r.normalized(), nullptr);
+    command.offset = d->recording.rectsF.size();
+    command.object = d->recording.pixmaps.size();
+    d->recording.rectsF.append(r);
+    d->recording.rectsF.append(sr);
+    d->recording.pixmaps.append(pm);
+}
+
+void QRecordingPaintEngine::drawImage(const QPointF &pos, const QImage &image)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawImageAt,
+                          QRectF(pos, sourceExtent(image.size(), image.devicePixelRatio())),
+                          nullptr);
+    command.offset = d->recording.pointsF.size();
+    command.object = d->recording.images.size();
+    d->recording.pointsF.append(pos);
+    d->recording.images.append(image);
+}
+
+void QRecordingPaintEngine::drawImage(const QRectF &r, const QImage &pm, const QRectF &sr,
+                                      Qt::ImageConversionFlags flags)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawImage, r.normalized(), nullptr);
+    command.mode = uint(flags.toInt());
+    command.offset = d->recording.rectsF.size();
+    command.object = d->recording.images.size();
+    d->recording.rectsF.append(r);
+    d->recording.rectsF.append(sr);
+    d->recording.images.append(pm);
+}
+
+void QRecordingPaintEngine::drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s)
+{
+    Q_D(QRecordingPaintEngine);
+    QPaintRecording::Command &command =
+            d->addCommand(QPaintRecording::CommandType::DrawTiledPixmap, r.normalized(), nullptr);
+    command.offset = d->recording.rectsF.size();
+    command.object = d->recording.pixmaps.size();
+    d->recording.rectsF.append(r);
+    d->recording.rectsF.append(QRectF(s, QSizeF()));
+    d->recording.pixmaps.append(pixmap);
+}
+
+QT_END_NAMESPACE
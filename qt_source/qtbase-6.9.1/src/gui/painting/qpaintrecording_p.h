@@ -0,0 +1,207 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPAINTRECORDING_P_H
+#define QPAINTRECORDING_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtGui/qbrush.h>
+#include <QtGui/qcolor.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainterpath.h>
+#include <QtGui/qpen.h>
+#include <QtGui/qpixmap.h>
+#include <QtGui/qtransform.h>
+#include <QtCore/qline.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrect.h>
+#include "private/qpaintengineex_p.h"
+#include "private/qpainter_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QRecordingPaintEngine;
+class QRecordingPaintEnginePrivate;
+
+class Q_GUI_EXPORT QPaintRecording
+{
+public:
+    enum class CommandType : quint8 {
+        Fill,
+        Stroke,
+        FillRectBrush,
+        FillRectColor,
+        FillRectBatch,
+        DrawRects,
+        DrawRectsF,
+        DrawLines,
+        DrawLinesF,
+        DrawPoints,
+        DrawPointsF,
+        DrawPolygon,
+        DrawPolygonF,
+        DrawEllipse,
+        DrawPixmapAt,
+        DrawPixmap,
+        DrawImageAt,
+        DrawImage,
+        DrawTiledPixmap
+    };
+
+    struct Command
+    {
+        CommandType type;
+        uint mode;              // polygon draw mode, image conversion flags or path hints
+        int state;
+        int count;
+        int object;             // index into the brush, pen, color, pixmap or image pool
+        qsizetype offset;       // index into the geometry pool of the command
+        qsizetype elements;     // index into the element pool, -1 if there are none
+        QRect bounds;           // device bounds, null if unbounded
+    };
+
+    struct Clip
+    {
+        QList<QPainterClipInfo> infos;
+        bool enabled;
+        quint64 serial;
+    };
+
+    struct State
+    {
+        QPen pen;
+        QBrush brush;
+        QPointF brushOrigin;
+        QBrush bgBrush;
+        Qt::BGMode bgMode;
+        qreal opacity;
+        QPainter::CompositionMode compositionMode;
+        QPainter::RenderHints renderHints;
+        QTransform matrix;
+        int clip;
+    };
+
+    bool isEmpty() const { return commands.isEmpty(); }
+    qsizetype size() const { return commands.size(); }
+    void clear();
+
+    void replay(QPainter *painter, const QRect &deviceRect = QRect()) const;
+    void replay(QPainter *painter, const QList<int> &commandIndices) const;
+
+    void applyState(QPainter *painter, const QTransform &base, const State &state,
+                    const State *previous) const;
+    void execute(QPainter *painter, QPaintEngineEx *engine, const Command &command) const;
+
+    QList<Command> commands;
+    QList<State> states;
+    QList<Clip> clips;
+
+    QList<QPointF> pointsF;
+    QList<QPoint> points;
+    QList<QRectF> rectsF;
+    QList<QRect> rects;
+    QList<QLineF> linesF;
+    QList<QLine> lines;
+    QList<QPainterPath::ElementType> elementTypes;
+    QList<QBrush> brushes;
+    QList<QPen> pens;
+    QList<QColor> colors;
+    QList<QPixmap> pixmaps;
+    QList<QImage> images;
+
+private:
+    template <typename ForEach>
+    void replayCommands(QPainter *painter, ForEach forEachCommand) const;
+};
+
+Q_DECLARE_TYPEINFO(QPaintRecording::Command, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QPaintRecording::Clip, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(QPaintRecording::State, Q_RELOCATABLE_TYPE);
+
+class Q_GUI_EXPORT QRecordingPaintEngine : public QPaintEngineEx
+{
+    Q_DECLARE_PRIVATE(QRecordingPaintEngine)
+public:
+    ~QRecordingPaintEngine() override;
+
+    const QPaintRecording &recording() const;
+
+    void penChanged() override;
+    void brushChanged() override;
+    void brushOriginChanged() override;
+    void opacityChanged() override;
+    void compositionModeChanged() override;
+    void renderHintsChanged() override;
+    void transformChanged() override;
+    void clipEnabledChanged() override;
+    void setState(QPainterState *s) override;
+
+    void fill(const QVectorPath &path, const QBrush &brush) override;
+    void stroke(const QVectorPath &path, const QPen &pen) override;
+
+    void clip(const QVectorPath &path, Qt::ClipOperation op) override;
+    void clip(const QRect &rect, Qt::ClipOperation op) override;
+    void clip(const QRegion &region, Qt::ClipOperation op) override;
+
+    void fillRect(const QRectF &rect, const QBrush &brush) override;
+    void fillRect(const QRectF &rect, const QColor &color) override;
+    void fillRectBatch(const QRectF *rects, int rectCount, const QColor *colors, int colorCount) override;
+
+    void drawRects(const QRect *rects, int rectCount) override;
+    void drawRects(const QRectF *rects, int rectCount) override;
+    void drawLines(const QLine *lines, int lineCount) override;
+    void drawLines(const QLineF *lines, int lineCount) override;
+    void drawPoints(const QPointF *points, int pointCount) override;
+    void drawPoints(const QPoint *points, int pointCount) override;
+    void drawPolygon(const QPointF *points, int pointCount, PolygonDrawMode mode) override;
+    void drawPolygon(const QPoint *points, int pointCount, PolygonDrawMode mode) override;
+    void drawEllipse(const QRectF &rect) override;
+
+    void drawPixmap(const QPointF &pos, const QPixmap &pm) override;
+    void drawPixmap(const QRectF &r, const QPixmap &pm, const QRectF &sr) override;
+    void drawImage(const QPointF &pos, const QImage &image) override;
+    void drawImage(const QRectF &r, const QImage &pm, const QRectF &sr,
+                   Qt::ImageConversionFlags flags = Qt::AutoColor) override;
+    void drawTiledPixmap(const QRectF &r, const QPixmap &pixmap, const QPointF &s) override;
+
+    Type type() const override { return User; }
+
+protected:
+    QRecordingPaintEngine(QRecordingPaintEnginePrivate &dd);
+
+    void resetRecording();
+    virtual void recordingFull();
+};
+
+class QRecordingPaintEnginePrivate : public QPaintEngineExPrivate
+{
+    Q_DECLARE_PUBLIC(QRecordingPaintEngine)
+public:
+    int snapshotState();
+    QPaintRecording::Command &addCommand(QPaintRecording::CommandType type, const QRectF &bounds,
+                                         const QPen *pen);
+    void addVectorPath(QPaintRecording::CommandType type, const QVectorPath &path,
+                       const QPen *pen);
+    qreal penMargin(const QPen &pen) const;
+
+    QPaintRecording recording;
+    qsizetype maximumCommandCount = 0;
+    quint64 clipSerial = 0;
+    bool stateDirty = true;
+    bool clipDirty = true;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPAINTRECORDING_P_H
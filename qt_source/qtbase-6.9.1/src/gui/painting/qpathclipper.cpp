@@ -7,6 +7,8 @@
 #include <private/qdatabuffer_p.h>
 #include <private/qnumeric_p.h>
 #include <qmath.h>
+#include <qspan.h>
+#include <qvarlengtharray.h>
 #include <algorithm>
 
 /**
@@ -1574,6 +1576,9 @@ QPainterPath QPathClipper::clip(Operation operation)
         }
     }
 
+    if (isRectilinear(subjectPath) && isRectilinear(clipPath))
+        return clipRectilinear();
+
     QWingedEdge list(subjectPath, clipPath);
 
     doClip(list, ClipMode);
@@ -1718,6 +1723,371 @@ static bool bool_op(bool a, bool b, QPathClipper::Operation op)
     }
 }
 
+/*
+    Boolean operations on paths made only of horizontal and vertical lines
+    do not need the winged edge structure: every crossing lies on a vertex
+    x and a vertex y, so the result can be computed exactly by sweeping the
+    vertical edges of both paths from top to bottom. Between two
+    consecutive vertex y coordinates the inside of the result is a list of
+    x intervals. The outline of the result is traced from the sides of the
+    intervals, which run on as long as the next interval list has a side of
+    the same kind at the same x, and from the differences between
+    neighbouring interval lists.
+
+    Every subpath is closed, so the windings that the edges starting or
+    ending at a vertex y add up to zero. Left of the leftmost and right of
+    the rightmost of those edges the windings, and with them the intervals,
+    stay the same, so only the part of the band in between is swept again.
+*/
+
+bool QPathClipper::isRectilinear(const QPainterPath &path)
+{
+    QPointF start;
+    QPointF prev;
+    for (int i = 0; i < path.elementCount(); ++i) {
+        const QPainterPath::Element &e = path.elementAt(i);
+        if (!qIsFinite(e.x) || !qIsFinite(e.y))
+            return false;
+        if (e.isMoveTo()) {
+            // the previous subpath is closed implicitly
+            if (prev.x() != start.x() && prev.y() != start.y())
+                return false;
+            start = prev = e;
+        } else if (e.isLineTo()) {
+            if (e.x != prev.x() && e.y != prev.y())
+                return false;
+            prev = e;
+        } else {
+            return false;
+        }
+    }
+    return prev.x() == start.x() || prev.y() == start.y();
+}
+
+namespace {
+struct QRectilinearEdge
+{
+    qreal x;
+    qreal y1;
+    qreal y2;
+    int winding;
+    bool clip;
+};
+
+struct QRectilinearSegment
+{
+    QPointF from;
+    QPointF to;
+};
+
+// An edge crossing the current band, with the windings up to and
+// including it.
+struct QRectilinearActiveEdge
+{
+    qsizetype edge;
+    int windingA;
+    int windingB;
+};
+} // unnamed namespace
+
+Q_DECLARE_TYPEINFO(QRectilinearEdge, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QRectilinearSegment, Q_PRIMITIVE_TYPE);
+Q_DECLARE_TYPEINFO(QRectilinearActiveEdge, Q_PRIMITIVE_TYPE);
+
+static void addVerticalEdges(const QPainterPath &path, bool clip, QList<QRectilinearEdge> *edges)
+{
+    const auto add = [&](const QPointF &a, const QPointF &b) {
+        if (a.x() == b.x() && a.y() != b.y())
+            edges->append({ a.x(), qMin(a.y(), b.y()), qMax(a.y(), b.y()), b.y() > a.y() ? 1 : -1, clip });
+    };
+
+    QPointF start;
+    QPointF prev;
+    for (int i = 0; i < path.elementCount(); ++i) {
+        const QPointF p = path.elementAt(i);
+        if (path.elementAt(i).isMoveTo()) {
+            add(prev, start);
+            start = p;
+        } else {
+            add(prev, p);
+        }
+        prev = p;
+    }
+    add(prev, start);
+}
+
+// Appends the edges along y between the band \a above and the band
+// \a below, oriented so that the inside is on their right. Both bands
+// start \a inside or outside.
+static void addHorizontalSegments(QSpan<const qreal> above, QSpan<const qreal> below, qreal y,
+                                  bool inside, QList<QRectilinearSegment> *segments)
+{
+    qsizetype i = 0;
+    qsizetype j = 0;
+    bool insideAbove = inside;
+    bool insideBelow = inside;
+    qreal runStart = 0;
+    int runDirection = 0;
+    while (i < above.size() || j < below.size()) {
+        qreal x;
+        if (j >= below.size() || (i < above.size() && above[i] <= below[j]))
+            x = above[i];
+        else
+            x = below[j];
+        while (i < above.size() && above[i] == x) {
+            insideAbove = !insideAbove;
+            ++i;
+        }
+        while (j < below.size() && below[j] == x) {
+            insideBelow = !insideBelow;
+            ++j;
+        }
+
+        const int direction = insideBelow == insideAbove ? 0 : (insideBelow ? 1 : -1);
+        if (direction == runDirection)
+            continue;
+        if (runDirection > 0)
+            segments->append({ QPointF(runStart, y), QPointF(x, y) });
+        else if (runDirection < 0)
+            segments->append({ QPointF(x, y), QPointF(runStart, y) });
+        runStart = x;
+        runDirection = direction;
+    }
+}
+
+// Replaces the sides band[lo, hi) with \a intervals at \a y. Sides that
+// continue at the same x keep their top, the others are closed and appended
+// as edges going up on the left and down on the right of the inside. The
+// sides before \a lo stay, so even indexes remain left sides.
+static void addVerticalSegments(QList<qreal> &band, QList<qreal> &tops, qsizetype lo, qsizetype hi,
+                                QSpan<const qreal> intervals, qreal y,
+                                QList<QRectilinearSegment> *segments)
+{
+    const auto closeSide = [&](qsizetype i) {
+        if (i % 2)
+            segments->append({ QPointF(band.at(i), tops.at(i)), QPointF(band.at(i), y) });
+        else
+            segments->append({ QPointF(band.at(i), y), QPointF(band.at(i), tops.at(i)) });
+    };
+
+    QVarLengthArray<qreal, 64> newTops;
+    qsizetype i = lo;
+    for (qsizetype j = 0; j < intervals.size(); ++j) {
+        const qreal x = intervals[j];
+        const qsizetype side = (lo + j) % 2;
+        for (; i < hi && band.at(i) <= x; ++i) {
+            if (band.at(i) == x && i % 2 == side)
+                break;
+            closeSide(i);
+        }
+        if (i < hi && band.at(i) == x && i % 2 == side)
+            newTops.append(tops.at(i++));
+        else
+            newTops.append(y);
+    }
+    for (; i < hi; ++i)
+        closeSide(i);
+
+    const auto replace = [lo, hi](QList<qreal> &list, QSpan<const qreal> values) {
+        const qsizetype count = values.size();
+        if (count > hi - lo)
+            list.insert(hi, count - (hi - lo), 0);
+        else
+            list.remove(lo + count, hi - lo - count);
+        std::copy(values.begin(), values.end(), list.begin() + lo);
+    };
+    replace(band, intervals);
+    replace(tops, newTops);
+}
+
+static bool lessThanPoint(const QPointF &a, const QPointF &b)
+{
+    return a.y() < b.y() || (a.y() == b.y() && a.x() < b.x());
+}
+
+static bool isCollinear(const QPointF &a, const QPointF &b, const QPointF &c)
+{
+    return (a.x() == b.x() && b.x() == c.x()) || (a.y() == b.y() && b.y() == c.y());
+}
+
+static void addPolygonPoint(QList<QPointF> &polygon, const QPointF &p)
+{
+    // drop the middle of collinear edges
+    if (polygon.size() >= 2 && isCollinear(polygon.at(polygon.size() - 2), polygon.last(), p))
+        polygon.last() = p;
+    else
+        polygon.append(p);
+}
+
+static QPainterPath tracePath(QList<QRectilinearSegment> &segments)
+{
+    QPainterPath path;
+    std::sort(segments.begin(), segments.end(),
+              [](const QRectilinearSegment &a, const QRectilinearSegment &b) {
+                  return lessThanPoint(a.from, b.from);
+              });
+    QList<bool> used(segments.size(), false);
+    // Vertices where regions touch at a corner have two outgoing
+    // segments, the search resumes behind the ones already taken.
+    QList<qsizetype> next(segments.size());
+    for (qsizetype i = 0; i < segments.size(); ++i)
+        next[i] = i;
+
+    const auto findOutgoing = [&](const QPointF &p) -> qsizetype {
+        auto it = std::lower_bound(segments.cbegin(), segments.cend(), p,
+                                   [](const QRectilinearSegment &s, const QPointF &p) {
+                                       return lessThanPoint(s.from, p);
+                                   });
+        qsizetype i = it - segments.cbegin();
+        const qsizetype first = i;
+        i = next[first];
+        while (i < segments.size() && segments.at(i).from == p && used.at(i))
+            ++i;
+        next[first] = i;
+        return i < segments.size() && segments.at(i).from == p ? i : -1;
+    };
+
+    QList<QPointF> polygon;
+    for (qsizetype first = 0; first < segments.size(); ++first) {
+        if (used.at(first))
+            continue;
+        polygon.clear();
+        polygon.append(segments.at(first).from);
+        qsizetype i = first;
+        while (i >= 0) {
+            used[i] = true;
+            const QPointF &p = segments.at(i).to;
+            if (p == segments.at(first).from)
+                break;
+            addPolygonPoint(polygon, p);
+            i = findOutgoing(p);
+        }
+        // the closing edge may continue the last or the first edge
+        if (polygon.size() >= 3 && isCollinear(polygon.at(polygon.size() - 2), polygon.last(), polygon.first()))
+            polygon.removeLast();
+        if (polygon.size() >= 3 && isCollinear(polygon.last(), polygon.first(), polygon.at(1)))
+            polygon.removeFirst();
+        if (polygon.size() < 3)
+            continue;
+        path.moveTo(polygon.first());
+        for (qsizetype k = 1; k < polygon.size(); ++k)
+            path.lineTo(polygon.at(k));
+        path.closeSubpath();
+    }
+    return path;
+}
+
+QPainterPath QPathClipper::clipRectilinear()
+{
+    QList<QRectilinearEdge> edges;
+    addVerticalEdges(subjectPath, false, &edges);
+    addVerticalEdges(clipPath, true, &edges);
+    if (edges.isEmpty())
+        return QPainterPath();
+
+    std::sort(edges.begin(), edges.end(), [](const QRectilinearEdge &a, const QRectilinearEdge &b) {
+        return a.y1 < b.y1;
+    });
+    const auto lessThanX = [&edges](const QRectilinearActiveEdge &a, qreal x) {
+        return edges.at(a.edge).x < x;
+    };
+    const auto xLessThan = [&edges](qreal x, const QRectilinearActiveEdge &a) {
+        return x < edges.at(a.edge).x;
+    };
+
+    // The active edges are sorted by x, the edges ending next are found
+    // through a min-heap on their bottom y.
+    using EdgeEnd = std::pair<qreal, qsizetype>;
+    QList<QRectilinearActiveEdge> active;
+    QList<EdgeEnd> ends;
+    const auto endsLater = [](const EdgeEnd &a, const EdgeEnd &b) { return a.first > b.first; };
+
+    QList<QRectilinearSegment> segments;
+    QList<qreal> band;
+    QList<qreal> tops;
+    QList<qreal> intervals;
+    qsizetype nextEdge = 0;
+    while (nextEdge < edges.size() || !ends.isEmpty()) {
+        const qreal y = ends.isEmpty()
+                || (nextEdge < edges.size() && edges.at(nextEdge).y1 < ends.constFirst().first)
+                ? edges.at(nextEdge).y1 : ends.constFirst().first;
+
+        qreal xMin = qInf();
+        qreal xMax = -qInf();
+        while (!ends.isEmpty() && ends.constFirst().first <= y) {
+            const qsizetype e = ends.constFirst().second;
+            std::pop_heap(ends.begin(), ends.end(), endsLater);
+            ends.removeLast();
+            const qreal x = edges.at(e).x;
+            auto it = std::lower_bound(active.begin(), active.end(), x, lessThanX);
+            while (it->edge != e)
+                ++it;
+            active.erase(it);
+            xMin = qMin(xMin, x);
+            xMax = qMax(xMax, x);
+        }
+        for (; nextEdge < edges.size() && edges.at(nextEdge).y1 == y; ++nextEdge) {
+            const qreal x = edges.at(nextEdge).x;
+            active.insert(std::upper_bound(active.begin(), active.end(), x, xLessThan),
+                          { nextEdge, 0, 0 });
+            ends.append({ edges.at(nextEdge).y2, nextEdge });
+            std::push_heap(ends.begin(), ends.end(), endsLater);
+            xMin = qMin(xMin, x);
+            xMax = qMax(xMax, x);
+        }
+
+        // Sweep the active edges between xMin and xMax. If the windings
+        // right of them changed after all, the sweep runs on to the end.
+        qsizetype j = std::lower_bound(active.cbegin(), active.cend(), xMin, lessThanX) - active.cbegin();
+        qsizetype end = std::upper_bound(active.cbegin(), active.cend(), xMax, xLessThan) - active.cbegin();
+        int windingA = j > 0 ? active.at(j - 1).windingA : 0;
+        int windingB = j > 0 ? active.at(j - 1).windingB : 0;
+        bool inside = bool_op(windingA & aMask, windingB & bMask, op);
+        intervals.clear();
+        for (;;) {
+            for (; j < end; ++j) {
+                QRectilinearActiveEdge &a = active[j];
+                const QRectilinearEdge &edge = edges.at(a.edge);
+                if (edge.clip)
+                    windingB += edge.winding;
+                else
+                    windingA += edge.winding;
+                a.windingA = windingA;
+                a.windingB = windingB;
+                if (j + 1 < active.size() && edges.at(active.at(j + 1).edge).x == edge.x)
+                    continue;
+                const bool now = bool_op(windingA & aMask, windingB & bMask, op);
+                if (now != inside) {
+                    intervals.append(edge.x);
+                    inside = now;
+                }
+            }
+            if (end == active.size())
+                break;
+            const QRectilinearActiveEdge &following = active.at(end);
+            const QRectilinearEdge &edge = edges.at(following.edge);
+            if (following.windingA - (edge.clip ? 0 : edge.winding) == windingA
+                && following.windingB - (edge.clip ? edge.winding : 0) == windingB) {
+                break;
+            }
+            end = active.size();
+        }
+
+        const qsizetype lo = std::lower_bound(band.cbegin(), band.cend(), xMin) - band.cbegin();
+        const qsizetype hi = end == active.size()
+                ? band.size()
+                : std::upper_bound(band.cbegin(), band.cend(), xMax) - band.cbegin();
+        const QSpan<const qreal> above(band.constData() + lo, hi - lo);
+        if (std::equal(above.begin(), above.end(), intervals.cbegin(), intervals.cend()))
+            continue;
+        addHorizontalSegments(above, intervals, y, lo % 2 != 0, &segments);
+        addVerticalSegments(band, tops, lo, hi, intervals, y, &segments);
+    }
+    Q_ASSERT(band.isEmpty());
+
+    return tracePath(segments);
+}
+
 bool QWingedEdge::isInside(qreal x, qreal y) const
 {
     int winding = 0;
@@ -12,6 +12,7 @@
 #include "qbitmap.h"
 #include "qtransform.h"
 
+#include <algorithm>
 #include <memory>
 #include <private/qdebug_p.h>
 
@@ -618,10 +619,11 @@ bool QRegion::intersects(const QRegion &region) const
     if (rectCount() == 1 && region.rectCount() == 1)
         return true;
 
-    for (const QRect &myRect : *this)
-        for (const QRect &otherRect : region)
-            if (rect_intersects(myRect, otherRect))
-                return true;
+    const QRegion &fewer = rectCount() <= region.rectCount() ? *this : region;
+    const QRegion &more = rectCount() <= region.rectCount() ? region : *this;
+    for (const QRect &rect : fewer)
+        if (more.intersects(rect))
+            return true;
     return false;
 }
 
@@ -903,6 +905,20 @@ QRegion QRegion::intersect(const QRect &r) const
     \sa rects()
 */
 
+/*!
+    \fn QRegion QRegion::fromRects(QSpan<const QRect> rects)
+    \since 6.10
+
+    Returns the union of \a rects. Unlike setRects(), the rectangles may
+    overlap and be given in any order; empty rectangles are ignored.
+
+    The region is built in a single sweep over the sorted rectangles, which
+    is much faster than uniting them one by one when there are many of
+    them.
+
+    \sa setRects(), united()
+*/
+
 namespace {
 
 struct Segment
@@ -2666,10 +2682,29 @@ static bool EqualRegion(const QRegionPrivate *r1, const QRegionPrivate *r2)
     return true;
 }
 
-static bool PointInRegion(QRegionPrivate *pRegion, int x, int y)
+/*
+    The rectangles of a region form bands of equal top and bottom. The
+    bands are sorted by y and the rectangles of a band by x, so the band
+    reaching a given y, and the rectangle of a band reaching a given x, can
+    be found with a binary search.
+*/
+static const QRect *firstRectReachingY(const QRect *begin, const QRect *end, int y)
+{
+    return std::lower_bound(begin, end, y, [](const QRect &r, int y) { return r.bottom() < y; });
+}
+
+static const QRect *endOfBand(const QRect *band, const QRect *end)
+{
+    return std::upper_bound(band, end, band->top(), [](int top, const QRect &r) { return top < r.top(); });
+}
+
+static const QRect *firstRectReachingX(const QRect *band, const QRect *bandEnd, int x)
 {
-    int i;
+    return std::lower_bound(band, bandEnd, x, [](const QRect &r, int x) { return r.right() < x; });
+}
 
+static bool PointInRegion(QRegionPrivate *pRegion, int x, int y)
+{
     if (isEmptyHelper(pRegion))
         return false;
     if (!pRegion->extents.contains(x, y))
@@ -2678,11 +2713,14 @@ static bool PointInRegion(QRegionPrivate *pRegion, int x, int y)
         return pRegion->extents.contains(x, y);
     if (pRegion->innerRect.contains(x, y))
         return true;
-    for (i = 0; i < pRegion->numRects; ++i) {
-        if (pRegion->rects[i].contains(x, y))
-            return true;
-    }
-    return false;
+
+    const QRect *end = pRegion->rects.constData() + pRegion->numRects;
+    const QRect *band = firstRectReachingY(pRegion->rects.constData(), end, y);
+    if (band == end || band->top() > y)
+        return false;
+    const QRect *bandEnd = endOfBand(band, end);
+    const QRect *rect = firstRectReachingX(band, bandEnd, x);
+    return rect != bandEnd && rect->left() <= x;
 }
 
 static bool RectInRegion(QRegionPrivate *region, int rx, int ry, uint rwidth, uint rheight)
@@ -2702,6 +2740,7 @@ static bool RectInRegion(QRegionPrivate *region, int rx, int ry, uint rwidth, ui
     /* can stop when both partOut and partIn are true, or we reach prect->y2 */
     pbox = (region->numRects == 1) ? &region->extents : region->rects.constData();
     pboxEnd = pbox + region->numRects;
+    pbox = firstRectReachingY(pbox, pboxEnd, ry);
     for (; pbox < pboxEnd; ++pbox) {
         if (pbox->bottom() < ry)
            continue;
@@ -2713,8 +2752,11 @@ static bool RectInRegion(QRegionPrivate *region, int rx, int ry, uint rwidth, ui
            ry = pbox->top();
         }
 
-        if (pbox->right() < rx)
-           continue;            /* not far enough over yet */
+        if (pbox->right() < rx) {
+            /* not far enough over yet, skip ahead within the band */
+            pbox = firstRectReachingX(pbox, endOfBand(pbox, pboxEnd), rx) - 1;
+            continue;
+        }
 
         if (pbox->left() > rx) {
            partOut = true;      /* missed part of rectangle to left */
@@ -4276,6 +4318,86 @@ void QRegion::setRects(QSpan<const QRect> rects)
     }
 }
 
+QRegion QRegion::fromRects(QSpan<const QRect> rects)
+{
+    QList<QRect> input;
+    input.reserve(rects.size());
+    for (const QRect &rect : rects) {
+        if (!rect.isEmpty())
+            input.append(rect);
+    }
+    if (input.isEmpty())
+        return QRegion();
+    if (input.size() == 1)
+        return QRegion(input.first());
+
+    // The edges are kept in 64 bits, as the edge below a rectangle reaching
+    // INT_MAX does not fit in an int.
+    QList<qint64> ys;
+    ys.reserve(2 * input.size());
+    for (const QRect &rect : std::as_const(input)) {
+        ys.append(rect.top());
+        ys.append(qint64(rect.bottom()) + 1);
+    }
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+    std::sort(input.begin(), input.end(), [](const QRect &a, const QRect &b) {
+        return a.top() < b.top();
+    });
+
+    // Sweep the bands between consecutive edges, keeping the rectangles
+    // crossing the band sorted by their left edge.
+    const auto lessThanLeft = [&input](qsizetype a, qsizetype b) {
+        return input.at(a).left() < input.at(b).left();
+    };
+    QList<qsizetype> active;
+    QList<QRect> result;
+    qsizetype previousBand = -1;
+    qsizetype next = 0;
+    for (qsizetype k = 0; k + 1 < ys.size(); ++k) {
+        const int top = int(ys.at(k));
+        const int bottom = int(ys.at(k + 1) - 1);
+
+        active.removeIf([&](qsizetype i) { return input.at(i).bottom() < top; });
+        const qsizetype oldCount = active.size();
+        while (next < input.size() && input.at(next).top() == top)
+            active.append(next++);
+        std::sort(active.begin() + oldCount, active.end(), lessThanLeft);
+        std::inplace_merge(active.begin(), active.begin() + oldCount, active.end(), lessThanLeft);
+        if (active.isEmpty())
+            continue;
+
+        const qsizetype band = result.size();
+        for (qsizetype i : std::as_const(active)) {
+            const QRect &rect = input.at(i);
+            if (result.size() > band && rect.left() <= qint64(result.last().right()) + 1)
+                result.last().setRight(qMax(result.last().right(), rect.right()));
+            else
+                result.append(QRect(QPoint(rect.left(), top), QPoint(rect.right(), bottom)));
+        }
+
+        // Coalesce with the band above if it has the same rectangles.
+        const qsizetype count = result.size() - band;
+        bool coalesce = previousBand >= 0 && band - previousBand == count
+                && qint64(result.at(previousBand).bottom()) + 1 == top;
+        for (qsizetype i = 0; coalesce && i < count; ++i) {
+            coalesce = result.at(previousBand + i).left() == result.at(band + i).left()
+                    && result.at(previousBand + i).right() == result.at(band + i).right();
+        }
+        if (coalesce) {
+            for (qsizetype i = 0; i < count; ++i)
+                result[previousBand + i].setBottom(bottom);
+            result.resize(band);
+        } else {
+            previousBand = band;
+        }
+    }
+
+    QRegion region;
+    region.setRects(result);
+    return region;
+}
+
 /*!
     \since 6.8
 
@@ -4324,9 +4446,14 @@ bool QRegion::intersects(const QRect &rect) const
     if (d->qt_rgn->numRects == 1)
         return true;
 
-    for (const QRect &rect : *this) {
-        if (rect_intersects(r, rect))
+    const QRect *end = d->qt_rgn->rects.constData() + d->qt_rgn->numRects;
+    const QRect *band = firstRectReachingY(d->qt_rgn->rects.constData(), end, r.top());
+    while (band != end && band->top() <= r.bottom()) {
+        const QRect *bandEnd = endOfBand(band, end);
+        const QRect *rect = firstRectReachingX(band, bandEnd, r.left());
+        if (rect != bandEnd && rect->left() <= r.right())
             return true;
+        band = bandEnd;
     }
     return false;
 }
@@ -0,0 +1,418 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QRTREE_P_H
+#define QRTREE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    A two dimensional R-tree mapping rectangles to values of type T.
+
+    insert() returns a handle that stays valid until the entry is removed;
+    bulkLoad() builds a packed tree in one go using sort-tile-recursive
+    packing and hands out the input indexes as handles. Rectangles are
+    treated as closed, so empty and zero sized rectangles are found by
+    queries that touch them.
+
+    Removal drops empty nodes but does not reinsert the entries of
+    underfull ones, so a tree that sees many removals should be rebuilt
+    with bulkLoad() from time to time.
+*/
+template <typename T>
+class QRTree
+{
+public:
+    enum { MaxEntries = 16 };
+
+    bool isEmpty() const { return m_count == 0; }
+    qsizetype size() const { return m_count; }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_freeEntries.clear();
+        m_nodes.clear();
+        m_freeNodes.clear();
+        m_root = -1;
+        m_count = 0;
+    }
+
+    QRectF boundingRect() const
+    {
+        return m_root >= 0 ? m_nodes.at(m_root).rect : QRectF();
+    }
+
+    const T &value(int handle) const { return m_entries.at(handle).value; }
+    QRectF rect(int handle) const { return m_entries.at(handle).rect; }
+
+    int insert(const QRectF &rect, const T &value)
+    {
+        int handle;
+        if (!m_freeEntries.isEmpty()) {
+            handle = m_freeEntries.takeLast();
+            m_entries[handle] = { rect, value, -1 };
+        } else {
+            handle = int(m_entries.size());
+            m_entries.append({ rect, value, -1 });
+        }
+        attach(handle);
+        ++m_count;
+        return handle;
+    }
+
+    void remove(int handle)
+    {
+        Q_ASSERT(m_entries.at(handle).leaf >= 0);
+        detach(handle);
+        m_entries[handle].value = T();
+        m_freeEntries.append(handle);
+        if (--m_count == 0)
+            clear();
+    }
+
+    void update(int handle, const QRectF &rect)
+    {
+        Entry &entry = m_entries[handle];
+        Q_ASSERT(entry.leaf >= 0);
+        if (contains(m_nodes.at(entry.leaf).rect, rect)) {
+            // Still inside its leaf, only the ancestors may shrink.
+            entry.rect = rect;
+            for (int n = entry.leaf; n >= 0; n = m_nodes.at(n).parent)
+                recomputeRect(n);
+            return;
+        }
+        detach(handle);
+        m_entries[handle].rect = rect;
+        attach(handle);
+    }
+
+    /*
+        Replaces the contents of the tree with \a count entries. The handle of
+        each entry is its index in \a rects and \a values.
+    */
+    void bulkLoad(const QRectF *rects, const T *values, qsizetype count)
+    {
+        clear();
+        if (count <= 0)
+            return;
+
+        m_entries.reserve(count);
+        QList<int> level(count);
+        for (qsizetype i = 0; i < count; ++i) {
+            m_entries.append({ rects[i], values[i], -1 });
+            level[i] = int(i);
+        }
+        m_count = count;
+
+        bool leaves = true;
+        do {
+            level = pack(level, leaves);
+            leaves = false;
+        } while (level.size() > 1);
+        m_root = level.first();
+    }
+
+    /*
+        Calls \a func with the value of every entry whose rectangle overlaps
+        \a rect.
+    */
+    template <typename Func>
+    void intersecting(const QRectF &rect, Func func) const
+    {
+        if (m_root < 0 || !overlaps(m_nodes.at(m_root).rect, rect))
+            return;
+
+        QVarLengthArray<int, 64> stack;
+        stack.append(m_root);
+        while (!stack.isEmpty()) {
+            const Node &node = m_nodes.at(stack.last());
+            stack.removeLast();
+            if (node.leaf) {
+                for (int child : node.children) {
+                    const Entry &entry = m_entries.at(child);
+                    if (overlaps(entry.rect, rect))
+                        func(entry.value);
+                }
+            } else {
+                for (int child : node.children) {
+                    if (overlaps(m_nodes.at(child).rect, rect))
+                        stack.append(child);
+                }
+            }
+        }
+    }
+
+    /*
+        Calls \a func with the rectangle and the value of every entry.
+    */
+    template <typename Func>
+    void forEach(Func func) const
+    {
+        for (const Entry &entry : m_entries) {
+            if (entry.leaf >= 0)
+                func(entry.rect, entry.value);
+        }
+    }
+
+private:
+    struct Entry
+    {
+        QRectF rect;
+        T value;
+        int leaf;       // node holding the entry, -1 if the entry is free
+    };
+
+    struct Node
+    {
+        QRectF rect;
+        int parent;
+        bool leaf;
+        QVarLengthArray<int, MaxEntries + 1> children;
+    };
+
+    static bool overlaps(const QRectF &a, const QRectF &b)
+    {
+        return a.left() <= b.right() && b.left() <= a.right()
+            && a.top() <= b.bottom() && b.top() <= a.bottom();
+    }
+
+    static bool contains(const QRectF &outer, const QRectF &inner)
+    {
+        return outer.left() <= inner.left() && inner.right() <= outer.right()
+            && outer.top() <= inner.top() && inner.bottom() <= outer.bottom();
+    }
+
+    static QRectF unite(const QRectF &a, const QRectF &b)
+    {
+        const qreal left = qMin(a.left(), b.left());
+        const qreal top = qMin(a.top(), b.top());
+        return QRectF(left, top, qMax(a.right(), b.right()) - left,
+                      qMax(a.bottom(), b.bottom()) - top);
+    }
+
+    static qreal area(const QRectF &r) { return r.width() * r.height(); }
+
+    QRectF childRect(const Node &node, int child) const
+    {
+        return node.leaf ? m_entries.at(child).rect : m_nodes.at(child).rect;
+    }
+
+    void setParent(bool leaf, int child, int parent)
+    {
+        if (leaf)
+            m_entries[child].leaf = parent;
+        else
+            m_nodes[child].parent = parent;
+    }
+
+    int allocNode(bool leaf, int parent)
+    {
+        if (!m_freeNodes.isEmpty()) {
+            const int n = m_freeNodes.takeLast();
+            m_nodes[n] = Node{ QRectF(), parent, leaf, {} };
+            return n;
+        }
+        m_nodes.append(Node{ QRectF(), parent, leaf, {} });
+        return int(m_nodes.size() - 1);
+    }
+
+    void freeNode(int n)
+    {
+        m_nodes[n].children.clear();
+        m_freeNodes.append(n);
+    }
+
+    void recomputeRect(int n)
+    {
+        Node &node = m_nodes[n];
+        if (node.children.isEmpty())
+            return;
+        QRectF r = childRect(node, node.children.first());
+        for (qsizetype i = 1; i < node.children.size(); ++i)
+            r = unite(r, childRect(node, node.children.at(i)));
+        node.rect = r;
+    }
+
+    int chooseLeaf(const QRectF &rect) const
+    {
+        int n = m_root;
+        while (!m_nodes.at(n).leaf) {
+            const Node &node = m_nodes.at(n);
+            int best = node.children.first();
+            qreal bestGrowth = 0;
+            qreal bestArea = 0;
+            for (qsizetype i = 0; i < node.children.size(); ++i) {
+                const int child = node.children.at(i);
+                const QRectF &r = m_nodes.at(child).rect;
+                const qreal a = area(r);
+                const qreal growth = area(unite(r, rect)) - a;
+                if (i == 0 || growth < bestGrowth || (growth == bestGrowth && a < bestArea)) {
+                    best = child;
+                    bestGrowth = growth;
+                    bestArea = a;
+                }
+            }
+            n = best;
+        }
+        return n;
+    }
+
+    void attach(int handle)
+    {
+        const QRectF rect = m_entries.at(handle).rect;
+        if (m_root < 0) {
+            m_root = allocNode(true, -1);
+            m_nodes[m_root].rect = rect;
+        }
+
+        const int leaf = chooseLeaf(rect);
+        m_nodes[leaf].children.append(handle);
+        m_entries[handle].leaf = leaf;
+        for (int n = leaf; n >= 0; n = m_nodes.at(n).parent) {
+            Node &node = m_nodes[n];
+            node.rect = node.children.size() == 1 && n == leaf ? rect : unite(node.rect, rect);
+        }
+
+        int n = leaf;
+        while (n >= 0 && m_nodes.at(n).children.size() > MaxEntries)
+            n = split(n);
+    }
+
+    /*
+        Splits the overflowing node \a n in two halves along the longer axis
+        of its rectangle. Returns the parent, which may overflow in turn.
+    */
+    int split(int n)
+    {
+        const bool leaf = m_nodes.at(n).leaf;
+        const QRectF bounds = m_nodes.at(n).rect;
+        const bool horizontal = bounds.width() >= bounds.height();
+
+        QVarLengthArray<int, MaxEntries + 1> children = m_nodes.at(n).children;
+        std::sort(children.begin(), children.end(), [&](int a, int b) {
+            const QPointF ca = childRect(m_nodes.at(n), a).center();
+            const QPointF cb = childRect(m_nodes.at(n), b).center();
+            return horizontal ? ca.x() < cb.x() : ca.y() < cb.y();
+        });
+
+        int parent = m_nodes.at(n).parent;
+        if (parent < 0) {
+            parent = allocNode(false, -1);
+            m_nodes[parent].children.append(n);
+            m_nodes[parent].rect = bounds;
+            m_nodes[n].parent = parent;
+            m_root = parent;
+        }
+
+        const int sibling = allocNode(leaf, parent);
+        const qsizetype half = children.size() / 2;
+        m_nodes[n].children.clear();
+        for (qsizetype i = 0; i < children.size(); ++i) {
+            const int target = i < half ? n : sibling;
+            m_nodes[target].children.append(children.at(i));
+            setParent(leaf, children.at(i), target);
+        }
+        recomputeRect(n);
+        recomputeRect(sibling);
+        m_nodes[parent].children.append(sibling);
+        return parent;
+    }
+
+    void detach(int handle)
+    {
+        Entry &entry = m_entries[handle];
+        int n = entry.leaf;
+        entry.leaf = -1;
+        Node &leaf = m_nodes[n];
+        leaf.children.removeOne(handle);
+
+        // Drop the nodes that became empty, then shrink what is left.
+        while (n != m_root && m_nodes.at(n).children.isEmpty()) {
+            const int parent = m_nodes.at(n).parent;
+            m_nodes[parent].children.removeOne(n);
+            freeNode(n);
+            n = parent;
+        }
+        for (int p = n; p >= 0; p = m_nodes.at(p).parent)
+            recomputeRect(p);
+
+        while (!m_nodes.at(m_root).leaf && m_nodes.at(m_root).children.size() == 1) {
+            const int child = m_nodes.at(m_root).children.first();
+            freeNode(m_root);
+            m_root = child;
+            m_nodes[child].parent = -1;
+        }
+    }
+
+    /*
+        Groups \a items, entry handles if \a leaves is true and node indexes
+        otherwise, into new nodes using sort-tile-recursive packing and
+        returns the indexes of the new nodes.
+    */
+    QList<int> pack(QList<int> items, bool leaves)
+    {
+        auto rectOf = [&](int item) {
+            return leaves ? m_entries.at(item).rect : m_nodes.at(item).rect;
+        };
+
+        const qsizetype nodeCount = (items.size() + MaxEntries - 1) / MaxEntries;
+        const qsizetype sliceCount = qCeil(qSqrt(qreal(nodeCount)));
+        const qsizetype sliceSize = sliceCount * MaxEntries;
+
+        std::sort(items.begin(), items.end(), [&](int a, int b) {
+            return rectOf(a).center().x() < rectOf(b).center().x();
+        });
+
+        QList<int> parents;
+        parents.reserve(nodeCount);
+        for (qsizetype s = 0; s < items.size(); s += sliceSize) {
+            const auto sliceBegin = items.begin() + s;
+            const auto sliceEnd = items.begin() + qMin(s + sliceSize, items.size());
+            std::sort(sliceBegin, sliceEnd, [&](int a, int b) {
+                return rectOf(a).center().y() < rectOf(b).center().y();
+            });
+            for (auto it = sliceBegin; it < sliceEnd; it += qMin<qsizetype>(MaxEntries, sliceEnd - it)) {
+                const int node = allocNode(leaves, -1);
+                const auto chunkEnd = it + qMin<qsizetype>(MaxEntries, sliceEnd - it);
+                for (auto child = it; child != chunkEnd; ++child) {
+                    m_nodes[node].children.append(*child);
+                    setParent(leaves, *child, node);
+                }
+                recomputeRect(node);
+                parents.append(node);
+            }
+        }
+        return parents;
+    }
+
+    QList<Entry> m_entries;
+    QList<int> m_freeEntries;
+    QList<Node> m_nodes;
+    QList<int> m_freeNodes;
+    int m_root = -1;
+    qsizetype m_count = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QRTREE_P_H
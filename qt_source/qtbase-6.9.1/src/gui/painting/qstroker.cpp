@@ -331,7 +331,7 @@ QStroker::QStroker()
     : m_capStyle(SquareJoin), m_joinStyle(FlatJoin),
       m_back1X(0), m_back1Y(0),
       m_back2X(0), m_back2Y(0),
-      m_forceOpen(false)
+      m_forceOpen(false), m_flatStart(false), m_flatEnd(false)
 {
     m_strokeWidth = qt_real_to_fixed(1);
     m_miterLimit = qt_real_to_fixed(2);
@@ -391,7 +391,7 @@ void QStroker::processCurrentSubpath()
     bool bwclosed = qt_stroke_side(&bwit, this, !fwclosed, &bwStartTangent);
 
     if (!bwclosed && !fwStartTangent.isNull())
-        joinPoints(m_elements.at(0).x, m_elements.at(0).y, fwStartTangent, m_capStyle);
+        joinPoints(m_elements.at(0).x, m_elements.at(0).y, fwStartTangent, startCapStyleMode());
 }
 
 
@@ -638,7 +638,7 @@ template <class Iterator> bool qt_stroke_side(Iterator *it,
                 // If we are starting a new subpath, move to correct starting point.
                 if (first) {
                     if (capFirst)
-                        stroker->joinPoints(prev.x, prev.y, line, stroker->capStyleMode());
+                        stroker->joinPoints(prev.x, prev.y, line, stroker->endCapStyleMode());
                     else
                         stroker->emitMoveTo(qt_real_to_fixed(line.x1()), qt_real_to_fixed(line.y1()));
                     *startTangent = line;
@@ -683,7 +683,7 @@ template <class Iterator> bool qt_stroke_side(Iterator *it,
                     if (capFirst) {
                         stroker->joinPoints(prev.x, prev.y,
                                             tangent,
-                                            stroker->capStyleMode());
+                                            stroker->endCapStyleMode());
                     } else {
                         stroker->emitMoveTo(qt_real_to_fixed(pt.x()),
                                             qt_real_to_fixed(pt.y()));
@@ -1096,6 +1096,28 @@ bool QFontEngineFT::expectsGammaCorrectedBlending() const
     return stemDarkeningDriver;
 }
 
+QFontEngine::RasterizationSettings QFontEngineFT::rasterizationSettings(GlyphFormat neededFormat) const
+{
+    RasterizationSettings settings;
+    // Resolve the format the same way glyphData() does
+    if (isBitmapFont())
+        settings.format = Format_Mono;
+    else if (neededFormat == Format_None && defaultFormat != Format_None)
+        settings.format = defaultFormat;
+    else if (neededFormat == Format_None)
+        settings.format = Format_A8;
+    else
+        settings.format = neededFormat;
+    settings.hintStyle = default_hint_style;
+    settings.subpixelType = subpixelType;
+    settings.lcdFilter = lcdFilterType;
+    settings.loadFlags = default_load_flags;
+    settings.antialias = antialias;
+    settings.embeddedBitmaps = embeddedbitmap;
+    settings.gammaCorrected = stemDarkeningDriver;
+    return settings;
+}
+
 int QFontEngineFT::loadFlags(QGlyphSet *set, GlyphFormat format, int flags,
                              bool &hsubpixel, int &vfactor) const
 {
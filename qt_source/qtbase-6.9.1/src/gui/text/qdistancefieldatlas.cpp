@@ -0,0 +1,256 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qdistancefieldatlas_p.h"
+
+#include <qpainterpath.h>
+#include <qthreadstorage.h>
+#include <qvarlengtharray.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QDistanceFieldAtlas
+    \internal
+    \inmodule QtGui
+
+    \brief The QDistanceFieldAtlas class holds signed distance fields of
+    glyphs for the raster paint engine.
+
+    A distance field describes the outline of a glyph independently of the
+    size it is drawn at. The atlas keeps one distance field per glyph and
+    face, generated from the outline of a reference font engine at
+    referencePixelSize(), so text that is drawn at ever changing scales, as
+    when zooming, is rendered from the same fields instead of being
+    rasterized again for every scale.
+
+    The fields are shared by all threads of the process. The mutex of the
+    atlas only guards the lookups and the publication of new fields; the
+    fields themselves are generated unlocked. A thread reserves the glyphs
+    it misses, generates them and publishes them, and other threads that
+    need a reserved glyph wait for it instead of generating it again.
+
+    Font engines belong to the thread that created them, so every thread
+    generates fields from reference engines of its own, cloned from its own
+    font engines.
+
+    When the fields cost more than maximumCost() bytes, the least recently
+    used ones are dropped.
+*/
+
+namespace {
+// The reference engines of one thread, by face.
+struct QDistanceFieldReferenceEngines
+{
+    QHash<int, QFontEngine *> engines;
+
+    ~QDistanceFieldReferenceEngines()
+    {
+        for (QFontEngine *fontEngine : std::as_const(engines)) {
+            if (fontEngine && !fontEngine->ref.deref())
+                delete fontEngine;
+        }
+    }
+};
+} // unnamed namespace
+
+Q_GLOBAL_STATIC(QThreadStorage<QDistanceFieldReferenceEngines *>, qt_distance_field_reference_engines)
+
+QDistanceFieldAtlas::QDistanceFieldAtlas()
+    : m_glyphs(16 * 1024 * 1024),
+      m_referencePixelSize(QT_DISTANCEFIELD_BASEFONTSIZE(false) * QT_DISTANCEFIELD_SCALE(false)),
+      m_fieldScale(QT_DISTANCEFIELD_SCALE(false)),
+      m_spread(QT_DISTANCEFIELD_RADIUS(false) / QT_DISTANCEFIELD_SCALE(false))
+{
+}
+
+QDistanceFieldAtlas::~QDistanceFieldAtlas()
+{
+    m_glyphs.clear();
+}
+
+Q_GLOBAL_STATIC(QDistanceFieldAtlas, qt_distance_field_atlas)
+
+/*!
+    Returns the process-wide distance field atlas.
+*/
+QDistanceFieldAtlas *QDistanceFieldAtlas::instance()
+{
+    return qt_distance_field_atlas();
+}
+
+/*!
+    Returns \c true if the glyphs of \a fontEngine can be drawn from
+    distance fields. This requires a single, identifiable face with
+    monochrome glyphs.
+*/
+bool QDistanceFieldAtlas::supports(QFontEngine *fontEngine)
+{
+    if (fontEngine->type() == QFontEngine::Multi
+        || fontEngine->glyphFormat == QFontEngine::Format_ARGB) {
+        return false;
+    }
+    const QFontEngine::FaceId faceId = fontEngine->faceId();
+    return !faceId.filename.isEmpty() || !faceId.uuid.isEmpty();
+}
+
+// Called with the mutex held.
+int QDistanceFieldAtlas::faceFor(QFontEngine *fontEngine)
+{
+    const QFontDef &def = fontEngine->fontDef;
+    const FaceKey key = { fontEngine->faceId(), int(fontEngine->type()),
+                          int(fontEngine->synthesized()), def.weight, def.style };
+    return *m_faceIds.tryEmplace(key, int(m_faceIds.size())).iterator;
+}
+
+// Returns the reference engine of the calling thread for \a face, cloning
+// it from \a fontEngine the first time. Called without the mutex held.
+QFontEngine *QDistanceFieldAtlas::referenceEngine(int face, QFontEngine *fontEngine)
+{
+    QDistanceFieldReferenceEngines *&local = qt_distance_field_reference_engines()->localData();
+    if (!local)
+        local = new QDistanceFieldReferenceEngines;
+    const auto r = local->engines.tryEmplace(face, nullptr);
+    if (r.inserted) {
+        QFontEngine *reference = fontEngine->cloneWithSize(m_referencePixelSize);
+        if (reference)
+            reference->ref.ref();
+        *r.iterator = reference;
+    }
+    return *r.iterator;
+}
+
+// Generates the field of \a glyph from the outline of \a reference. Called
+// without the mutex held.
+QDistanceFieldAtlas::Glyph QDistanceFieldAtlas::generate(QFontEngine *reference,
+                                                         glyph_t glyph) const
+{
+    Glyph result;
+    if (!reference)
+        return result;
+    QFixedPoint position;
+    QPainterPath path;
+    reference->addGlyphsToPath(&glyph, &position, 1, &path, { });
+    if (!path.isEmpty()) {
+        const qreal margin = m_spread * m_fieldScale;
+        result.field = QDistanceField(path, glyph, false);
+        result.origin = path.boundingRect().topLeft() - QPointF(margin, margin);
+    }
+    return result;
+}
+
+/*!
+    Stores the distance fields of the \a count glyphs in \a glyphs of
+    \a fontEngine in \a out, generating the fields that are not in the
+    atlas yet. Glyphs without outline, and all glyphs of a font engine that
+    cannot be cloned at the reference size, get a null field.
+*/
+void QDistanceFieldAtlas::glyphs(QFontEngine *fontEngine, const glyph_t *glyphs, int count,
+                                 Glyph *out)
+{
+    QVarLengthArray<int, 64> generated;  // reserved by this thread
+    QVarLengthArray<int, 64> awaited;    // reserved by other threads
+
+    QMutexLocker locker(&m_mutex);
+    const int face = faceFor(fontEngine);
+    for (int i = 0; i < count; ++i) {
+        const Key key = { face, glyphs[i] };
+        if (const Glyph *glyph = m_glyphs.object(key)) {
+            ++m_hits;
+            out[i] = *glyph;
+        } else if (m_pending.contains(key)) {
+            awaited.append(i);
+        } else {
+            ++m_misses;
+            m_pending.insert(key);
+            generated.append(i);
+        }
+    }
+
+    const auto publish = [&](int i) {
+        const Key key = { face, glyphs[i] };
+        const qsizetype cost = qsizetype(out[i].field.width()) * out[i].field.height()
+                + qsizetype(sizeof(Glyph));
+        m_glyphs.insert(key, new Glyph(out[i]), cost);
+    };
+
+    if (!generated.isEmpty()) {
+        locker.unlock();
+        QFontEngine *reference = referenceEngine(face, fontEngine);
+        for (int i : std::as_const(generated))
+            out[i] = generate(reference, glyphs[i]);
+        locker.relock();
+        for (int i : std::as_const(generated)) {
+            publish(i);
+            m_pending.remove({ face, glyphs[i] });
+        }
+        m_published.wakeAll();
+    }
+
+    // The glyphs other threads were generating may already have been
+    // evicted again by the time they are published; those are generated
+    // here after all.
+    QVarLengthArray<int, 64> missed;
+    for (int i : std::as_const(awaited)) {
+        const Key key = { face, glyphs[i] };
+        while (m_pending.contains(key))
+            m_published.wait(&m_mutex);
+        if (const Glyph *glyph = m_glyphs.object(key)) {
+            ++m_hits;
+            out[i] = *glyph;
+        } else {
+            ++m_misses;
+            missed.append(i);
+        }
+    }
+    if (!missed.isEmpty()) {
+        locker.unlock();
+        QFontEngine *reference = referenceEngine(face, fontEngine);
+        for (int i : std::as_const(missed))
+            out[i] = generate(reference, glyphs[i]);
+        locker.relock();
+        for (int i : std::as_const(missed))
+            publish(i);
+    }
+}
+
+/*!
+    Sets the number of bytes the distance fields may use to \a bytes.
+*/
+void QDistanceFieldAtlas::setMaximumCost(qsizetype bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_glyphs.setMaxCost(bytes);
+}
+
+qsizetype QDistanceFieldAtlas::maximumCost() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_glyphs.maxCost();
+}
+
+/*!
+    Returns the hit and miss counters of the atlas together with its
+    current size.
+*/
+QDistanceFieldAtlas::Statistics QDistanceFieldAtlas::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    Statistics statistics;
+    statistics.hits = m_hits;
+    statistics.misses = m_misses;
+    statistics.glyphCount = m_glyphs.count();
+    statistics.cost = m_glyphs.totalCost();
+    return statistics;
+}
+
+/*!
+    Removes all distance fields from the atlas. The counters are kept.
+*/
+void QDistanceFieldAtlas::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_glyphs.clear();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,121 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QDISTANCEFIELDATLAS_P_H
+#define QDISTANCEFIELDATLAS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtGui/private/qtguiglobal_p.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qpoint.h>
+#include <QtCore/qset.h>
+#include <QtCore/qwaitcondition.h>
+#include "private/qdistancefield_p.h"
+#include "private/qfontengine_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class Q_GUI_EXPORT QDistanceFieldAtlas
+{
+public:
+    // The distance field of a glyph. Field pixel (x, y) covers the square
+    // of fieldScale() reference units whose top-left corner is
+    // origin + (x, y) * fieldScale(), relative to the glyph's origin at
+    // referencePixelSize().
+    struct Glyph
+    {
+        QDistanceField field;
+        QPointF origin;
+    };
+
+    struct Statistics
+    {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        qsizetype glyphCount = 0;
+        qsizetype cost = 0;
+    };
+
+    QDistanceFieldAtlas();
+    ~QDistanceFieldAtlas();
+
+    static QDistanceFieldAtlas *instance();
+    static bool supports(QFontEngine *fontEngine);
+
+    qreal referencePixelSize() const { return m_referencePixelSize; }
+    qreal fieldScale() const { return m_fieldScale; }
+    qreal spread() const { return m_spread; }
+
+    void glyphs(QFontEngine *fontEngine, const glyph_t *glyphs, int count, Glyph *out);
+
+    void setMaximumCost(qsizetype bytes);
+    qsizetype maximumCost() const;
+
+    Statistics statistics() const;
+    void clear();
+
+private:
+    Q_DISABLE_COPY_MOVE(QDistanceFieldAtlas)
+
+    struct FaceKey
+    {
+        QFontEngine::FaceId faceId;
+        int type;
+        int synthesized;
+        uint weight;
+        uint style;
+
+        friend bool operator==(const FaceKey &a, const FaceKey &b) noexcept
+        {
+            return a.faceId == b.faceId && a.type == b.type && a.synthesized == b.synthesized
+                && a.weight == b.weight && a.style == b.style;
+        }
+        friend size_t qHash(const FaceKey &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.faceId, key.type, key.synthesized, key.weight, key.style);
+        }
+    };
+
+    struct Key
+    {
+        int face;
+        glyph_t glyph;
+
+        friend bool operator==(const Key &a, const Key &b) noexcept
+        { return a.face == b.face && a.glyph == b.glyph; }
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        { return qHashMulti(seed, key.face, key.glyph); }
+    };
+
+    int faceFor(QFontEngine *fontEngine);
+    QFontEngine *referenceEngine(int face, QFontEngine *fontEngine);
+    Glyph generate(QFontEngine *reference, glyph_t glyph) const;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_published;
+    QHash<FaceKey, int> m_faceIds;
+    QSet<Key> m_pending;                        // being generated by some thread
+    QCache<Key, Glyph> m_glyphs;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+
+    qreal m_referencePixelSize;
+    qreal m_fieldScale;
+    qreal m_spread;
+};
+
+QT_END_NAMESPACE
+
+#endif // QDISTANCEFIELDATLAS_P_H
@@ -21,6 +21,7 @@
 #include <private/qfontengine_p.h>
 #include <private/qpainter_p.h>
 #include <private/qtextengine_p.h>
+#include <private/qtextshapingcache_p.h>
 #include <limits.h>
 
 #include <qpa/qplatformscreen.h>
@@ -3398,6 +3399,9 @@ QFontCache::~QFontCache()
 
 void QFontCache::clear()
 {
+    // the shaping of the engines released here can no longer be used
+    QTextShapingCache::clearForCurrentThread();
+
     {
         EngineDataCache::Iterator it = engineDataCache.begin(),
                                  end = engineDataCache.end();
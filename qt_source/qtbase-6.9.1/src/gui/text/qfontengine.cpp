@@ -103,8 +103,10 @@ Q_AUTOTEST_EXPORT QList<QFontEngine *> QFontEngine_stopCollectingEngines()
 
 #define kBearingNotInitialized std::numeric_limits<qreal>::max()
 
+Q_CONSTINIT static QBasicAtomicInteger<quint64> font_engine_cache_key = Q_BASIC_ATOMIC_INITIALIZER(0);
+
 QFontEngine::QFontEngine(Type type)
-    : m_type(type), ref(0),
+    : m_type(type), m_cacheKey(font_engine_cache_key.fetchAndAddRelaxed(1) + 1), ref(0),
       font_(),
       face_(),
       m_heightMetricsQueried(false),
@@ -255,6 +257,22 @@ bool QFontEngine::supportsTransformation(const QTransform &transform) const
     return transform.type() < QTransform::TxProject;
 }
 
+/*!
+    \internal
+
+    Returns the settings that, besides the font definition, decide the
+    bitmaps glyphData() renders for \a neededFormat. Engines that cache
+    glyphs internally and rasterize with settings of their own reimplement
+    this.
+*/
+QFontEngine::RasterizationSettings QFontEngine::rasterizationSettings(GlyphFormat neededFormat) const
+{
+    RasterizationSettings settings;
+    settings.format = neededFormat != Format_None ? neededFormat : glyphFormat;
+    settings.gammaCorrected = expectsGammaCorrectedBlending();
+    return settings;
+}
+
 bool QFontEngine::expectsGammaCorrectedBlending() const
 {
     return true;
@@ -0,0 +1,291 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsharedglyphcache_p.h"
+
+#include <qtransform.h>
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QSharedGlyphCache
+    \internal
+    \inmodule QtGui
+
+    \brief The QSharedGlyphCache class holds rendered glyphs for all threads
+    of the process.
+
+    Font engines belong to the thread that created them, so the glyphs a
+    font engine caches internally are rendered again by every thread that
+    draws the same text. The shared glyph cache keeps the rendered glyphs
+    of the engines that identify their face, keyed by the face, the font
+    settings and QFontEngine::rasterizationSettings() that affect
+    rasterization, the resolved glyph format, the transform and the
+    sub-pixel position, so a glyph is rasterized once per process.
+
+    The font id of an engine is resolved once and kept on the engine until
+    it is drawn with other settings or another transform. At most 1024 font
+    keys are remembered; beyond that the table is dropped, new ids are
+    handed out and the glyphs of the forgotten ids age out of the cache.
+
+    The glyphs are spread over shards by key. Lookups only take the read
+    lock of their shard and never wait for each other; insertions take the
+    write lock of one shard. Glyphs are reference counted, so a glyph that
+    is being drawn stays valid while it is evicted.
+
+    When the glyphs of a shard cost more than its part of maximumCost(),
+    the least recently used glyphs of the shard are evicted until it is
+    down to three quarters of its budget. Each shard has its own clock,
+    advanced by insertions, so lookups on different shards never touch a
+    shared counter.
+*/
+
+QSharedGlyphCache::QSharedGlyphCache()
+    : m_maximumCost(32 * 1024 * 1024)
+{
+}
+
+QSharedGlyphCache::~QSharedGlyphCache()
+{
+}
+
+Q_GLOBAL_STATIC(QSharedGlyphCache, qt_shared_glyph_cache)
+
+/*!
+    Returns the process-wide glyph cache.
+*/
+QSharedGlyphCache *QSharedGlyphCache::instance()
+{
+    return qt_shared_glyph_cache();
+}
+
+/*!
+    Returns the identifier under which the glyphs of \a fontEngine rendered
+    in \a format with \a matrix are shared, or -1 if the engine cannot
+    share its glyphs.
+*/
+int QSharedGlyphCache::fontId(QFontEngine *fontEngine, QFontEngine::GlyphFormat format,
+                              const QTransform &matrix)
+{
+    const QFontEngine::RasterizationSettings settings = fontEngine->rasterizationSettings(format);
+    QFontEngine::SharedGlyphCacheFont &font = fontEngine->sharedGlyphCacheFont;
+    if (font.resolved && font.settings == settings && font.m11 == matrix.m11()
+        && font.m12 == matrix.m12() && font.m21 == matrix.m21() && font.m22 == matrix.m22()) {
+        return font.id;
+    }
+
+    font.id = resolveFontId(fontEngine, settings, matrix);
+    font.resolved = true;
+    font.settings = settings;
+    font.m11 = matrix.m11();
+    font.m12 = matrix.m12();
+    font.m21 = matrix.m21();
+    font.m22 = matrix.m22();
+    return font.id;
+}
+
+int QSharedGlyphCache::resolveFontId(QFontEngine *fontEngine,
+                                     const QFontEngine::RasterizationSettings &settings,
+                                     const QTransform &matrix)
+{
+    FontKey key;
+    key.faceId = fontEngine->faceId();
+    if (key.faceId.filename.isEmpty() && key.faceId.uuid.isEmpty())
+        return -1;
+
+    const QFontDef &def = fontEngine->fontDef;
+    key.type = fontEngine->type();
+    key.synthesized = fontEngine->synthesized();
+    key.settings = settings;
+    key.pixelSize = def.pixelSize;
+    key.weight = def.weight;
+    key.style = def.style;
+    key.stretch = def.stretch;
+    key.styleStrategy = def.styleStrategy;
+    key.hintingPreference = def.hintingPreference;
+    key.m11 = matrix.m11();
+    key.m12 = matrix.m12();
+    key.m21 = matrix.m21();
+    key.m22 = matrix.m22();
+
+    {
+        QReadLocker locker(&m_fontLock);
+        const auto it = m_fontIds.constFind(key);
+        if (it != m_fontIds.constEnd())
+            return it.value();
+    }
+
+    QWriteLocker locker(&m_fontLock);
+    const auto it = m_fontIds.constFind(key);
+    if (it != m_fontIds.constEnd())
+        return it.value();
+    // Ids are never reused, so glyphs cached under a forgotten id can
+    // never be returned for another font.
+    if (m_fontIds.size() >= MaximumFontIds)
+        m_fontIds.clear();
+    const int id = m_nextFontId++;
+    m_fontIds.insert(key, id);
+    return id;
+}
+
+/*!
+    Returns the glyph \a glyph of the font \a fontId at \a subPixelPosition,
+    or a null pointer if it is not in the cache.
+*/
+QSharedGlyphCache::GlyphPointer QSharedGlyphCache::find(int fontId, glyph_t glyph,
+                                                        const QFixedPoint &subPixelPosition)
+{
+    const Key key = { fontId, glyph, subPixelPosition.x.value(), subPixelPosition.y.value() };
+    Shard &shard = shardFor(key);
+
+    QReadLocker locker(&shard.lock);
+    const auto it = shard.glyphs.constFind(key);
+    if (it == shard.glyphs.constEnd()) {
+        shard.misses.fetchAndAddRelaxed(1);
+        return GlyphPointer();
+    }
+    shard.hits.fetchAndAddRelaxed(1);
+    // The clock only moves under the write lock, so glyphs used since the
+    // last insertion are written once.
+    if (it.value()->lastUse.loadRelaxed() != shard.clock)
+        it.value()->lastUse.storeRelaxed(shard.clock);
+    return it.value();
+}
+
+/*!
+    Adds a copy of \a rendered as the glyph \a glyph of the font \a fontId
+    at \a subPixelPosition and returns it. If another thread added the glyph
+    in the meantime, that glyph is returned instead.
+*/
+QSharedGlyphCache::GlyphPointer QSharedGlyphCache::insert(int fontId, glyph_t glyph,
+                                                          const QFixedPoint &subPixelPosition,
+                                                          const QFontEngine::Glyph &rendered)
+{
+    const qsizetype size = qsizetype(bytesPerLine(rendered)) * rendered.height;
+
+    Glyph *copy = new Glyph;
+    copy->x = rendered.x;
+    copy->y = rendered.y;
+    copy->width = rendered.width;
+    copy->height = rendered.height;
+    copy->advance = rendered.advance;
+    copy->format = rendered.format;
+    if (size > 0 && rendered.data) {
+        copy->data.reset(new uchar[size]);
+        memcpy(copy->data.get(), rendered.data, size);
+    }
+    copy->cost = size + qsizetype(sizeof(Glyph));
+    GlyphPointer result(copy);
+
+    const Key key = { fontId, glyph, subPixelPosition.x.value(), subPixelPosition.y.value() };
+    Shard &shard = shardFor(key);
+
+    QWriteLocker locker(&shard.lock);
+    const auto r = shard.glyphs.tryEmplace(key, result);
+    if (!r.inserted)
+        return *r.iterator;
+    copy->lastUse.storeRelaxed(++shard.clock);
+    shard.cost += copy->cost;
+    shard.insertions.fetchAndAddRelaxed(1);
+    if (shard.cost > m_maximumCost.loadRelaxed() / ShardCount)
+        evict(shard);
+    return result;
+}
+
+// Called with the write lock of shard held.
+void QSharedGlyphCache::evict(Shard &shard)
+{
+    struct Use
+    {
+        quint32 age;
+        Key key;
+    };
+    const quint32 now = shard.clock;
+    QList<Use> uses;
+    uses.reserve(shard.glyphs.size());
+    for (auto it = shard.glyphs.cbegin(); it != shard.glyphs.cend(); ++it)
+        uses.append({ now - it.value()->lastUse.loadRelaxed(), it.key() });
+    std::sort(uses.begin(), uses.end(), [](const Use &a, const Use &b) { return a.age > b.age; });
+
+    const qsizetype target = m_maximumCost.loadRelaxed() / ShardCount * 3 / 4;
+    for (const Use &use : std::as_const(uses)) {
+        if (shard.cost <= target)
+            break;
+        const auto it = shard.glyphs.constFind(use.key);
+        shard.cost -= it.value()->cost;
+        shard.glyphs.erase(it);
+        shard.evictions.fetchAndAddRelaxed(1);
+    }
+}
+
+/*!
+    Sets the number of bytes the cached glyphs may use to \a bytes.
+*/
+void QSharedGlyphCache::setMaximumCost(qsizetype bytes)
+{
+    m_maximumCost.storeRelaxed(bytes);
+    for (Shard &shard : m_shards) {
+        QWriteLocker locker(&shard.lock);
+        if (shard.cost > bytes / ShardCount)
+            evict(shard);
+    }
+}
+
+qsizetype QSharedGlyphCache::maximumCost() const
+{
+    return m_maximumCost.loadRelaxed();
+}
+
+/*!
+    Returns the hit, miss, insertion and eviction counters of the cache
+    together with its current size.
+*/
+QSharedGlyphCache::Statistics QSharedGlyphCache::statistics() const
+{
+    Statistics statistics;
+    for (const Shard &shard : m_shards) {
+        statistics.hits += shard.hits.loadRelaxed();
+        statistics.misses += shard.misses.loadRelaxed();
+        statistics.insertions += shard.insertions.loadRelaxed();
+        statistics.evictions += shard.evictions.loadRelaxed();
+        QReadLocker locker(&shard.lock);
+        statistics.glyphCount += shard.glyphs.size();
+        statistics.cost += shard.cost;
+    }
+    return statistics;
+}
+
+/*!
+    Removes all glyphs from the cache. The counters are kept.
+*/
+void QSharedGlyphCache::clear()
+{
+    for (Shard &shard : m_shards) {
+        QWriteLocker locker(&shard.lock);
+        shard.glyphs.clear();
+        shard.cost = 0;
+    }
+}
+
+/*!
+    Returns the number of bytes per line of the bitmap of \a glyph.
+*/
+int QSharedGlyphCache::bytesPerLine(const QFontEngine::Glyph &glyph)
+{
+    switch (glyph.format) {
+    case QFontEngine::Format_Mono:
+        return ((glyph.width + 31) & ~31) >> 3;
+    case QFontEngine::Format_A8:
+        return (glyph.width + 3) & ~3;
+    case QFontEngine::Format_A32:
+    case QFontEngine::Format_ARGB:
+        return glyph.width * 4;
+    default:
+        return 0;
+    }
+}
+
+QT_END_NAMESPACE
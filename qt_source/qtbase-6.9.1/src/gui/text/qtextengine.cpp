@@ -20,6 +20,7 @@
 #include "qtextdocument_p.h"
 #include "qrawfont.h"
 #include "qrawfont_p.h"
+#include "qtextshapingcache_p.h"
 #include <qguiapplication.h>
 #include <qinputmethod.h>
 #include <algorithm>
@@ -1435,6 +1436,44 @@ void QTextEngine::shapeText(int item) const
             letterSpacing *= font.d->dpi / qt_defaultDpiY();
     }
 
+    // short items are likely to be shaped again, look for the result of a previous run
+    QTextShapingCache::Key cacheKey;
+    const bool useShapingCache = itemLength <= QTextShapingCache::MaximumLength
+            && QTextShapingCache::maximumCost() > 0;
+    if (useShapingCache) {
+        cacheKey.fontEngine = fontEngine->cacheKey();
+        cacheKey.text = QString::fromRawData(reinterpret_cast<const QChar *>(string), itemLength);
+        cacheKey.analysis = si.analysis;
+#if QT_CONFIG(harfbuzz)
+        cacheKey.kerning = kerningEnabled;
+#endif
+        cacheKey.shaping = shapingEnabled;
+        cacheKey.letterSpacingIsAbsolute = letterSpacingIsAbsolute;
+        cacheKey.designMetrics = option.useDesignMetrics();
+        cacheKey.showDefaultIgnorables = option.flags() & QTextOption::ShowDefaultIgnorables;
+        cacheKey.letterSpacing = letterSpacing;
+        cacheKey.wordSpacing = wordSpacing;
+        cacheKey.features = features;
+        cacheKey.featuresHash = QTextShapingCache::featuresHash(features);
+
+        if (const QTextShapingCache::Entry *entry = QTextShapingCache::instance()->find(cacheKey)) {
+            if (Q_UNLIKELY(!ensureSpace(entry->numGlyphs))) {
+                Q_UNREACHABLE_RETURN(); // ### report OOM error somehow
+            }
+            si.num_glyphs = entry->numGlyphs;
+            QGlyphLayout cachedGlyphs = entry->glyphs();
+            QGlyphLayout glyphs = shapedGlyphs(&si);
+            glyphs.copy(&cachedGlyphs);
+            memcpy(logClusters(&si), entry->logClusters.constData(), itemLength * sizeof(ushort));
+            si.width = entry->width;
+            si.ascent = entry->ascent;
+            si.descent = entry->descent;
+            si.leading = entry->leading;
+            layoutData->used += si.num_glyphs;
+            return;
+        }
+    }
+
     // split up the item into parts that come from different font engines
     // k * 3 entries, array[k] == index in string, array[k + 1] == index in glyphs, array[k + 2] == engine index
     QVarLengthArray<uint, 24> itemBoundaries;
@@ -1589,6 +1628,11 @@ void QTextEngine::shapeText(int item) const
 
     for (int i = 0; i < si.num_glyphs; ++i)
         si.width += glyphs.advances[i] * !glyphs.attributes[i].dontPrint;
+
+    if (useShapingCache) {
+        QTextShapingCache::instance()->insert(cacheKey, glyphs, logClusters(&si), si.width,
+                                              si.ascent, si.descent, si.leading);
+    }
 }
 
 #if QT_CONFIG(harfbuzz)
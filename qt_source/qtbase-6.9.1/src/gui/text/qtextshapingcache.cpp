@@ -0,0 +1,223 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qtextshapingcache_p.h"
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qthreadstorage.h>
+
+#include <algorithm>
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QTextShapingCache
+    \internal
+    \inmodule QtGui
+
+    \brief The QTextShapingCache class remembers the shaping of short text
+    items.
+
+    Labels, menus and tables shape the same short strings over and over, for
+    painting as well as for QFontMetrics, and every time QTextEngine runs
+    the string through HarfBuzz. The shaping cache keeps the outcome of
+    QTextEngine::shapeText() for items of at most MaximumLength characters,
+    keyed by the font engine, the text and everything else that influences
+    the glyphs and advances, so that shaping a string again amounts to a
+    hash lookup and a copy.
+
+    Font engines belong to the thread that created them, so every thread has
+    its own cache and no locking is needed. Entries identify their font
+    engine by QFontEngine::cacheKey(), which is never reused, rather than
+    holding a reference to it: the cache must not keep QFontCache from
+    releasing engines. The entries of an engine that was deleted can no
+    longer be hit and age out of the cache like any other. The cache of a
+    thread is cleared together with its font cache.
+
+    When the entries of a thread cost more than maximumCost() bytes, the
+    least recently used entries are evicted until the cache is down to three
+    quarters of its budget. A budget of zero disables the cache.
+*/
+
+Q_GLOBAL_STATIC(QThreadStorage<QTextShapingCache *>, theShapingCache)
+
+Q_CONSTINIT static QBasicAtomicInteger<qsizetype> shaping_cache_max_cost = Q_BASIC_ATOMIC_INITIALIZER(1024 * 1024);
+Q_CONSTINIT static QBasicAtomicInteger<quint64> shaping_cache_hits = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInteger<quint64> shaping_cache_misses = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInteger<quint64> shaping_cache_insertions = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInteger<quint64> shaping_cache_evictions = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInteger<qsizetype> shaping_cache_entries = Q_BASIC_ATOMIC_INITIALIZER(0);
+Q_CONSTINIT static QBasicAtomicInteger<qsizetype> shaping_cache_cost = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+QTextShapingCache::QTextShapingCache()
+{
+}
+
+QTextShapingCache::~QTextShapingCache()
+{
+    clear();
+}
+
+/*!
+    Returns the shaping cache of the calling thread.
+*/
+QTextShapingCache *QTextShapingCache::instance()
+{
+    QTextShapingCache *&cache = theShapingCache()->localData();
+    if (!cache)
+        cache = new QTextShapingCache;
+    return cache;
+}
+
+/*!
+    Removes all entries from the shaping cache of the calling thread, if it
+    has one.
+*/
+void QTextShapingCache::clearForCurrentThread()
+{
+    if (theShapingCache.isDestroyed() || !theShapingCache()->hasLocalData())
+        return;
+    theShapingCache()->localData()->clear();
+}
+
+/*!
+    Returns a hash of \a features that does not depend on their order.
+*/
+size_t QTextShapingCache::featuresHash(const QHash<QFont::Tag, quint32> &features)
+{
+    size_t hash = 0;
+    for (auto it = features.cbegin(); it != features.cend(); ++it)
+        hash += qHashMulti(0, it.key().value(), it.value());
+    return hash;
+}
+
+/*!
+    Returns the entry for \a key, or \nullptr if the item has to be shaped.
+    The entry stays valid until the next call to insert() or clear().
+*/
+const QTextShapingCache::Entry *QTextShapingCache::find(const Key &key)
+{
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        shaping_cache_misses.fetchAndAddRelaxed(1);
+        return nullptr;
+    }
+    shaping_cache_hits.fetchAndAddRelaxed(1);
+    it->lastUse = ++m_clock;
+    return &it.value();
+}
+
+/*!
+    Stores a copy of \a glyphs and \a logClusters, one for every character
+    of the text of \a key, together with the \a width, \a ascent, \a descent
+    and \a leading of the item as the shaping of \a key.
+*/
+void QTextShapingCache::insert(const Key &key, const QGlyphLayout &glyphs,
+                               const ushort *logClusters, QFixed width, QFixed ascent,
+                               QFixed descent, QFixed leading)
+{
+    const qsizetype maxCost = shaping_cache_max_cost.loadRelaxed();
+    if (maxCost <= 0 || m_entries.contains(key))
+        return;
+
+    Entry entry;
+    entry.numGlyphs = glyphs.numGlyphs;
+    entry.glyphData.resize(qsizetype(glyphs.numGlyphs) * QGlyphLayout::SpaceNeeded);
+    QGlyphLayout copy(entry.glyphData.data(), glyphs.numGlyphs);
+    QGlyphLayout source = glyphs;
+    copy.copy(&source);
+    entry.logClusters.resize(key.text.size());
+    memcpy(entry.logClusters.data(), logClusters, key.text.size() * sizeof(ushort));
+    entry.width = width;
+    entry.ascent = ascent;
+    entry.descent = descent;
+    entry.leading = leading;
+    entry.cost = entry.glyphData.size() + entry.logClusters.size() * qsizetype(sizeof(ushort))
+            + key.text.size() * qsizetype(sizeof(QChar)) + qsizetype(sizeof(Key) + sizeof(Entry));
+    entry.lastUse = ++m_clock;
+
+    m_cost += entry.cost;
+    shaping_cache_cost.fetchAndAddRelaxed(entry.cost);
+    shaping_cache_entries.fetchAndAddRelaxed(1);
+    shaping_cache_insertions.fetchAndAddRelaxed(1);
+    // The text of a lookup key usually refers to the layout's string.
+    Key stored = key;
+    stored.text = QString(key.text.constData(), key.text.size());
+    m_entries.insert(std::move(stored), std::move(entry));
+
+    if (m_cost > maxCost)
+        evict();
+}
+
+void QTextShapingCache::remove(QHash<Key, Entry>::iterator it)
+{
+    m_cost -= it->cost;
+    shaping_cache_cost.fetchAndSubRelaxed(it->cost);
+    shaping_cache_entries.fetchAndSubRelaxed(1);
+    m_entries.erase(it);
+}
+
+void QTextShapingCache::evict()
+{
+    struct Use
+    {
+        quint32 age;
+        Key key;
+    };
+    QList<Use> uses;
+    uses.reserve(m_entries.size());
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+        uses.append({ m_clock - it->lastUse, it.key() });
+    std::sort(uses.begin(), uses.end(), [](const Use &a, const Use &b) { return a.age > b.age; });
+
+    const qsizetype target = shaping_cache_max_cost.loadRelaxed() * 3 / 4;
+    for (const Use &use : std::as_const(uses)) {
+        if (m_cost <= target)
+            break;
+        remove(m_entries.find(use.key));
+        shaping_cache_evictions.fetchAndAddRelaxed(1);
+    }
+}
+
+/*!
+    Removes all entries. The counters are kept.
+*/
+void QTextShapingCache::clear()
+{
+    while (!m_entries.isEmpty())
+        remove(m_entries.begin());
+    m_clock = 0;
+}
+
+/*!
+    Sets the number of bytes the entries of each thread may use to \a bytes.
+    The budget is enforced on the next insertion; zero disables the cache.
+*/
+void QTextShapingCache::setMaximumCost(qsizetype bytes)
+{
+    shaping_cache_max_cost.storeRelaxed(bytes);
+}
+
+qsizetype QTextShapingCache::maximumCost()
+{
+    return shaping_cache_max_cost.loadRelaxed();
+}
+
+/*!
+    Returns the hit, miss, insertion and eviction counters together with
+    the number and cost of the entries, summed over all threads.
+*/
+QTextShapingCache::Statistics QTextShapingCache::statistics()
+{
+    Statistics statistics;
+    statistics.hits = shaping_cache_hits.loadRelaxed();
+    statistics.misses = shaping_cache_misses.loadRelaxed();
+    statistics.insertions = shaping_cache_insertions.loadRelaxed();
+    statistics.evictions = shaping_cache_evictions.loadRelaxed();
+    statistics.entryCount = shaping_cache_entries.loadRelaxed();
+    statistics.cost = shaping_cache_cost.loadRelaxed();
+    return statistics;
+}
+
+QT_END_NAMESPACE
@@ -461,6 +461,16 @@
     ItemClipsChildrenToShape.
 
     This flag was introduced in Qt 5.4.
+
+    \value [since 6.10] ItemHasThreadSafePaint The item's paint() function may
+    be called from any thread, concurrently with itself and with other
+    items, and has no side effects besides drawing. It must only read the
+    item's state and draw with the default composition mode. QGraphicsView
+    may then paint the item together with other such items on a thread
+    pool, each thread into its own tile, and composite the tiles in
+    stacking order. Only items without children, cache mode, graphics
+    effect or clipping, and whose ancestors do not clip them, are painted
+    this way. The flag is disabled by default.
 */
 
 /*!
@@ -905,6 +915,7 @@ QGraphicsItemPrivate::QGraphicsItemPrivate()
       mayHaveChildWithGraphicsEffect(false),
       sendParentChangeNotification(false),
       dirtyChildrenBoundingRect(true),
+      pendingTransactionGeometry(false),
       globalStackingOrder(-1),
       q_ptr(nullptr)
 {
@@ -7462,9 +7473,22 @@ void QGraphicsItem::prepareGeometryChange()
 
         QGraphicsScenePrivate *scenePrivate = d_ptr->scene->d_func();
         scenePrivate->index->prepareBoundingRectChange(this);
+
+        // Inside a transaction, an item whose dirty state has not been
+        // processed since it was marked is not marked again, and its old
+        // geometry is not updated again. Processing the dirty items clears
+        // the flag, so the next change marks the item once more.
+        const bool inTransaction = scenePrivate->transactionDepth > 0;
+        if (inTransaction && d_ptr->pendingTransactionGeometry) {
+            d_ptr->markParentDirty(/*updateBoundingRect=*/true);
+            return;
+        }
+
         scenePrivate->markDirty(this, QRectF(), /*invalidateChildren=*/true, /*force=*/false,
                                 /*ignoreOpacity=*/ false, /*removingItemFromScene=*/ false,
                                 /*updateBoundingRect=*/true);
+        if (inTransaction)
+            d_ptr->pendingTransactionGeometry = d_ptr->dirty || d_ptr->dirtyChildren;
 
         // For compatibility reasons, we have to update the item's old geometry
         // if someone is connected to the changed signal or the scene has no views.
@@ -11377,6 +11401,9 @@ QDebug operator<<(QDebug debug, QGraphicsItem::GraphicsItemFlag flag)
     case QGraphicsItem::ItemContainsChildrenInShape:
         str = "ItemContainsChildrenInShape";
         break;
+    case QGraphicsItem::ItemHasThreadSafePaint:
+        str = "ItemHasThreadSafePaint";
+        break;
     }
     debug << str;
     return debug;
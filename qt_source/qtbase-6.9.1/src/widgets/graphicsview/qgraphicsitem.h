@@ -66,7 +66,8 @@ public:
         ItemSendsScenePositionChanges = 0x10000,
         ItemStopsClickFocusPropagation = 0x20000,
         ItemStopsFocusHandling = 0x40000,
-        ItemContainsChildrenInShape = 0x80000
+        ItemContainsChildrenInShape = 0x80000,
+        ItemHasThreadSafePaint = 0x100000
         // NB! Don't forget to increase the d_ptr->flags bit field by 1 when adding a new flag.
     };
     Q_DECLARE_FLAGS(GraphicsItemFlags, GraphicsItemFlag)
@@ -421,6 +422,8 @@ private:
     friend class QGraphicsSceneIndexPrivate;
     friend class QGraphicsSceneBspTreeIndex;
     friend class QGraphicsSceneBspTreeIndexPrivate;
+    friend class QGraphicsSceneRTreeIndex;
+    friend class QGraphicsSceneRTreeIndexPrivate;
     friend class QGraphicsItemEffectSourcePrivate;
     friend class QGraphicsTransformPrivate;
 #ifndef QT_NO_GESTURES
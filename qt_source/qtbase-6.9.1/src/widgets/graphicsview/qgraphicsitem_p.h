@@ -388,7 +388,7 @@ public:
     quint32 fullUpdatePending : 1;
 
     // Packed 32 bits
-    quint32 flags : 20;
+    quint32 flags : 21;
     quint32 paintedViewBoundingRectsNeedRepaint : 1;
     quint32 dirtySceneTransform : 1;
     quint32 geometryChanged : 1;
@@ -400,11 +400,11 @@ public:
     quint32 acceptedTouchBeginEvent : 1;
     quint32 filtersDescendantEvents : 1;
     quint32 sceneTransformTranslateOnly : 1;
-    quint32 notifyBoundingRectChanged : 1;
 #ifdef Q_OS_WASM
     unsigned char :0; //this aligns 64bit field for wasm see QTBUG-65259
 #endif
     // New 32 bits
+    quint32 notifyBoundingRectChanged : 1;
     quint32 notifyInvalidated : 1;
     quint32 mouseSetsFocus : 1;
     quint32 explicitActivate : 1;
@@ -417,7 +417,8 @@ public:
     quint32 mayHaveChildWithGraphicsEffect : 1;
     quint32 sendParentChangeNotification : 1;
     quint32 dirtyChildrenBoundingRect : 1;
-    quint32 padding : 20;
+    quint32 pendingTransactionGeometry : 1;
+    quint32 padding : 17;
 
     // Optional stacking order
     int globalStackingOrder;
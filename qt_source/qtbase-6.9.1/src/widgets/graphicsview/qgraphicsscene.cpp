@@ -157,6 +157,13 @@
     removing items is logarithmic. This approach is best for static scenes
     (i.e., scenes where most items do not move).
 
+    \value [since 6.10] RTreeIndex An R-tree of the items' bounding rectangles
+    is applied. Item location is of logarithmic complexity and does not depend
+    on the scene rectangle. Items that move are updated in place instead of
+    being reindexed, and items that are added in bulk are packed into the tree
+    in one go. This approach suits very large scenes, and scenes whose items
+    move or whose scene rectangle grows.
+
     \value NoIndex No index is applied. Item location is of linear complexity,
     as all items on the scene are searched. Adding, moving and removing items,
     however, is done in constant time. This approach is ideal for dynamic
@@ -179,6 +186,7 @@
 #include "qgraphicssceneindex_p.h"
 #include "qgraphicsscenebsptreeindex_p.h"
 #include "qgraphicsscenelinearindex_p.h"
+#include "qgraphicsscenertreeindex_p.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qlist.h>
@@ -214,8 +222,14 @@
 #endif
 #include <private/qgesturemanager_p.h>
 #include <private/qpathclipper_p.h>
+#include <QtGui/private/qguiapplication_p.h>
 
 #include <QtCore/qpointer.h>
+#if QT_CONFIG(qtgui_threadpool)
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/private/qthreadpool_p.h>
+#endif
 
 // #define GESTURE_DEBUG
 #ifndef GESTURE_DEBUG
@@ -554,6 +568,8 @@ void QGraphicsScenePrivate::removeItemHelper(QGraphicsItem *item)
     markDirty(item, QRectF(), /*invalidateChildren=*/false, /*force=*/false,
               /*ignoreOpacity=*/false, /*removingItemFromScene=*/true);
 
+    item->d_ptr->pendingTransactionGeometry = 0;
+
     if (item->d_ptr->inDestructor) {
         // The item is actually in its destructor, we call the special method in the index.
         index->deleteItem(item);
@@ -1846,10 +1862,14 @@ void QGraphicsScene::setItemIndexMethod(ItemIndexMethod method)
     delete d->index;
     if (method == BspTreeIndex)
         d->index = new QGraphicsSceneBspTreeIndex(this);
+    else if (method == RTreeIndex)
+        d->index = new QGraphicsSceneRTreeIndex(this);
     else
         d->index = new QGraphicsSceneLinearIndex(this);
     for (int i = oldItems.size() - 1; i >= 0; --i)
         d->index->addItem(oldItems.at(i));
+    if (d->transactionDepth > 0)
+        d->index->beginTransaction();
 }
 
 /*!
@@ -1906,6 +1926,66 @@ void QGraphicsScene::setBspTreeDepth(int depth)
     bspTree->setBspTreeDepth(depth);
 }
 
+/*!
+    \since 6.10
+
+    Opens a transaction on the scene. Until the matching endTransaction(),
+    changes to the items' geometry and requests to update whole items are
+    collected instead of being processed one by one: the scene's index is
+    not kept up to date for every move, and an item that changes many
+    times is only scheduled for repainting once. Use a transaction when
+    many items change at the same time, for example when thousands of
+    items are moved or restyled together.
+
+    Queries such as items() and itemAt() remain correct inside a
+    transaction, but they may have to bring the index up to date first and
+    are therefore best made after it ends.
+
+    Transactions can be nested; the changes are committed when the
+    outermost transaction ends.
+
+    \sa endTransaction(), isInTransaction()
+*/
+void QGraphicsScene::beginTransaction()
+{
+    Q_D(QGraphicsScene);
+    if (d->transactionDepth++ == 0)
+        d->index->beginTransaction();
+}
+
+/*!
+    \since 6.10
+
+    Ends the transaction opened by the matching call to beginTransaction().
+    When the outermost transaction ends, the scene's index is updated.
+
+    \sa beginTransaction(), isInTransaction()
+*/
+void QGraphicsScene::endTransaction()
+{
+    Q_D(QGraphicsScene);
+    if (d->transactionDepth == 0) {
+        qWarning("QGraphicsScene::endTransaction: no transaction has been started");
+        return;
+    }
+    if (--d->transactionDepth == 0)
+        d->index->endTransaction();
+}
+
+/*!
+    \since 6.10
+
+    Returns \c true if a transaction has been opened with
+    beginTransaction() and not ended yet; otherwise returns \c false.
+
+    \sa beginTransaction(), endTransaction()
+*/
+bool QGraphicsScene::isInTransaction() const
+{
+    Q_D(const QGraphicsScene);
+    return d->transactionDepth > 0;
+}
+
 /*!
     Calculates and returns the bounding rect of all items on the scene. This
     function works by iterating over all items, and because of this, it can
@@ -4621,8 +4701,161 @@ void QGraphicsScenePrivate::drawItems(QPainter *painter, const QTransform *const
             exposedSceneRect = viewTransform->inverted().mapRect(exposedSceneRect);
     }
     const QList<QGraphicsItem *> tli = index->estimateTopLevelItems(exposedSceneRect, Qt::AscendingOrder);
+
+    // Items with thread-safe paint functions are painted into raster tiles,
+    // which does not suit vector devices such as printers.
+    const int devType = painter->device()->devType();
+    if (devType == QInternal::Widget || devType == QInternal::Image || devType == QInternal::Pixmap) {
+        deferredPaintPainter = painter;
+        deferredPaintExposedRegion = exposedRegion;
+        deferredPaintWidget = widget;
+    }
     for (const auto subTree : tli)
         drawSubtreeRecursive(subTree, painter, viewTransform, exposedRegion, widget);
+    flushDeferredPaints();
+    deferredPaintPainter = nullptr;
+    deferredPaintExposedRegion = nullptr;
+    deferredPaintWidget = nullptr;
+}
+
+/*!
+    \internal
+
+    Paints the items that were deferred by draw(), in their stacking order.
+    When there are enough of them, they cover enough pixels and the device
+    pixel ratio is integral, the exposed part of their bounding rectangle
+    is split into bands. The GUI thread
+    pool paints each band into a transparent image the size of the part of
+    the band that the items cover, and the images are then drawn onto the
+    painter.
+*/
+void QGraphicsScenePrivate::flushDeferredPaints()
+{
+    if (deferredPaints.isEmpty())
+        return;
+
+    QPainter *painter = deferredPaintPainter;
+    const QList<DeferredPaint> paints = std::move(deferredPaints);
+    deferredPaints.clear();
+
+    const auto initOption = [](QStyleOptionGraphicsItem *option, const DeferredPaint &paint) {
+        option->state = paint.state;
+        option->rect = paint.rect;
+        option->exposedRect = paint.exposedRect;
+        option->styleObject = paint.styleObject;
+    };
+
+    int segments = 1;
+#if QT_CONFIG(qtgui_threadpool)
+    QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    constexpr qsizetype MinimumParallelItems = 32;
+    // Tiles are drawn back at logical positions, which only fall on device
+    // pixels with an integral device pixel ratio; otherwise they would be
+    // resampled.
+    const qreal dpr = painter->device()->devicePixelRatio();
+    QRect bounds;
+    if (threadPool && !threadPool->contains(QThread::currentThread())
+        && paints.size() >= MinimumParallelItems && dpr == qFloor(dpr)) {
+        const QRect exposed = deferredPaintExposedRegion
+                ? deferredPaintExposedRegion->boundingRect() : QRect();
+        // Each band paints about 64K pixels of items; few or small items
+        // are painted directly.
+        qint64 area = 0;
+        for (const DeferredPaint &paint : paints) {
+            const QRect rect = deferredPaintExposedRegion
+                    ? paint.viewBoundingRect & exposed : paint.viewBoundingRect;
+            area += qint64(rect.width()) * rect.height();
+            bounds |= rect;
+        }
+        segments = int(qMin<qint64>(area >> 16, bounds.height()));
+    }
+#endif
+
+    if (segments <= 1) {
+        QStyleOptionGraphicsItem &option = styleOptionTmp;
+        for (const DeferredPaint &paint : paints) {
+            painter->setWorldTransform(paint.transform);
+            if (painterStateProtection)
+                painter->save();
+            painter->setOpacity(paint.opacity);
+            initOption(&option, paint);
+            paint.item->paint(painter, &option, deferredPaintWidget);
+            if (painterStateProtection)
+                painter->restore();
+        }
+        return;
+    }
+
+#if QT_CONFIG(qtgui_threadpool)
+    const QPainter::RenderHints hints = painter->renderHints();
+    const QFont font = painter->font();
+    const QPen pen = painter->pen();
+    const QBrush brush = painter->brush();
+    QWidget *widget = deferredPaintWidget;
+    const QStyleOptionGraphicsItem &baseOption = styleOptionTmp;
+
+    QList<QRect> tileRects(segments);
+    int y = bounds.top();
+    for (int i = 0; i < segments; ++i) {
+        const int height = (bounds.bottom() + 1 - y) / (segments - i);
+        tileRects[i] = QRect(bounds.left(), y, bounds.width(), height);
+        y += height;
+    }
+
+    QList<QImage> tiles(segments);
+    QImage *tileData = tiles.data();
+    QRect *tileRectData = tileRects.data();
+    QSemaphore semaphore;
+    for (int i = 0; i < segments; ++i) {
+        threadPool->start([&, i]() {
+            // The tile only covers the part of the band the items are in.
+            const QRect band = tileRectData[i];
+            QRect tileRect;
+            for (const DeferredPaint &paint : paints)
+                tileRect |= paint.viewBoundingRect & band;
+            tileRectData[i] = tileRect;
+            QImage tile;
+            if (!tileRect.isEmpty()) {
+                tile = QImage(tileRect.size() * dpr, QImage::Format_ARGB32_Premultiplied);
+            }
+            if (!tile.isNull()) {
+                QStyleOptionGraphicsItem option = baseOption;
+                tile.setDevicePixelRatio(dpr);
+                tile.fill(Qt::transparent);
+                QPainter tilePainter(&tile);
+                tilePainter.setRenderHints(hints);
+                tilePainter.setFont(font);
+                tilePainter.setPen(pen);
+                tilePainter.setBrush(brush);
+                const QTransform offset = QTransform::fromTranslate(-tileRect.x(), -tileRect.y());
+                for (const DeferredPaint &paint : paints) {
+                    if (!paint.viewBoundingRect.intersects(tileRect))
+                        continue;
+                    tilePainter.setWorldTransform(paint.transform * offset);
+                    tilePainter.save();
+                    tilePainter.setOpacity(paint.opacity);
+                    initOption(&option, paint);
+                    paint.item->paint(&tilePainter, &option, widget);
+                    tilePainter.restore();
+                }
+                tilePainter.end();
+                tileData[i] = std::move(tile);
+            }
+            semaphore.release(1);
+        });
+    }
+    semaphore.acquire(segments);
+
+    painter->save();
+    painter->setWorldTransform(QTransform());
+    painter->setOpacity(1.0);
+    painter->setCompositionMode(QPainter::CompositionMode_SourceOver);
+    for (int i = 0; i < segments; ++i) {
+        if (!tiles.at(i).isNull())
+            painter->drawImage(tileRects.at(i).topLeft(), tiles.at(i));
+    }
+    painter->restore();
+#endif
 }
 
 void QGraphicsScenePrivate::drawSubtreeRecursive(QGraphicsItem *item, QPainter *painter,
@@ -4729,6 +4962,9 @@ void QGraphicsScenePrivate::drawSubtreeRecursive(QGraphicsItem *item, QPainter *
         QGraphicsEffectSource *source = item->d_ptr->graphicsEffect->d_func()->source;
         QGraphicsItemEffectSourcePrivate *sourced = static_cast<QGraphicsItemEffectSourcePrivate *>
                                                     (source->d_func());
+        // The effect draws its source on its own terms; nothing inside it is deferred.
+        flushDeferredPaints();
+        QPainter *const oldDeferredPaintPainter = std::exchange(deferredPaintPainter, nullptr);
         sourced->info = &info;
         const QTransform restoreTransform = painter->worldTransform();
         if (effectTransform)
@@ -4757,6 +4993,7 @@ void QGraphicsScenePrivate::drawSubtreeRecursive(QGraphicsItem *item, QPainter *
         item->d_ptr->graphicsEffect->draw(painter);
         painter->setWorldTransform(restoreTransform);
         sourced->info = nullptr;
+        deferredPaintPainter = oldDeferredPaintPainter;
     } else
 #endif // QT_CONFIG(graphicseffect)
     {
@@ -4798,6 +5035,26 @@ void QGraphicsScenePrivate::draw(QGraphicsItem *item, QPainter *painter, const Q
     const bool itemHasChildren = !children.isEmpty();
     bool setChildClip = itemClipsChildrenToShape;
     bool itemHasChildrenStackedBehind = false;
+    static int drawRect = qEnvironmentVariableIntValue("QT_DRAW_SCENE_ITEM_RECTS");
+
+    if (drawItem && painter == deferredPaintPainter && !itemHasChildren && !drawRect
+        && (item->d_ptr->flags & QGraphicsItem::ItemHasThreadSafePaint)
+        && !(item->d_ptr->flags & QGraphicsItem::ItemClipsToShape)
+        && !(item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren)
+        && !item->d_ptr->cacheMode && !item->d_ptr->isWidget && !effectTransform) {
+        Q_ASSERT(transformPtr);
+        item->d_ptr->initStyleOption(&styleOptionTmp, *transformPtr, exposedRegion
+                                     ? *exposedRegion : QRegion(), exposedRegion == nullptr);
+        QRect viewBoundingRect = transformPtr->mapRect(adjustedItemEffectiveBoundingRect(item)).toAlignedRect();
+        viewBoundingRect.adjust(-int(rectAdjust), -int(rectAdjust), rectAdjust, rectAdjust);
+        deferredPaints.append({ item, *transformPtr, opacity, viewBoundingRect, styleOptionTmp.state,
+                                styleOptionTmp.rect, styleOptionTmp.exposedRect,
+                                styleOptionTmp.styleObject });
+        return;
+    }
+    // Everything painted from here on goes on top of the deferred items.
+    if (drawItem || itemClipsChildrenToShape)
+        flushDeferredPaints();
 
     int i = 0;
     if (itemHasChildren) {
@@ -4877,7 +5134,6 @@ void QGraphicsScenePrivate::draw(QGraphicsItem *item, QPainter *painter, const Q
         if (painterStateProtection || restorePainterClip)
             painter->restore();
 
-        static int drawRect = qEnvironmentVariableIntValue("QT_DRAW_SCENE_ITEM_RECTS");
         if (drawRect) {
             QPen oldPen = painter->pen();
             QBrush oldBrush = painter->brush();
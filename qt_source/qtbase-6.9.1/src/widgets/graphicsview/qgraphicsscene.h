@@ -72,6 +72,7 @@ class Q_WIDGETS_EXPORT QGraphicsScene : public QObject
 public:
     enum ItemIndexMethod {
         BspTreeIndex,
+        RTreeIndex,
         NoIndex = -1
     };
     Q_ENUM(ItemIndexMethod)
@@ -105,6 +106,10 @@ public:
     int bspTreeDepth() const;
     void setBspTreeDepth(int depth);
 
+    void beginTransaction();
+    void endTransaction();
+    bool isInTransaction() const;
+
     QRectF itemsBoundingRect() const;
 
     QList<QGraphicsItem *> items(Qt::SortOrder order = Qt::DescendingOrder) const;
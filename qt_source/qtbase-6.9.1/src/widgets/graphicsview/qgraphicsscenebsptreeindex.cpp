@@ -66,6 +66,8 @@ QGraphicsSceneBspTreeIndexPrivate::QGraphicsSceneBspTreeIndexPrivate(QGraphicsSc
     regenerateIndex(true),
     lastItemCount(0),
     purgePending(false),
+    inTransaction(false),
+    staleTree(false),
     sortCacheEnabled(false),
     updatingSortCache(false)
 {
@@ -163,6 +165,25 @@ void QGraphicsSceneBspTreeIndexPrivate::purgeRemovedItems()
     purgePending = false;
 }
 
+/*!
+    \internal
+
+    Reinserts the items that were moved without being removed from the tree
+    during a scene transaction, or regenerates the tree if there were many.
+*/
+void QGraphicsSceneBspTreeIndexPrivate::regenerateStaleTree()
+{
+    if (staleTree) {
+        staleTree = false;
+        movedItems.clear();
+        resetIndex();
+        return;
+    }
+    // removeItem() takes the item out of movedItems.
+    while (!movedItems.isEmpty())
+        removeItem(movedItems.cbegin().key(), /*recursive=*/false, /*moveToUnindexedItems=*/true);
+}
+
 /*!
     \internal
 
@@ -299,6 +320,13 @@ void QGraphicsSceneBspTreeIndexPrivate::removeItem(QGraphicsItem *item, bool rec
     if (!item)
         return;
 
+    // An item moved in a transaction is still in the leaves of its old rect.
+    const auto moved = movedItems.constFind(item);
+    const bool wasMoved = moved != movedItems.cend();
+    const QRectF movedRect = wasMoved ? *moved : QRectF();
+    if (wasMoved)
+        movedItems.erase(moved);
+
     if (item->d_ptr->index != -1) {
         Q_ASSERT(item->d_ptr->index < indexedItems.size());
         Q_ASSERT(indexedItems.at(item->d_ptr->index) == item);
@@ -309,13 +337,14 @@ void QGraphicsSceneBspTreeIndexPrivate::removeItem(QGraphicsItem *item, bool rec
 
         if (item->d_ptr->itemIsUntransformable()) {
             untransformableItems.removeOne(item);
-        } else if (item->d_ptr->inDestructor) {
-            // Avoid virtual function calls from the destructor.
+        } else if (item->d_ptr->inDestructor || staleTree) {
+            // Avoid virtual function calls from the destructor. A stale tree
+            // may hold the item in leaves its current rect no longer covers.
             purgePending = true;
             removedItems << item;
         } else if (!(item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
                      || item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren)) {
-            bsp.removeItem(item, item->d_ptr->sceneEffectiveBoundingRect());
+            bsp.removeItem(item, wasMoved ? movedRect : item->d_ptr->sceneEffectiveBoundingRect());
         }
     } else {
         unindexedItems.removeOne(item);
@@ -343,6 +372,7 @@ QList<QGraphicsItem *> QGraphicsSceneBspTreeIndexPrivate::estimateItems(const QR
     if (onlyTopLevelItems && rect.isNull())
         return q->QGraphicsSceneIndex::estimateTopLevelItems(rect, order);
 
+    regenerateStaleTree();
     purgeRemovedItems();
     _q_updateSortCache();
     Q_ASSERT(unindexedItems.isEmpty());
@@ -442,6 +472,8 @@ void QGraphicsSceneBspTreeIndex::clear()
     d->indexedItems.clear();
     d->unindexedItems.clear();
     d->untransformableItems.clear();
+    d->staleTree = false;
+    d->movedItems.clear();
     d->regenerateIndex = true;
 }
 
@@ -480,11 +512,50 @@ void QGraphicsSceneBspTreeIndex::prepareBoundingRectChange(const QGraphicsItem *
 
     Q_D(QGraphicsSceneBspTreeIndex);
     QGraphicsItem *thatItem = const_cast<QGraphicsItem *>(item);
+    if (d->inTransaction) {
+        // Remember the rect the item is in the tree with, and reinsert it
+        // once the transaction ends. Past an eighth of the index, the tree
+        // is regenerated instead; this also covers the children.
+        if (d->staleTree || d->movedItems.contains(thatItem))
+            return;
+        if (d->movedItems.size() >= qMax(d->indexedItems.size() / 8, 64)) {
+            d->staleTree = true;
+            d->movedItems.clear();
+            return;
+        }
+        d->movedItems.insert(thatItem, item->d_ptr->sceneEffectiveBoundingRect());
+        for (int i = 0; i < item->d_ptr->children.size(); ++i)
+            prepareBoundingRectChange(item->d_ptr->children.at(i));
+        return;
+    }
+
     d->removeItem(thatItem, /*recursive=*/false, /*moveToUnindexedItems=*/true);
     for (int i = 0; i < item->d_ptr->children.size(); ++i)  // ### Do we really need this?
         prepareBoundingRectChange(item->d_ptr->children.at(i));
 }
 
+/*!
+    \internal
+    Stops removing moved items from the BSP tree until endTransaction().
+*/
+void QGraphicsSceneBspTreeIndex::beginTransaction()
+{
+    Q_D(QGraphicsSceneBspTreeIndex);
+    d->inTransaction = true;
+}
+
+/*!
+    \internal
+    Reinserts the items that were moved during the transaction, or schedules
+    the regeneration of the BSP tree if there were many.
+*/
+void QGraphicsSceneBspTreeIndex::endTransaction()
+{
+    Q_D(QGraphicsSceneBspTreeIndex);
+    d->inTransaction = false;
+    d->regenerateStaleTree();
+}
+
 /*!
     Returns an estimation visible items that are either inside or
     intersect with the specified \a rect and return a list sorted using \a order.
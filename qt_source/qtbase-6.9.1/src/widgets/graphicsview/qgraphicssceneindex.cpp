@@ -587,6 +587,28 @@ void QGraphicsSceneIndex::prepareBoundingRectChange(const QGraphicsItem *item)
     Q_UNUSED(item);
 }
 
+/*!
+    Notify the index that the scene has opened a transaction, during which
+    many items may change their geometry. The index does not have to be
+    accurate for those items until the next query or until
+    endTransaction() is called. The default implementation does nothing.
+
+    \sa QGraphicsScene::beginTransaction()
+*/
+void QGraphicsSceneIndex::beginTransaction()
+{
+}
+
+/*!
+    Notify the index that the scene's transaction has been committed.
+    The default implementation does nothing.
+
+    \sa QGraphicsScene::endTransaction()
+*/
+void QGraphicsSceneIndex::endTransaction()
+{
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qgraphicssceneindex_p.cpp"
@@ -0,0 +1,445 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+/*!
+    \class QGraphicsSceneRTreeIndex
+    \brief The QGraphicsSceneRTreeIndex class provides an implementation of
+    an R-tree indexing algorithm for discovering items in QGraphicsScene.
+    \since 6.10
+    \ingroup graphicsview-api
+
+    \internal
+
+    QGraphicsSceneRTreeIndex keeps the scene bounding rectangles of the
+    items in an R-tree, a balanced tree of nested bounding rectangles, so
+    finding the items in a rectangle takes logarithmic time however the
+    items are distributed. Unlike the BSP tree, the R-tree does not depend
+    on the scene rectangle and never has to be rebuilt because the scene
+    grows.
+
+    Items that are added are collected and indexed together when control
+    returns to the event loop, or when the index is queried. When more items
+    arrive than the tree holds, as when a scene is populated, the whole tree
+    is packed anew with sort-tile-recursive packing; otherwise the items are
+    inserted one by one. Items that move are updated in place. Removing
+    items leaves the tree less tightly packed, so it is packed anew once
+    more items have been removed than it holds.
+
+    Untransformable items and items whose ancestors clip or contain their
+    children are kept outside the tree, as they are by the BSP tree index.
+
+    \sa QGraphicsScene, QGraphicsView, QGraphicsSceneIndex, QGraphicsSceneBspTreeIndex
+*/
+
+#include <QtCore/qglobal.h>
+
+#include <private/qgraphicsscene_p.h>
+#include <private/qgraphicsscenertreeindex_p.h>
+#include <private/qgraphicssceneindex_p.h>
+
+#include <QtCore/qdebug.h>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    Constructs a private scene R-tree index.
+*/
+QGraphicsSceneRTreeIndexPrivate::QGraphicsSceneRTreeIndexPrivate(QGraphicsScene *scene)
+    : QGraphicsSceneIndexPrivate(scene),
+    removalsSinceBuild(0)
+{
+}
+
+/*!
+    \internal
+
+    Brings the tree up to date: moves the items whose bounding rect has
+    changed and indexes the items that were added since the last update.
+*/
+void QGraphicsSceneRTreeIndexPrivate::updateIndex()
+{
+    indexTimer.stop();
+
+    for (QGraphicsItem *item : std::as_const(movedItems)) {
+        Q_ASSERT(item->d_ptr->index >= 0);
+        tree.update(item->d_ptr->index, item->d_ptr->sceneEffectiveBoundingRect());
+    }
+    movedItems.clear();
+
+    QList<QGraphicsItem *> newItems;
+    newItems.reserve(unindexedItems.size());
+    for (QGraphicsItem *item : std::as_const(unindexedItems)) {
+        if (item->d_ptr->itemIsUntransformable())
+            untransformableItems.insert(item);
+        else if (item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
+                 || item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren)
+            clippedItems.insert(item);
+        else
+            newItems << item;
+    }
+    unindexedItems.clear();
+
+    if (newItems.size() > tree.size() || removalsSinceBuild > tree.size()) {
+        rebuild(newItems);
+    } else {
+        for (QGraphicsItem *item : std::as_const(newItems))
+            item->d_ptr->index = tree.insert(item->d_ptr->sceneEffectiveBoundingRect(), item);
+    }
+}
+
+/*!
+    \internal
+
+    Packs the items in the tree together with \a newItems into a new tree.
+*/
+void QGraphicsSceneRTreeIndexPrivate::rebuild(const QList<QGraphicsItem *> &newItems)
+{
+    const qsizetype count = tree.size() + newItems.size();
+    QList<QRectF> rects;
+    QList<QGraphicsItem *> items;
+    rects.reserve(count);
+    items.reserve(count);
+    tree.forEach([&](const QRectF &rect, QGraphicsItem *item) {
+        rects << rect;
+        items << item;
+    });
+    for (QGraphicsItem *item : newItems) {
+        rects << item->d_ptr->sceneEffectiveBoundingRect();
+        items << item;
+    }
+
+    tree.bulkLoad(rects.constData(), items.constData(), count);
+    for (qsizetype i = 0; i < count; ++i)
+        items.at(i)->d_ptr->index = int(i);
+    removalsSinceBuild = 0;
+}
+
+/*!
+    \internal
+
+    Schedules an update of the index for when control returns to the event
+    loop.
+*/
+void QGraphicsSceneRTreeIndexPrivate::startIndexTimer()
+{
+    Q_Q(QGraphicsSceneRTreeIndex);
+    if (!indexTimer.isActive())
+        indexTimer.start(0ms, q);
+}
+
+/*!
+    \internal
+
+    Marks all items in the tree as not indexed.
+*/
+void QGraphicsSceneRTreeIndexPrivate::resetItemIndexes()
+{
+    tree.forEach([](const QRectF &, QGraphicsItem *item) {
+        Q_ASSERT(!item->d_ptr->itemDiscovered);
+        item->d_ptr->index = -1;
+    });
+}
+
+void QGraphicsSceneRTreeIndexPrivate::addItem(QGraphicsItem *item, bool recursive)
+{
+    if (!item)
+        return;
+
+    // Indexing requires sceneBoundingRect(), but because \a item might
+    // not be completely constructed at this point, we need to store it in
+    // a temporary set and schedule an indexing for later.
+    if (item->d_ptr->index == -1 && !unindexedItems.contains(item)) {
+        unindexedItems.insert(item);
+        startIndexTimer();
+    } else {
+        qWarning("QGraphicsSceneRTreeIndex::addItem: item has already been added to this index");
+    }
+
+    if (recursive) {
+        for (int i = 0; i < item->d_ptr->children.size(); ++i)
+            addItem(item->d_ptr->children.at(i), recursive);
+    }
+}
+
+void QGraphicsSceneRTreeIndexPrivate::removeItem(QGraphicsItem *item, bool recursive,
+                                                 bool moveToUnindexedItems)
+{
+    if (!item)
+        return;
+
+    // Removal does not need the bounding rect, so this is safe to do from
+    // the item's destructor.
+    if (item->d_ptr->index != -1) {
+        Q_ASSERT(tree.value(item->d_ptr->index) == item);
+        Q_ASSERT(!item->d_ptr->itemDiscovered);
+        tree.remove(item->d_ptr->index);
+        item->d_ptr->index = -1;
+        movedItems.remove(item);
+        if (++removalsSinceBuild > tree.size())
+            startIndexTimer();
+    } else if (!unindexedItems.remove(item) && !untransformableItems.remove(item)) {
+        clippedItems.remove(item);
+    }
+
+    Q_ASSERT(item->d_ptr->index == -1);
+    Q_ASSERT(!movedItems.contains(item));
+    Q_ASSERT(!unindexedItems.contains(item));
+    Q_ASSERT(!untransformableItems.contains(item));
+    Q_ASSERT(!clippedItems.contains(item));
+
+    if (moveToUnindexedItems)
+        addItem(item);
+
+    if (recursive) {
+        for (int i = 0; i < item->d_ptr->children.size(); ++i)
+            removeItem(item->d_ptr->children.at(i), recursive, moveToUnindexedItems);
+    }
+}
+
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndexPrivate::estimateItems(const QRectF &rect, Qt::SortOrder order,
+                                                                      bool onlyTopLevelItems)
+{
+    Q_Q(QGraphicsSceneRTreeIndex);
+    if (onlyTopLevelItems && rect.isNull())
+        return q->QGraphicsSceneIndex::estimateTopLevelItems(rect, order);
+
+    updateIndex();
+
+    QList<QGraphicsItem *> rectItems;
+    tree.intersecting(rect, [&rectItems, onlyTopLevelItems](QGraphicsItem *item) {
+        if (onlyTopLevelItems && item->d_ptr->parent)
+            item = item->topLevelItem();
+        if (!item->d_func()->itemDiscovered && item->d_ptr->visible) {
+            item->d_func()->itemDiscovered = 1;
+            rectItems << item;
+        }
+    });
+    // Reset discovery bits.
+    for (QGraphicsItem *item : std::as_const(rectItems))
+        item->d_ptr->itemDiscovered = 0;
+
+    if (onlyTopLevelItems) {
+        for (QGraphicsItem *item : std::as_const(untransformableItems)) {
+            if (!item->d_ptr->parent) {
+                rectItems << item;
+            } else {
+                item = item->topLevelItem();
+                if (!rectItems.contains(item))
+                    rectItems << item;
+            }
+        }
+    } else {
+        for (QGraphicsItem *item : std::as_const(untransformableItems))
+            rectItems << item;
+    }
+
+    sortItems(&rectItems, order, onlyTopLevelItems);
+    return rectItems;
+}
+
+/*!
+    Sort a list of \a itemList in a specific \a order.
+
+    \internal
+*/
+void QGraphicsSceneRTreeIndexPrivate::sortItems(QList<QGraphicsItem *> *itemList, Qt::SortOrder order,
+                                                bool onlyTopLevelItems)
+{
+    if (order == Qt::SortOrder(-1))
+        return;
+
+    if (onlyTopLevelItems) {
+        if (order == Qt::DescendingOrder)
+            std::sort(itemList->begin(), itemList->end(), qt_closestLeaf);
+        else if (order == Qt::AscendingOrder)
+            std::sort(itemList->begin(), itemList->end(), qt_notclosestLeaf);
+        return;
+    }
+
+    if (order == Qt::DescendingOrder)
+        std::sort(itemList->begin(), itemList->end(), qt_closestItemFirst);
+    else if (order == Qt::AscendingOrder)
+        std::sort(itemList->begin(), itemList->end(), qt_closestItemLast);
+}
+
+/*!
+    Constructs an R-tree scene index for the given \a scene.
+*/
+QGraphicsSceneRTreeIndex::QGraphicsSceneRTreeIndex(QGraphicsScene *scene)
+    : QGraphicsSceneIndex(*new QGraphicsSceneRTreeIndexPrivate(scene), scene)
+{
+}
+
+QGraphicsSceneRTreeIndex::~QGraphicsSceneRTreeIndex()
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    // Ensure item bits are reset properly.
+    d->resetItemIndexes();
+}
+
+/*!
+    \internal
+    Clear the R-tree index.
+*/
+void QGraphicsSceneRTreeIndex::clear()
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->resetItemIndexes();
+    d->tree.clear();
+    d->removalsSinceBuild = 0;
+    d->indexTimer.stop();
+    d->unindexedItems.clear();
+    d->movedItems.clear();
+    d->untransformableItems.clear();
+    d->clippedItems.clear();
+}
+
+/*!
+    Add the \a item into the R-tree index.
+*/
+void QGraphicsSceneRTreeIndex::addItem(QGraphicsItem *item)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->addItem(item);
+}
+
+/*!
+    Remove the \a item from the R-tree index.
+*/
+void QGraphicsSceneRTreeIndex::removeItem(QGraphicsItem *item)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->removeItem(item);
+}
+
+/*!
+    \internal
+    Marks the \a item, whose bounding rect is about to change, and its
+    descendants for an update of their rectangles in the tree.
+*/
+void QGraphicsSceneRTreeIndex::prepareBoundingRectChange(const QGraphicsItem *item)
+{
+    if (!item || item->d_ptr->index == -1)
+        return; // Item is not in the tree; nothing to do.
+
+    Q_D(QGraphicsSceneRTreeIndex);
+    d->movedItems.insert(const_cast<QGraphicsItem *>(item));
+    for (int i = 0; i < item->d_ptr->children.size(); ++i)
+        prepareBoundingRectChange(item->d_ptr->children.at(i));
+}
+
+/*!
+    Returns an estimation visible items that are either inside or
+    intersect with the specified \a rect and return a list sorted using \a order.
+*/
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::estimateItems(const QRectF &rect, Qt::SortOrder order) const
+{
+    Q_D(const QGraphicsSceneRTreeIndex);
+    return const_cast<QGraphicsSceneRTreeIndexPrivate*>(d)->estimateItems(rect, order);
+}
+
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::estimateTopLevelItems(const QRectF &rect, Qt::SortOrder order) const
+{
+    Q_D(const QGraphicsSceneRTreeIndex);
+    return const_cast<QGraphicsSceneRTreeIndexPrivate*>(d)->estimateItems(rect, order, /*onlyTopLevels=*/true);
+}
+
+/*!
+    \fn QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::items(Qt::SortOrder order = Qt::DescendingOrder) const;
+
+    Return all items in the R-tree index and sort them using \a order.
+*/
+QList<QGraphicsItem *> QGraphicsSceneRTreeIndex::items(Qt::SortOrder order) const
+{
+    Q_D(const QGraphicsSceneRTreeIndex);
+    QList<QGraphicsItem *> itemList;
+    itemList.reserve(d->tree.size() + d->unindexedItems.size() + d->untransformableItems.size()
+                     + d->clippedItems.size());
+    d->tree.forEach([&itemList](const QRectF &, QGraphicsItem *item) { itemList << item; });
+    for (QGraphicsItem *item : d->unindexedItems)
+        itemList << item;
+    for (QGraphicsItem *item : d->untransformableItems)
+        itemList << item;
+    for (QGraphicsItem *item : d->clippedItems)
+        itemList << item;
+
+    d->sortItems(&itemList, order);
+    return itemList;
+}
+
+/*!
+    \internal
+
+    This method react to the \a change of the \a item and use the \a value to
+    update the R-tree if necessary.
+*/
+void QGraphicsSceneRTreeIndex::itemChange(const QGraphicsItem *item, QGraphicsItem::GraphicsItemChange change, const void *const value)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    switch (change) {
+    case QGraphicsItem::ItemFlagsChange: {
+        // Handle ItemIgnoresTransformations
+        QGraphicsItem::GraphicsItemFlags newFlags = *static_cast<const QGraphicsItem::GraphicsItemFlags *>(value);
+        bool ignoredTransform = item->d_ptr->flags & QGraphicsItem::ItemIgnoresTransformations;
+        bool willIgnoreTransform = newFlags & QGraphicsItem::ItemIgnoresTransformations;
+        bool clipsChildren = item->d_ptr->flags & QGraphicsItem::ItemClipsChildrenToShape
+                             || item->d_ptr->flags & QGraphicsItem::ItemContainsChildrenInShape;
+        bool willClipChildren = newFlags & QGraphicsItem::ItemClipsChildrenToShape
+                                || newFlags & QGraphicsItem::ItemContainsChildrenInShape;
+        if ((ignoredTransform != willIgnoreTransform) || (clipsChildren != willClipChildren)) {
+            QGraphicsItem *thatItem = const_cast<QGraphicsItem *>(item);
+            // Remove item and its descendants from the index and append
+            // them to the unindexed items. Then, when the index is updated,
+            // they will be put into the tree or the untransformable items.
+            d->removeItem(thatItem, /*recursive=*/true, /*moveToUnindexedItems=*/true);
+        }
+        break;
+    }
+    case QGraphicsItem::ItemParentChange: {
+        // Handle ItemIgnoresTransformations
+        const QGraphicsItem *newParent = static_cast<const QGraphicsItem *>(value);
+        bool ignoredTransform = item->d_ptr->itemIsUntransformable();
+        bool willIgnoreTransform = (item->d_ptr->flags & QGraphicsItem::ItemIgnoresTransformations)
+                                   || (newParent && newParent->d_ptr->itemIsUntransformable());
+        bool ancestorClippedChildren = item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
+                                       || item->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren;
+        bool ancestorWillClipChildren = newParent
+                            && ((newParent->d_ptr->flags & QGraphicsItem::ItemClipsChildrenToShape
+                                 || newParent->d_ptr->flags & QGraphicsItem::ItemContainsChildrenInShape)
+                                || (newParent->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorClipsChildren
+                                    || newParent->d_ptr->ancestorFlags & QGraphicsItemPrivate::AncestorContainsChildren));
+        if ((ignoredTransform != willIgnoreTransform) || (ancestorClippedChildren != ancestorWillClipChildren)) {
+            QGraphicsItem *thatItem = const_cast<QGraphicsItem *>(item);
+            d->removeItem(thatItem, /*recursive=*/true, /*moveToUnindexedItems=*/true);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/*!
+    \reimp
+
+    Used to catch the timer event.
+
+    \internal
+*/
+bool QGraphicsSceneRTreeIndex::event(QEvent *event)
+{
+    Q_D(QGraphicsSceneRTreeIndex);
+    if (event->type() == QEvent::Timer) {
+        if (d->indexTimer.isActive() && static_cast<QTimerEvent *>(event)->id() == d->indexTimer.id())
+            d->updateIndex();
+    }
+    return QObject::event(event);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qgraphicsscenertreeindex_p.cpp"
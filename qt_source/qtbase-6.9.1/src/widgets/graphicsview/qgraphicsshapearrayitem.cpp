@@ -0,0 +1,973 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+/*!
+    \class QGraphicsShapeArrayItem
+    \brief The QGraphicsShapeArrayItem class provides a single item holding
+    a large number of simple shapes.
+    \since 6.10
+    \ingroup graphicsview-api
+    \inmodule QtWidgets
+
+    Every QGraphicsItem carries its own private data, transformation and
+    flags, which makes scenes of millions of items slow to build and to
+    update. QGraphicsShapeArrayItem represents a homogeneous set of
+    rectangles, lines and polygons as one item instead. The shapes are
+    kept in flat arrays, one entry per shape, and have a color and an
+    integer id each, but no transformation, flags or events of their own.
+
+    Shapes are added with addRect(), addLine() and addPolygon(), which
+    return the index of the new shape, and are painted in the order they
+    were added. Adding many shapes between beginBatch() and endBatch()
+    changes the geometry of the item and schedules it for repainting only
+    once. The item keeps its own spatial index of the shapes, which is
+    built the first time it is needed, so shapesAt() and shapesIn() find
+    the shapes under a point or inside an area without visiting all of
+    them. The scene finds the item itself through its index as usual;
+    contains() and collidesWithPath() are answered from the shapes, so
+    QGraphicsScene::items() and QGraphicsView::items() only return the item
+    where one of its shapes is.
+
+    paint() draws the shapes that intersect the exposed rectangle in
+    batches: consecutive rectangles or lines of the same color are drawn
+    with one call to QPainter::drawRects() or QPainter::drawLines().
+    Rectangles and polygons are filled with their color and not outlined;
+    lines are drawn with a pen of their color and lineWidth().
+
+    Shapes have a selection state of their own, which is independent of
+    the selection of the item. Selected shapes are drawn in the highlight
+    color of the palette. The item does not select shapes by itself;
+    reimplement the mouse event handlers and use shapesAt() or shapesIn()
+    to find the shapes to select.
+
+    shape() returns the bounding rectangle of the item, as building a
+    path of all the shapes would defeat the purpose of the item.
+
+    \sa QGraphicsScene::beginTransaction(), {Graphics View Framework}
+*/
+
+/*!
+    \enum QGraphicsShapeArrayItem::ShapeType
+
+    This enum describes the kind of a shape.
+
+    \value Rect A rectangle, see addRect().
+    \value Line A line, see addLine().
+    \value Polygon A polygon, see addPolygon().
+*/
+
+#include "qgraphicsshapearrayitem.h"
+
+#include "qgraphicsitem_p.h"
+
+#include <QtCore/qmath.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpainterpath.h>
+#include <QtWidgets/qstyleoption.h>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+QT_BEGIN_NAMESPACE
+
+void Q_WIDGETS_EXPORT qt_graphicsItem_highlightSelected(
+    QGraphicsItem *item, QPainter *painter, const QStyleOptionGraphicsItem *option);
+
+class QGraphicsShapeArrayItemPrivate : public QGraphicsItemPrivate
+{
+    Q_DECLARE_PUBLIC(QGraphicsShapeArrayItem)
+public:
+    enum { TypeMask = 0x3, SelectedBit = 0x4 };
+
+    // One entry per shape in each list. x1, y1, x2 and y2 hold the corners
+    // of rectangles, the end points of lines and the bounds of polygons.
+    QList<quint8> kinds;
+    QList<qreal> x1, y1, x2, y2;
+    QList<QRgb> colors;
+    QList<int> ids;
+
+    // The points of polygon number n are polygonPoints[polygonOffsets[n]]
+    // up to polygonPoints[polygonOffsets[n + 1]].
+    QList<int> polygonShapes;
+    QList<qsizetype> polygonOffsets = { 0 };
+    QList<QPointF> polygonPoints;
+
+    // The geometry boundingRect() reports. Inside a batch, the shapes that
+    // are added are collected in batchBounds and batchDirty instead.
+    QRectF bounds;
+    bool boundsHaveLines = false;
+    qreal lineWidth = 0;
+    bool hasLines = false;
+    int selectedCount = 0;
+    int batchDepth = 0;
+    QRectF batchBounds;
+    QRectF batchDirty;
+
+    // A packed R-tree of the shapes, built with sort-tile-recursive packing
+    // when a query finds enough shapes that are not in it. Leaves refer to
+    // runs of shapeOrder, and the bounds of the shapes are read from x1, y1,
+    // x2 and y2, so only the nodes store rectangles. The shapes from
+    // indexedCount on are tested one by one.
+    enum { IndexFanout = 16 };
+    struct IndexNode
+    {
+        QRectF rect;
+        int first;      // into shapeOrder for leaves, into indexNodes otherwise
+        int count;
+        bool leaf;
+    };
+    mutable QList<int> shapeOrder;
+    mutable QList<IndexNode> indexNodes; // the root is the last node
+    mutable int indexedCount = 0;
+
+    QGraphicsShapeArrayItem::ShapeType kind(int i) const
+    { return QGraphicsShapeArrayItem::ShapeType(kinds.at(i) & TypeMask); }
+    QRectF shapeRect(int i) const;
+    qreal lineMargin() const { return hasLines ? lineWidth / 2 : 0; }
+    const QPointF *polygonData(int i, int *count) const;
+
+    int addShape(QGraphicsShapeArrayItem::ShapeType type, qreal ax1, qreal ay1, qreal ax2,
+                 qreal ay2, const QRectF &rect, QRgb color, int id);
+    void setBounds(const QRectF &rect);
+    void updateShape(const QRectF &rect);
+    void ensureIndex() const;
+    template <typename Func>
+    void intersecting(const QRectF &rect, Func func) const;
+
+    bool hitsRect(int i, const QRectF &rect, Qt::ItemSelectionMode mode) const;
+    bool hitsPath(int i, const QPainterPath &path, const QList<QPolygonF> &outlines,
+                  Qt::ItemSelectionMode mode) const;
+    QList<int> shapesIn(const QRectF &rect, Qt::ItemSelectionMode mode, bool firstOnly) const;
+    QList<int> shapesIn(const QPainterPath &path, Qt::ItemSelectionMode mode, bool firstOnly) const;
+};
+
+QRectF QGraphicsShapeArrayItemPrivate::shapeRect(int i) const
+{
+    return QRectF(QPointF(qMin(x1.at(i), x2.at(i)), qMin(y1.at(i), y2.at(i))),
+                  QPointF(qMax(x1.at(i), x2.at(i)), qMax(y1.at(i), y2.at(i))));
+}
+
+const QPointF *QGraphicsShapeArrayItemPrivate::polygonData(int i, int *count) const
+{
+    const auto it = std::lower_bound(polygonShapes.cbegin(), polygonShapes.cend(), i);
+    Q_ASSERT(it != polygonShapes.cend() && *it == i);
+    const qsizetype polygon = it - polygonShapes.cbegin();
+    const qsizetype offset = polygonOffsets.at(polygon);
+    *count = int(polygonOffsets.at(polygon + 1) - offset);
+    return polygonPoints.constData() + offset;
+}
+
+int QGraphicsShapeArrayItemPrivate::addShape(QGraphicsShapeArrayItem::ShapeType type,
+                                             qreal ax1, qreal ay1, qreal ax2, qreal ay2,
+                                             const QRectF &rect, QRgb color, int id)
+{
+    const int index = int(kinds.size());
+    kinds.append(quint8(type));
+    x1.append(ax1);
+    y1.append(ay1);
+    x2.append(ax2);
+    y2.append(ay2);
+    colors.append(color);
+    ids.append(id);
+    if (type == QGraphicsShapeArrayItem::Line)
+        hasLines = true;
+
+    if (batchDepth > 0) {
+        batchBounds = index == 0 ? rect : batchBounds.united(rect);
+    } else {
+        setBounds(index == 0 ? rect : bounds.united(rect));
+    }
+    updateShape(rect);
+    return index;
+}
+
+// Makes boundingRect() report rect, and the width of the lines if there are any.
+void QGraphicsShapeArrayItemPrivate::setBounds(const QRectF &rect)
+{
+    Q_Q(QGraphicsShapeArrayItem);
+    if (rect != bounds || (hasLines != boundsHaveLines && lineWidth > 0))
+        q->prepareGeometryChange();
+    bounds = rect;
+    boundsHaveLines = hasLines;
+}
+
+void QGraphicsShapeArrayItemPrivate::updateShape(const QRectF &rect)
+{
+    Q_Q(QGraphicsShapeArrayItem);
+    const qreal margin = lineMargin();
+    const QRectF dirty = rect.adjusted(-margin, -margin, margin, margin);
+    if (batchDepth > 0)
+        batchDirty |= dirty;
+    else
+        q->update(dirty);
+}
+
+static inline bool rectsOverlap(const QRectF &a, const QRectF &b)
+{
+    return a.left() <= b.right() && b.left() <= a.right()
+        && a.top() <= b.bottom() && b.top() <= a.bottom();
+}
+
+static inline QRectF uniteRects(const QRectF &a, const QRectF &b)
+{
+    const qreal left = qMin(a.left(), b.left());
+    const qreal top = qMin(a.top(), b.top());
+    return QRectF(left, top, qMax(a.right(), b.right()) - left,
+                  qMax(a.bottom(), b.bottom()) - top);
+}
+
+// Orders [begin, end) so that every run of IndexFanout elements is a tile of
+// a sort-tile-recursive packing: vertical slices sorted by x, each sorted by y.
+template <typename It, typename Center>
+static void sortTiles(It begin, It end, Center center)
+{
+    const qsizetype fanout = QGraphicsShapeArrayItemPrivate::IndexFanout;
+    const qsizetype nodeCount = (end - begin + fanout - 1) / fanout;
+    const qsizetype sliceSize = qCeil(qSqrt(qreal(nodeCount))) * fanout;
+    std::sort(begin, end, [&](const auto &a, const auto &b) {
+        return center(a).x() < center(b).x();
+    });
+    for (It slice = begin; slice < end; slice += qMin(sliceSize, qsizetype(end - slice))) {
+        std::sort(slice, slice + qMin(sliceSize, qsizetype(end - slice)),
+                  [&](const auto &a, const auto &b) { return center(a).y() < center(b).y(); });
+    }
+}
+
+void QGraphicsShapeArrayItemPrivate::ensureIndex() const
+{
+    // Rebuilding costs a sort of all shapes, so a few shapes that are not
+    // in the tree are rather tested one by one.
+    const int count = int(kinds.size());
+    if (count - indexedCount <= qMax(indexedCount / 4, IndexFanout * IndexFanout))
+        return;
+
+    shapeOrder.resize(count);
+    std::iota(shapeOrder.begin(), shapeOrder.end(), 0);
+    sortTiles(shapeOrder.begin(), shapeOrder.end(),
+              [this](int i) { return shapeRect(i).center(); });
+
+    QList<IndexNode> level;
+    level.reserve((count + IndexFanout - 1) / IndexFanout);
+    for (int first = 0; first < count; first += IndexFanout) {
+        const int n = qMin<int>(IndexFanout, count - first);
+        QRectF rect = shapeRect(shapeOrder.at(first));
+        for (int j = first + 1; j < first + n; ++j)
+            rect = uniteRects(rect, shapeRect(shapeOrder.at(j)));
+        level.append({ rect, first, n, true });
+    }
+
+    indexNodes.clear();
+    while (level.size() > 1) {
+        sortTiles(level.begin(), level.end(),
+                  [](const IndexNode &node) { return node.rect.center(); });
+        const int base = int(indexNodes.size());
+        indexNodes.append(level);
+        QList<IndexNode> parents;
+        for (int first = 0; first < level.size(); first += IndexFanout) {
+            const int n = qMin<int>(IndexFanout, int(level.size()) - first);
+            QRectF rect = level.at(first).rect;
+            for (int j = first + 1; j < first + n; ++j)
+                rect = uniteRects(rect, level.at(j).rect);
+            parents.append({ rect, base + first, n, false });
+        }
+        level = std::move(parents);
+    }
+    indexNodes.append(level.first());
+    indexedCount = count;
+}
+
+/*
+    Calls \a func with the index of every shape whose bounds overlap \a rect.
+*/
+template <typename Func>
+void QGraphicsShapeArrayItemPrivate::intersecting(const QRectF &rect, Func func) const
+{
+    if (!indexNodes.isEmpty()) {
+        QVarLengthArray<int, 64> stack;
+        stack.append(int(indexNodes.size() - 1));
+        while (!stack.isEmpty()) {
+            const IndexNode &node = indexNodes.at(stack.last());
+            stack.removeLast();
+            if (!rectsOverlap(node.rect, rect))
+                continue;
+            for (int c = node.first; c < node.first + node.count; ++c) {
+                if (!node.leaf)
+                    stack.append(c);
+                else if (rectsOverlap(shapeRect(shapeOrder.at(c)), rect))
+                    func(shapeOrder.at(c));
+            }
+        }
+    }
+    const int count = int(kinds.size());
+    for (int i = indexedCount; i < count; ++i) {
+        if (rectsOverlap(shapeRect(i), rect))
+            func(i);
+    }
+}
+
+static bool segmentIntersectsRect(const QPointF &p1, const QPointF &p2, const QRectF &rect)
+{
+    if (rect.contains(p1) || rect.contains(p2))
+        return true;
+    const QLineF segment(p1, p2);
+    const QLineF edges[] = {
+        QLineF(rect.topLeft(), rect.topRight()), QLineF(rect.topRight(), rect.bottomRight()),
+        QLineF(rect.bottomRight(), rect.bottomLeft()), QLineF(rect.bottomLeft(), rect.topLeft())
+    };
+    for (const QLineF &edge : edges) {
+        if (segment.intersects(edge, nullptr) == QLineF::BoundedIntersection)
+            return true;
+    }
+    return false;
+}
+
+// Distance within which a point query finds a cosmetic line.
+static constexpr qreal PointTolerance = 1e-6;
+
+static qreal distanceToSegment(const QPointF &point, const QPointF &p1, const QPointF &p2)
+{
+    const QPointF d = p2 - p1;
+    const qreal lengthSquared = QPointF::dotProduct(d, d);
+    qreal t = 0;
+    if (lengthSquared > 0)
+        t = qBound(qreal(0), QPointF::dotProduct(point - p1, d) / lengthSquared, qreal(1));
+    const QPointF delta = point - (p1 + t * d);
+    return qSqrt(QPointF::dotProduct(delta, delta));
+}
+
+static bool segmentCrossesOutlines(const QLineF &segment, const QList<QPolygonF> &outlines)
+{
+    for (const QPolygonF &outline : outlines) {
+        for (qsizetype i = 1; i < outline.size(); ++i) {
+            if (segment.intersects(QLineF(outline.at(i - 1), outline.at(i)), nullptr)
+                == QLineF::BoundedIntersection) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool QGraphicsShapeArrayItemPrivate::hitsRect(int i, const QRectF &rect,
+                                              Qt::ItemSelectionMode mode) const
+{
+    const QRectF shapeBounds = shapeRect(i);
+    const bool contain = mode == Qt::ContainsItemShape || mode == Qt::ContainsItemBoundingRect;
+    if (contain)
+        return rect.contains(shapeBounds);
+
+    // The caller found the shape through its bounds, which overlap rect.
+    if (mode == Qt::IntersectsItemBoundingRect)
+        return true;
+
+    switch (kind(i)) {
+    case QGraphicsShapeArrayItem::Rect:
+        return true;
+    case QGraphicsShapeArrayItem::Line: {
+        const qreal margin = lineMargin();
+        // A point query has no area the segment could cross.
+        if (rect.width() == 0 && rect.height() == 0) {
+            return distanceToSegment(rect.topLeft(), QPointF(x1.at(i), y1.at(i)),
+                                     QPointF(x2.at(i), y2.at(i))) <= qMax(margin, PointTolerance);
+        }
+        return segmentIntersectsRect(QPointF(x1.at(i), y1.at(i)), QPointF(x2.at(i), y2.at(i)),
+                                     rect.adjusted(-margin, -margin, margin, margin));
+    }
+    case QGraphicsShapeArrayItem::Polygon: {
+        int count;
+        const QPointF *points = polygonData(i, &count);
+        if (count == 0)
+            return false;
+        for (int p = 0; p < count; ++p) {
+            if (rect.contains(points[p])
+                || segmentIntersectsRect(points[p], points[(p + 1) % count], rect)) {
+                return true;
+            }
+        }
+        // The rectangle may lie entirely inside the polygon.
+        const QPolygonF polygon(QList<QPointF>(points, points + count));
+        return polygon.containsPoint(rect.center(), Qt::OddEvenFill);
+    }
+    }
+    return false;
+}
+
+bool QGraphicsShapeArrayItemPrivate::hitsPath(int i, const QPainterPath &path,
+                                              const QList<QPolygonF> &outlines,
+                                              Qt::ItemSelectionMode mode) const
+{
+    const bool contain = mode == Qt::ContainsItemShape || mode == Qt::ContainsItemBoundingRect;
+    const bool useBounds = mode == Qt::IntersectsItemBoundingRect
+            || mode == Qt::ContainsItemBoundingRect;
+    const QRectF shapeBounds = shapeRect(i);
+
+    if (kind(i) == QGraphicsShapeArrayItem::Line
+        || (useBounds && (shapeBounds.width() == 0 || shapeBounds.height() == 0))) {
+        // Lines, and the degenerate bounds of axis aligned lines, are
+        // tested as segments.
+        const QLineF segment = useBounds ? QLineF(shapeBounds.topLeft(), shapeBounds.bottomRight())
+                                         : QLineF(x1.at(i), y1.at(i), x2.at(i), y2.at(i));
+        const bool inside1 = path.contains(segment.p1());
+        const bool inside2 = path.contains(segment.p2());
+        const bool crosses = segmentCrossesOutlines(segment, outlines);
+        return contain ? inside1 && inside2 && !crosses : inside1 || inside2 || crosses;
+    }
+
+    if (useBounds || kind(i) == QGraphicsShapeArrayItem::Rect)
+        return contain ? path.contains(shapeBounds) : path.intersects(shapeBounds);
+
+    int count;
+    const QPointF *points = polygonData(i, &count);
+    QPainterPath polygonPath;
+    polygonPath.addPolygon(QPolygonF(QList<QPointF>(points, points + count)));
+    polygonPath.closeSubpath();
+    return contain ? path.contains(polygonPath) : path.intersects(polygonPath);
+}
+
+QList<int> QGraphicsShapeArrayItemPrivate::shapesIn(const QRectF &rect, Qt::ItemSelectionMode mode,
+                                                    bool firstOnly) const
+{
+    ensureIndex();
+    const bool point = rect.width() == 0 && rect.height() == 0;
+    const qreal margin = point ? qMax(lineMargin(), PointTolerance) : lineMargin();
+    QList<int> result;
+    intersecting(rect.adjusted(-margin, -margin, margin, margin), [&](int i) {
+        if ((!firstOnly || result.isEmpty()) && hitsRect(i, rect, mode))
+            result.append(i);
+    });
+    std::sort(result.begin(), result.end(), std::greater<int>());
+    return result;
+}
+
+QList<int> QGraphicsShapeArrayItemPrivate::shapesIn(const QPainterPath &path,
+                                                    Qt::ItemSelectionMode mode,
+                                                    bool firstOnly) const
+{
+    ensureIndex();
+    const QList<QPolygonF> outlines = path.toSubpathPolygons();
+    const qreal margin = lineMargin();
+    QList<int> result;
+    intersecting(path.controlPointRect().adjusted(-margin, -margin, margin, margin),
+                 [&](int i) {
+        if ((!firstOnly || result.isEmpty()) && hitsPath(i, path, outlines, mode))
+            result.append(i);
+    });
+    std::sort(result.begin(), result.end(), std::greater<int>());
+    return result;
+}
+
+/*!
+    Constructs an empty QGraphicsShapeArrayItem. \a parent is passed to
+    QGraphicsItem's constructor.
+
+    \sa QGraphicsScene::addItem()
+*/
+QGraphicsShapeArrayItem::QGraphicsShapeArrayItem(QGraphicsItem *parent)
+    : QGraphicsItem(*new QGraphicsShapeArrayItemPrivate, parent)
+{
+    setFlag(ItemUsesExtendedStyleOption);
+}
+
+/*!
+    Destroys the QGraphicsShapeArrayItem and all its shapes.
+*/
+QGraphicsShapeArrayItem::~QGraphicsShapeArrayItem()
+{
+}
+
+/*!
+    Returns the number of shapes in the item.
+*/
+int QGraphicsShapeArrayItem::count() const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return int(d->kinds.size());
+}
+
+/*!
+    Reserves room for \a shapes shapes, so that adding that many shapes does
+    not reallocate the arrays that hold them.
+*/
+void QGraphicsShapeArrayItem::reserve(int shapes)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    d->kinds.reserve(shapes);
+    d->x1.reserve(shapes);
+    d->y1.reserve(shapes);
+    d->x2.reserve(shapes);
+    d->y2.reserve(shapes);
+    d->colors.reserve(shapes);
+    d->ids.reserve(shapes);
+}
+
+/*!
+    Removes all shapes from the item.
+*/
+void QGraphicsShapeArrayItem::clear()
+{
+    Q_D(QGraphicsShapeArrayItem);
+    prepareGeometryChange();
+    d->kinds.clear();
+    d->x1.clear();
+    d->y1.clear();
+    d->x2.clear();
+    d->y2.clear();
+    d->colors.clear();
+    d->ids.clear();
+    d->polygonShapes.clear();
+    d->polygonOffsets = { 0 };
+    d->polygonPoints.clear();
+    d->bounds = QRectF();
+    d->boundsHaveLines = false;
+    d->hasLines = false;
+    d->selectedCount = 0;
+    d->batchBounds = QRectF();
+    d->batchDirty = QRectF();
+    d->shapeOrder.clear();
+    d->indexNodes.clear();
+    d->indexedCount = 0;
+}
+
+/*!
+    Starts a batch of changes to the shapes. Until the matching endBatch(),
+    adding shapes, changing their colors and selecting them neither changes
+    the geometry of the item nor schedules it for repainting; endBatch() does
+    both once for all of them. Batches can be nested, and only the outermost
+    endBatch() applies the changes.
+
+    Use a batch when adding many shapes to an item that is in a scene, so
+    that the scene does not reindex and repaint the item for each of them.
+
+    \sa endBatch()
+*/
+void QGraphicsShapeArrayItem::beginBatch()
+{
+    Q_D(QGraphicsShapeArrayItem);
+    if (d->batchDepth++ == 0)
+        d->batchBounds = d->bounds;
+}
+
+/*!
+    Ends a batch of changes started with beginBatch(). When the outermost
+    batch ends, the item takes the geometry of the shapes added in it and
+    repaints the area they changed.
+
+    \sa beginBatch()
+*/
+void QGraphicsShapeArrayItem::endBatch()
+{
+    Q_D(QGraphicsShapeArrayItem);
+    Q_ASSERT(d->batchDepth > 0);
+    if (--d->batchDepth > 0)
+        return;
+    d->setBounds(d->batchBounds);
+    if (!d->batchDirty.isEmpty())
+        update(d->batchDirty);
+    d->batchBounds = QRectF();
+    d->batchDirty = QRectF();
+}
+
+/*!
+    Adds the rectangle \a rect, filled with \a color, and returns its index.
+    \a id is stored with the shape and can be retrieved with id().
+*/
+int QGraphicsShapeArrayItem::addRect(const QRectF &rect, QRgb color, int id)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    const QRectF r = rect.normalized();
+    return d->addShape(Rect, r.left(), r.top(), r.right(), r.bottom(), r, color, id);
+}
+
+/*!
+    Adds \a line, drawn with a pen of \a color and lineWidth(), and returns
+    its index. \a id is stored with the shape and can be retrieved with id().
+*/
+int QGraphicsShapeArrayItem::addLine(const QLineF &line, QRgb color, int id)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    const QRectF r = QRectF(line.p1(), line.p2()).normalized();
+    return d->addShape(Line, line.x1(), line.y1(), line.x2(), line.y2(), r, color, id);
+}
+
+/*!
+    Adds \a polygon, filled with \a color using the odd-even fill rule, and
+    returns its index. \a id is stored with the shape and can be retrieved
+    with id().
+*/
+int QGraphicsShapeArrayItem::addPolygon(const QPolygonF &polygon, QRgb color, int id)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    const QRectF r = polygon.boundingRect();
+    d->polygonShapes.append(int(d->kinds.size()));
+    d->polygonPoints.append(polygon);
+    d->polygonOffsets.append(d->polygonPoints.size());
+    return d->addShape(Polygon, r.left(), r.top(), r.right(), r.bottom(), r, color, id);
+}
+
+/*!
+    Returns the type of the shape at \a index.
+*/
+QGraphicsShapeArrayItem::ShapeType QGraphicsShapeArrayItem::shapeType(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->kind(index);
+}
+
+/*!
+    Returns the bounding rectangle of the shape at \a index, not including
+    the width of lines.
+*/
+QRectF QGraphicsShapeArrayItem::shapeBoundingRect(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->shapeRect(index);
+}
+
+/*!
+    Returns the rectangle at \a index, or a null rectangle if the shape is
+    not a rectangle.
+*/
+QRectF QGraphicsShapeArrayItem::rect(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->kind(index) == Rect ? d->shapeRect(index) : QRectF();
+}
+
+/*!
+    Returns the line at \a index, or a null line if the shape is not a line.
+*/
+QLineF QGraphicsShapeArrayItem::line(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    if (d->kind(index) != Line)
+        return QLineF();
+    return QLineF(d->x1.at(index), d->y1.at(index), d->x2.at(index), d->y2.at(index));
+}
+
+/*!
+    Returns the outline of the shape at \a index as a polygon. The polygon
+    of a line consists of its two end points.
+*/
+QPolygonF QGraphicsShapeArrayItem::polygon(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    switch (d->kind(index)) {
+    case Rect:
+        return QPolygonF(d->shapeRect(index));
+    case Line:
+        return QPolygonF({ QPointF(d->x1.at(index), d->y1.at(index)),
+                           QPointF(d->x2.at(index), d->y2.at(index)) });
+    case Polygon: {
+        int count;
+        const QPointF *points = d->polygonData(index, &count);
+        return QPolygonF(QList<QPointF>(points, points + count));
+    }
+    }
+    return QPolygonF();
+}
+
+/*!
+    Returns the id the shape at \a index was added with.
+*/
+int QGraphicsShapeArrayItem::id(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->ids.at(index);
+}
+
+/*!
+    Returns the color of the shape at \a index.
+*/
+QRgb QGraphicsShapeArrayItem::color(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->colors.at(index);
+}
+
+/*!
+    Sets the color of the shape at \a index to \a color.
+*/
+void QGraphicsShapeArrayItem::setColor(int index, QRgb color)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    if (d->colors.at(index) == color)
+        return;
+    d->colors[index] = color;
+    d->updateShape(d->shapeRect(index));
+}
+
+/*!
+    Returns the width of the pen lines are drawn with. The default is 0,
+    which draws cosmetic lines one pixel wide.
+*/
+qreal QGraphicsShapeArrayItem::lineWidth() const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->lineWidth;
+}
+
+/*!
+    Sets the width of the pen lines are drawn with to \a width, in item
+    coordinates. A width of 0 draws cosmetic lines one pixel wide.
+*/
+void QGraphicsShapeArrayItem::setLineWidth(qreal width)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    if (d->lineWidth == width)
+        return;
+    if (d->boundsHaveLines)
+        prepareGeometryChange();
+    d->lineWidth = width;
+    update();
+}
+
+/*!
+    Returns \c true if the shape at \a index is selected; otherwise returns
+    \c false.
+*/
+bool QGraphicsShapeArrayItem::isShapeSelected(int index) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->kinds.at(index) & QGraphicsShapeArrayItemPrivate::SelectedBit;
+}
+
+/*!
+    Selects the shape at \a index if \a selected is true; otherwise
+    deselects it.
+*/
+void QGraphicsShapeArrayItem::setShapeSelected(int index, bool selected)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    if (isShapeSelected(index) == selected)
+        return;
+    if (selected) {
+        d->kinds[index] |= QGraphicsShapeArrayItemPrivate::SelectedBit;
+        ++d->selectedCount;
+    } else {
+        d->kinds[index] &= ~QGraphicsShapeArrayItemPrivate::SelectedBit;
+        --d->selectedCount;
+    }
+    d->updateShape(d->shapeRect(index));
+}
+
+/*!
+    Returns the indexes of the selected shapes in ascending order.
+*/
+QList<int> QGraphicsShapeArrayItem::selectedShapes() const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    QList<int> result;
+    result.reserve(d->selectedCount);
+    for (int i = 0; i < d->kinds.size() && result.size() < d->selectedCount; ++i) {
+        if (d->kinds.at(i) & QGraphicsShapeArrayItemPrivate::SelectedBit)
+            result.append(i);
+    }
+    return result;
+}
+
+/*!
+    Deselects all shapes.
+*/
+void QGraphicsShapeArrayItem::clearShapeSelection()
+{
+    Q_D(QGraphicsShapeArrayItem);
+    if (d->selectedCount == 0)
+        return;
+    for (quint8 &kind : d->kinds)
+        kind &= ~QGraphicsShapeArrayItemPrivate::SelectedBit;
+    d->selectedCount = 0;
+    update();
+}
+
+/*!
+    Returns the indexes of the shapes at \a point, in item coordinates, with
+    the topmost shape, the one added last, first. Lines are found within
+    half their width of \a point.
+*/
+QList<int> QGraphicsShapeArrayItem::shapesAt(const QPointF &point) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->shapesIn(QRectF(point, QSizeF(0, 0)), Qt::IntersectsItemShape, false);
+}
+
+/*!
+    Returns the indexes of the shapes that, depending on \a mode, intersect
+    or are contained in \a rect, in item coordinates. The topmost shape, the
+    one added last, comes first.
+*/
+QList<int> QGraphicsShapeArrayItem::shapesIn(const QRectF &rect, Qt::ItemSelectionMode mode) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->shapesIn(rect.normalized(), mode, false);
+}
+
+/*!
+    \overload
+
+    Returns the indexes of the shapes that, depending on \a mode, intersect
+    or are contained in \a path, in item coordinates.
+*/
+QList<int> QGraphicsShapeArrayItem::shapesIn(const QPainterPath &path,
+                                             Qt::ItemSelectionMode mode) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return d->shapesIn(path, mode, false);
+}
+
+/*!
+    \reimp
+*/
+QRectF QGraphicsShapeArrayItem::boundingRect() const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    const qreal margin = d->boundsHaveLines ? d->lineWidth / 2 : 0;
+    return d->bounds.adjusted(-margin, -margin, margin, margin);
+}
+
+/*!
+    \reimp
+
+    Returns the bounding rectangle of the item; contains() and
+    collidesWithPath() test the shapes themselves.
+*/
+QPainterPath QGraphicsShapeArrayItem::shape() const
+{
+    QPainterPath path;
+    path.addRect(boundingRect());
+    return path;
+}
+
+/*!
+    \reimp
+*/
+bool QGraphicsShapeArrayItem::contains(const QPointF &point) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    return !d->shapesIn(QRectF(point, QSizeF(0, 0)), Qt::IntersectsItemShape, true).isEmpty();
+}
+
+/*!
+    \reimp
+
+    The item collides with \a path if one of its shapes does, or, for the
+    Qt::ContainsItemShape mode, if \a path contains all of its shapes.
+*/
+bool QGraphicsShapeArrayItem::collidesWithPath(const QPainterPath &path,
+                                               Qt::ItemSelectionMode mode) const
+{
+    Q_D(const QGraphicsShapeArrayItem);
+    if (mode == Qt::IntersectsItemBoundingRect || mode == Qt::ContainsItemBoundingRect)
+        return QGraphicsItem::collidesWithPath(path, mode);
+    if (d->kinds.isEmpty())
+        return false;
+
+    if (mode == Qt::IntersectsItemShape)
+        return !d->shapesIn(path, mode, true).isEmpty();
+
+    if (path.contains(boundingRect()))
+        return true;
+    if (!path.intersects(boundingRect()))
+        return false;
+    return d->shapesIn(path, mode, false).size() == d->kinds.size();
+}
+
+/*!
+    \reimp
+*/
+void QGraphicsShapeArrayItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                                    QWidget *widget)
+{
+    Q_D(QGraphicsShapeArrayItem);
+    Q_UNUSED(widget);
+    const int count = int(d->kinds.size());
+    if (count == 0)
+        return;
+
+    const qreal margin = d->lineMargin();
+    const QRectF exposed = option->exposedRect.adjusted(-margin, -margin, margin, margin);
+    QList<int> visible;
+    const bool all = exposed.contains(d->bounds);
+    if (!all) {
+        d->ensureIndex();
+        d->intersecting(exposed, [&](int i) { visible.append(i); });
+        if (visible.isEmpty())
+            return;
+        std::sort(visible.begin(), visible.end());
+    }
+
+    const QRgb highlight = option->palette.highlight().color().rgba();
+    QVarLengthArray<QRectF, 256> rects;
+    QVarLengthArray<QLineF, 256> lines;
+    int runKind = -1;
+    QRgb runColor = 0;
+
+    const auto flush = [&] {
+        if (!rects.isEmpty())
+            painter->drawRects(rects.constData(), int(rects.size()));
+        if (!lines.isEmpty())
+            painter->drawLines(lines.constData(), int(lines.size()));
+        rects.clear();
+        lines.clear();
+    };
+
+    const qsizetype shapes = all ? count : visible.size();
+    for (qsizetype n = 0; n < shapes; ++n) {
+        const int i = all ? int(n) : visible.at(n);
+        const int kind = d->kinds.at(i) & QGraphicsShapeArrayItemPrivate::TypeMask;
+        const QRgb color = d->kinds.at(i) & QGraphicsShapeArrayItemPrivate::SelectedBit
+                ? highlight : d->colors.at(i);
+
+        // Consecutive shapes of one kind and color form a batch.
+        if (kind != runKind || color != runColor || rects.size() + lines.size() >= 4096) {
+            flush();
+            if (kind != runKind || color != runColor) {
+                if (kind == Line) {
+                    painter->setPen(QPen(QColor::fromRgba(color), d->lineWidth));
+                    painter->setBrush(Qt::NoBrush);
+                } else {
+                    painter->setPen(Qt::NoPen);
+                    painter->setBrush(QColor::fromRgba(color));
+                }
+                runKind = kind;
+                runColor = color;
+            }
+        }
+
+        switch (kind) {
+        case Rect:
+            rects.append(QRectF(QPointF(d->x1.at(i), d->y1.at(i)),
+                                QPointF(d->x2.at(i), d->y2.at(i))));
+            break;
+        case Line:
+            lines.append(QLineF(d->x1.at(i), d->y1.at(i), d->x2.at(i), d->y2.at(i)));
+            break;
+        case Polygon: {
+            int points;
+            const QPointF *data = d->polygonData(i, &points);
+            painter->drawPolygon(data, points, Qt::OddEvenFill);
+            break;
+        }
+        }
+    }
+    flush();
+
+    if (option->state & QStyle::State_Selected)
+        qt_graphicsItem_highlightSelected(this, painter, option);
+}
+
+/*!
+    \reimp
+
+    Returns QGraphicsShapeArrayItem::Type, which is 15. The built-in item
+    types of Qt Widgets use the values 1 to 12, and 13 and 14 are taken by
+    QGraphicsSvgItem and QGraphicsVideoItem. Custom items use values from
+    QGraphicsItem::UserType on, so they never clash with it.
+*/
+int QGraphicsShapeArrayItem::type() const
+{
+    return Type;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,81 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QGRAPHICSSHAPEARRAYITEM_H
+#define QGRAPHICSSHAPEARRAYITEM_H
+
+#include <QtWidgets/qtwidgetsglobal.h>
+#include <QtWidgets/qgraphicsitem.h>
+#include <QtCore/qline.h>
+#include <QtCore/qlist.h>
+#include <QtGui/qpolygon.h>
+#include <QtGui/qrgb.h>
+
+QT_REQUIRE_CONFIG(graphicsview);
+
+QT_BEGIN_NAMESPACE
+
+class QGraphicsShapeArrayItemPrivate;
+class Q_WIDGETS_EXPORT QGraphicsShapeArrayItem : public QGraphicsItem
+{
+public:
+    enum ShapeType {
+        Rect,
+        Line,
+        Polygon
+    };
+
+    explicit QGraphicsShapeArrayItem(QGraphicsItem *parent = nullptr);
+    ~QGraphicsShapeArrayItem();
+
+    int count() const;
+    void reserve(int shapes);
+    void clear();
+
+    void beginBatch();
+    void endBatch();
+
+    int addRect(const QRectF &rect, QRgb color, int id = 0);
+    int addLine(const QLineF &line, QRgb color, int id = 0);
+    int addPolygon(const QPolygonF &polygon, QRgb color, int id = 0);
+
+    ShapeType shapeType(int index) const;
+    QRectF shapeBoundingRect(int index) const;
+    QRectF rect(int index) const;
+    QLineF line(int index) const;
+    QPolygonF polygon(int index) const;
+    int id(int index) const;
+
+    QRgb color(int index) const;
+    void setColor(int index, QRgb color);
+
+    qreal lineWidth() const;
+    void setLineWidth(qreal width);
+
+    bool isShapeSelected(int index) const;
+    void setShapeSelected(int index, bool selected);
+    QList<int> selectedShapes() const;
+    void clearShapeSelection();
+
+    QList<int> shapesAt(const QPointF &point) const;
+    QList<int> shapesIn(const QRectF &rect, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const;
+    QList<int> shapesIn(const QPainterPath &path, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const;
+
+    QRectF boundingRect() const override;
+    QPainterPath shape() const override;
+    bool contains(const QPointF &point) const override;
+    bool collidesWithPath(const QPainterPath &path, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const override;
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+    enum { Type = 15 }; // 13 and 14 are QGraphicsSvgItem and QGraphicsVideoItem
+    int type() const override;
+
+private:
+    Q_DISABLE_COPY(QGraphicsShapeArrayItem)
+    Q_DECLARE_PRIVATE(QGraphicsShapeArrayItem)
+};
+
+QT_END_NAMESPACE
+
+#endif // QGRAPHICSSHAPEARRAYITEM_H
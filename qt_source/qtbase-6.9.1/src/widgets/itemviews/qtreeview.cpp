@@ -10,6 +10,7 @@
 #include <qstack.h>
 #include <qstyle.h>
 #include <qstyleoption.h>
+#include <qvarlengtharray.h>
 #include <qevent.h>
 #include <qpen.h>
 #include <qdebug.h>
@@ -126,6 +127,14 @@ QT_BEGIN_NAMESPACE
     that can be taken for views that are intended to display items with equal heights
     is to set the \l uniformRowHeights property to true.
 
+    When an item is expanded, the view only asks the model whether each
+    child has children of its own once the child is shown, so expanding
+    items with very many children does not query the model for all of them.
+    If \l uniformRowHeights is set and no rows are hidden or spanned, the
+    view also does not keep any data for collapsed rows until they are
+    shown, so the time and memory that expanding an item takes do not grow
+    with its number of children.
+
     \sa QListView, QTreeWidget, {View Classes}, QAbstractItemModel, QAbstractItemView
 */
 
@@ -397,7 +406,8 @@ void QTreeView::setRootIsDecorated(bool show)
 
   This property should only be set to true if it is guaranteed that all items
   in the view has the same height. This enables the view to do some
-  optimizations.
+  optimizations, such as not keeping any data for collapsed rows that are
+  not shown.
 
   The height is obtained from the first item in the view.  It is updated
   when the data changes on that item.
@@ -658,15 +668,15 @@ void QTreeView::dataChanged(const QModelIndex &topLeft, const QModelIndex &botto
             d->invalidateHeightCache(topViewIndex);
             sizeChanged |= (oldHeight != d->itemHeight(topViewIndex));
             if (topLeft.column() == 0)
-                d->viewItems[topViewIndex].hasChildren = d->hasVisibleChildren(topLeft);
+                d->viewItems[topViewIndex].pendingHasChildren = true;
         } else {
             int bottomViewIndex = d->viewIndex(bottomRight);
             for (int i = topViewIndex; i <= bottomViewIndex; ++i) {
                 int oldHeight = d->itemHeight(i);
                 d->invalidateHeightCache(i);
                 sizeChanged |= (oldHeight != d->itemHeight(i));
-                if (topLeft.column() == 0)
-                    d->viewItems[i].hasChildren = d->hasVisibleChildren(d->viewItems.at(i).index);
+                if (topLeft.column() == 0 && d->viewItems.isMaterialized(i))
+                    d->viewItems[i].pendingHasChildren = true;
             }
         }
     }
@@ -1021,7 +1031,7 @@ void QTreeView::keyboardSearch(const QString &search)
     int bestBelow = -1;
     QString searchString = sameKey ? QString(d->keyboardInput.at(0)) : d->keyboardInput;
     for (int i = 0; i < d->viewItems.size(); ++i) {
-        if ((int)d->viewItems.at(i).level > previousLevel) {
+        if (d->viewItems.levelAt(i) > previousLevel) {
             QModelIndex searchFrom = d->viewItems.at(i).index;
             if (start.column() > 0)
                 searchFrom = searchFrom.sibling(searchFrom.row(), start.column());
@@ -1036,7 +1046,7 @@ void QTreeView::keyboardSearch(const QString &search)
                     bestBelow = bestBelow == -1 ? hitIndex : qMin(hitIndex, bestBelow);
             }
         }
-        previousLevel = d->viewItems.at(i).level;
+        previousLevel = d->viewItems.levelAt(i);
     }
 
     QModelIndex index;
@@ -1472,7 +1482,7 @@ void QTreeViewPrivate::adjustViewOptionsForIndex(QStyleOptionViewItem *option, c
 {
     const int row = viewIndex(current); // get the index in viewItems[]
     option->state = option->state | (viewItems.at(row).expanded ? QStyle::State_Open : QStyle::State_None)
-                                  | (viewItems.at(row).hasChildren ? QStyle::State_Children : QStyle::State_None)
+                                  | (itemHasChildren(row) ? QStyle::State_Children : QStyle::State_None)
                                   | (viewItems.at(row).hasMoreSiblings ? QStyle::State_Sibling : QStyle::State_None);
 
     option->showDecorationSelected = (selectionBehavior & QTreeView::SelectRows)
@@ -1503,7 +1513,7 @@ void QTreeView::drawTree(QPainter *painter, const QRegion &region) const
 {
     Q_D(const QTreeView);
     // d->viewItems changes when posted layouts are executed in itemDecorationAt, so don't copy
-    const QList<QTreeViewItem> &viewItems = d->viewItems;
+    const QTreeViewItems &viewItems = d->viewItems;
 
     QStyleOptionViewItem option;
     initViewItemOption(&option);
@@ -1552,7 +1562,7 @@ void QTreeView::drawTree(QPainter *painter, const QRegion &region) const
             const int itemHeight = d->itemHeight(i);
             option.rect = d->visualRect(index, QTreeViewPrivate::FullRow);
             option.state = state | (viewItems.at(i).expanded ? QStyle::State_Open : QStyle::State_None)
-                                 | (viewItems.at(i).hasChildren ? QStyle::State_Children : QStyle::State_None)
+                                 | (d->itemHasChildren(i) ? QStyle::State_Children : QStyle::State_None)
                                  | (viewItems.at(i).hasMoreSiblings ? QStyle::State_Sibling : QStyle::State_None);
             d->current = i;
             d->spanning = viewItems.at(i).spanning;
@@ -1921,7 +1931,7 @@ void QTreeView::drawBranches(QPainter *painter, const QRect &rect,
         opt.rect = primitive;
 
         const bool expanded = viewItem.expanded;
-        const bool children = viewItem.hasChildren;
+        const bool children = d->itemHasChildren(item);
         bool moreSiblings = viewItem.hasMoreSiblings;
 
         opt.state = QStyle::State_Item | extraFlags
@@ -2588,6 +2598,7 @@ void QTreeView::rowsInserted(const QModelIndex &parent, int start, int end)
     } else if (parentItem != -1 && parentRowCount == delta) {
         // the parent just went from 0 children to more. update to re-paint the decoration
         d->viewItems[parentItem].hasChildren = true;
+        d->viewItems[parentItem].pendingHasChildren = false;
         viewport()->update();
     }
     QAbstractItemView::rowsInserted(parent, start, end);
@@ -2925,7 +2936,7 @@ int QTreeView::sizeHintForColumn(int column) const
     int w = 0;
     QStyleOptionViewItem option;
     initViewItemOption(&option);
-    const QList<QTreeViewItem> viewItems = d->viewItems;
+    const QTreeViewItems &viewItems = d->viewItems;
 
     const int maximumProcessRows = d->header->resizeContentsPrecision(); // To avoid this to take forever.
 
@@ -3174,19 +3185,230 @@ void QTreeViewPrivate::expand(int item, bool emitSignal)
 void QTreeViewPrivate::insertViewItems(int pos, int count, const QTreeViewItem &viewItem)
 {
     viewItems.insert(pos, count, viewItem);
-    QTreeViewItem *items = viewItems.data();
-    for (int i = pos + count; i < viewItems.size(); i++)
-        if (items[i].parentItem >= pos)
-            items[i].parentItem += count;
+    viewItems.shiftParentItems(pos + count, pos, count);
+}
+
+void QTreeViewPrivate::insertViewRun(int pos, int count, const QTreeViewItems::Run &run)
+{
+    if (count <= 0)
+        return;
+    viewItems.insertRun(pos, count, run);
+    viewItems.shiftParentItems(pos + count, pos, count);
 }
 
 void QTreeViewPrivate::removeViewItems(int pos, int count)
 {
     viewItems.remove(pos, count);
-    QTreeViewItem *items = viewItems.data();
-    for (int i = pos; i < viewItems.size(); i++)
-        if (items[i].parentItem >= pos)
-            items[i].parentItem -= count;
+    viewItems.shiftParentItems(pos, pos, -count);
+}
+
+// Rows of a run that are turned into items together when one is accessed.
+static constexpr qsizetype MaterializedWindow = 64;
+
+void QTreeViewItems::clear()
+{
+    m_blocks.clear();
+    m_lastBlock = 0;
+    m_size = 0;
+}
+
+/*
+    Returns the block that holds row \a i. Rows are mostly accessed close
+    to the previous one, so the block of the last access is tried first.
+*/
+qsizetype QTreeViewItems::findBlock(qsizetype i) const
+{
+    Q_ASSERT(i >= 0 && i < m_size);
+    if (m_lastBlock < m_blocks.size()) {
+        const Block &last = m_blocks.at(m_lastBlock);
+        if (i >= last.start && i < last.start + last.count)
+            return m_lastBlock;
+        if (m_lastBlock + 1 < m_blocks.size()) {
+            const Block &next = m_blocks.at(m_lastBlock + 1);
+            if (i >= next.start && i < next.start + next.count)
+                return ++m_lastBlock;
+        }
+    }
+    const auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), i,
+                                     [](qsizetype i, const Block &block) { return i < block.start; });
+    m_lastBlock = (it - m_blocks.cbegin()) - 1;
+    return m_lastBlock;
+}
+
+QTreeViewItem &QTreeViewItems::item(qsizetype i) const
+{
+    qsizetype b = findBlock(i);
+    if (m_blocks.at(b).isRun()) {
+        // Replace the run by up to two shorter runs around a block of
+        // items. This leaves the storage of all other items in place.
+        const Block run = m_blocks.at(b);
+        const qsizetype first = qMax(run.start, i - MaterializedWindow / 2);
+        const qsizetype end = qMin(run.start + run.count, first + MaterializedWindow);
+
+        Block items{ first, end - first, {}, run.run };
+        items.items.resize(items.count);
+        for (qsizetype k = 0; k < items.count; ++k) {
+            const int row = run.run.firstRow + int(first - run.start + k);
+            QTreeViewItem &item = items.items[k];
+            item.index = run.run.model->index(row, 0, run.run.parent);
+            item.parentItem = run.run.parentItem;
+            item.level = run.run.level;
+            item.hasMoreSiblings = row < run.run.rowCount - 1;
+            item.pendingHasChildren = true;
+        }
+
+        m_blocks[b] = std::move(items);
+        if (first > run.start) {
+            m_blocks.insert(b, { run.start, first - run.start, {}, run.run });
+            ++b;
+        }
+        if (end < run.start + run.count) {
+            Block after = run;
+            after.start = end;
+            after.count = run.start + run.count - end;
+            after.run.firstRow += int(end - run.start);
+            m_blocks.insert(b + 1, std::move(after));
+        }
+        m_lastBlock = b;
+    }
+    Block &block = m_blocks[b];
+    return block.items[i - block.start];
+}
+
+int QTreeViewItems::levelAt(qsizetype i) const
+{
+    const Block &block = m_blocks.at(findBlock(i));
+    return block.isRun() ? block.run.level : int(block.items.at(i - block.start).level);
+}
+
+/*
+    Makes row \a i the first row of a block and returns that block, or the
+    number of blocks if \a i is the end.
+*/
+qsizetype QTreeViewItems::split(qsizetype i)
+{
+    if (i == m_size)
+        return m_blocks.size();
+    const qsizetype b = findBlock(i);
+    Block &block = m_blocks[b];
+    const qsizetype offset = i - block.start;
+    if (offset == 0)
+        return b;
+
+    Block tail{ i, block.count - offset, {}, block.run };
+    if (block.isRun()) {
+        tail.run.firstRow += int(offset);
+    } else {
+        tail.items = block.items.mid(offset);
+        block.items.resize(offset);
+    }
+    block.count = offset;
+    m_blocks.insert(b + 1, std::move(tail));
+    return b + 1;
+}
+
+void QTreeViewItems::moveStarts(qsizetype block, qsizetype delta)
+{
+    for (qsizetype b = block; b < m_blocks.size(); ++b)
+        m_blocks[b].start += delta;
+}
+
+void QTreeViewItems::insert(qsizetype pos, qsizetype count, const QTreeViewItem &item)
+{
+    if (count <= 0)
+        return;
+    // Add to a block of items that ends at or contains pos if there is one.
+    qsizetype b = pos > 0 ? findBlock(pos - 1) : -1;
+    if (b < 0 || m_blocks.at(b).isRun()) {
+        b = pos < m_size ? findBlock(pos) : -1;
+        if (b >= 0 && m_blocks.at(b).isRun())
+            b = -1;
+    }
+
+    if (b >= 0) {
+        Block &block = m_blocks[b];
+        block.items.insert(pos - block.start, count, item);
+        block.count += count;
+    } else {
+        b = split(pos);
+        m_blocks.insert(b, { pos, count, QList<QTreeViewItem>(count, item), {} });
+    }
+    moveStarts(b + 1, count);
+    m_size += count;
+}
+
+void QTreeViewItems::insertRun(qsizetype pos, qsizetype count, const Run &run)
+{
+    if (count <= 0)
+        return;
+    const qsizetype b = split(pos);
+    m_blocks.insert(b, { pos, count, {}, run });
+    moveStarts(b + 1, count);
+    m_size += count;
+}
+
+void QTreeViewItems::remove(qsizetype pos, qsizetype count)
+{
+    if (count <= 0)
+        return;
+    const qsizetype b = findBlock(pos);
+    Block &block = m_blocks[b];
+    if (!block.isRun() && count < block.count && pos + count <= block.start + block.count) {
+        block.items.remove(pos - block.start, count);
+        block.count -= count;
+        moveStarts(b + 1, -count);
+        m_size -= count;
+        return;
+    }
+
+    const qsizetype first = split(pos);
+    const qsizetype last = split(pos + count);
+    m_blocks.remove(first, last - first);
+    moveStarts(first, -count);
+    m_size -= count;
+    m_lastBlock = 0;
+
+    // Join the blocks of items on both sides of the removed rows.
+    if (first > 0 && first < m_blocks.size()
+        && !m_blocks.at(first - 1).isRun() && !m_blocks.at(first).isRun()) {
+        Block &before = m_blocks[first - 1];
+        before.items.append(m_blocks.at(first).items);
+        before.count += m_blocks.at(first).count;
+        m_blocks.remove(first);
+    }
+}
+
+void QTreeViewItems::resize(qsizetype size)
+{
+    if (size < m_size)
+        remove(size, m_size - size);
+    else
+        insert(m_size, size - m_size, QTreeViewItem());
+}
+
+/*
+    Adds \a delta to the parentItem of the rows from \a from on whose
+    parent is at or after \a threshold.
+*/
+void QTreeViewItems::shiftParentItems(qsizetype from, int threshold, int delta)
+{
+    if (from >= m_size)
+        return;
+    for (qsizetype b = findBlock(from); b < m_blocks.size(); ++b) {
+        Block &block = m_blocks[b];
+        if (block.isRun()) {
+            // Inserting and removing rows splits runs at from.
+            Q_ASSERT(block.start >= from);
+            if (block.run.parentItem >= threshold)
+                block.run.parentItem += delta;
+            continue;
+        }
+        for (qsizetype k = qMax<qsizetype>(0, from - block.start); k < block.count; ++k) {
+            QTreeViewItem &item = block.items[k];
+            if (item.parentItem >= threshold)
+                item.parentItem += delta;
+        }
+    }
 }
 
 #if 0
@@ -3398,8 +3620,11 @@ void QTreeViewPrivate::updateAccessibility()
     set \a recursiveExpanding if the function has to expand all the children (called from expandAll)
     \a afterIsUninitialized is when we recurse from layout(-1), it means all the items after 'i' are
     not yet initialized and need not to be moved
+    \a expandedRows is shared by the recursive calls of one pass, so that expandedIndexes is only
+    scanned once
  */
-void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninitialized)
+void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninitialized,
+                              ExpandedRows *expandedRows)
 {
     Q_Q(QTreeView);
     QModelIndex current;
@@ -3421,9 +3646,15 @@ void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninit
     });
 #endif
 
+    ExpandedRows passExpandedRows;
+    if (!expandedRows)
+        expandedRows = &passExpandedRows;
+
     int count = 0;
     if (model->hasChildren(parent)) {
         if (model->canFetchMore(parent)) {
+            // fetchMore may move rows around, so the expanded rows are collected again
+            expandedRows->collected = false;
             // fetchMore first, otherwise we might not yet have any data for sizeHintForRow
             model->fetchMore(parent);
             // guestimate the number of items in the viewport, and fetch as many as might fit
@@ -3440,6 +3671,78 @@ void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninit
         }
     }
 
+    // Which children are expanded is looked up in the sorted rows of the
+    // parent when there are more children than expanded indexes, instead of
+    // with a flags() call and a persistent index lookup for every child. The
+    // table of the rows is collected once per pass.
+    const bool useExpandedRows = !recursiveExpanding && count > expandedIndexes.size();
+    QList<int> expandedChildRows;
+    if (useExpandedRows && !expandedIndexes.isEmpty()) {
+        if (!expandedRows->collected) {
+            expandedRows->byParent.clear();
+            for (const QPersistentModelIndex &index : std::as_const(expandedIndexes)) {
+                if (index.isValid() && index.column() == 0)
+                    expandedRows->byParent[index.parent()].append(index.row());
+            }
+            for (QList<int> &rows : expandedRows->byParent)
+                std::sort(rows.begin(), rows.end());
+            expandedRows->collected = true;
+        }
+        expandedChildRows = expandedRows->byParent.value(parent);
+    }
+
+    const int level = (i >= 0 ? viewItems.at(i).level + 1 : 0);
+
+    // With uniform row heights and no hidden or spanning rows, a collapsed
+    // child needs nothing but its model index. The children between the
+    // expanded ones are then stored as runs, see QTreeViewItems, so only
+    // the rows that are shown or expanded get an item.
+    if (uniformRowHeights && !recursiveExpanding && hiddenIndexes.isEmpty()
+        && spanningIndexes.isEmpty() && (i < 0 || viewItems.at(i).total == 0)) {
+        if (i == -1) {
+            defaultItemHeight = q->indexRowSizeHint(model->index(0, 0, parent));
+            viewItems.clear();
+        }
+        if (!useExpandedRows) {
+            for (int row = 0; row < count; ++row) {
+                if (isIndexExpanded(model->index(row, 0, parent)))
+                    expandedChildRows.append(row);
+            }
+        }
+
+        QTreeViewItems::Run run = { parent, model, i, level, 0, count };
+        int pos = i + 1;
+        for (int row : std::as_const(expandedChildRows)) {
+            if (row < run.firstRow || row >= count)
+                continue;
+            current = model->index(row, 0, parent);
+            if (useExpandedRows && (current.flags() & Qt::ItemNeverHasChildren))
+                continue;
+            insertViewRun(pos, row - run.firstRow, run);
+            pos += row - run.firstRow;
+
+            QTreeViewItem item;
+            item.index = current;
+            item.parentItem = i;
+            item.level = level;
+            item.expanded = true;
+            item.hasMoreSiblings = row < count - 1;
+            insertViewItems(pos, 1, item);
+            layout(pos, false, false, expandedRows);
+            QTreeViewItem &laidOut = viewItems[pos];
+            laidOut.hasChildren = laidOut.total > 0;
+            pos += 1 + laidOut.total;
+            run.firstRow = row + 1;
+        }
+        insertViewRun(pos, count - run.firstRow, run);
+
+        while (i > -1) {
+            viewItems[i].total += count;
+            i = viewItems[i].parentItem;
+        }
+        return;
+    }
+
     bool expanding = true;
     if (i == -1) {
         if (uniformRowHeights) {
@@ -3456,15 +3759,23 @@ void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninit
     } else {
         expanding = false;
     }
+    qsizetype nextExpanded = 0;
+
+    // Children start out collapsed and without known children, see itemHasChildren().
+    QTreeViewItem child;
+    child.parentItem = i;
+    child.level = level;
+    child.pendingHasChildren = true;
+    const bool checkSpanning = !spanningIndexes.isEmpty();
 
     int first = i + 1;
-    int level = (i >= 0 ? viewItems.at(i).level + 1 : 0);
     int hidden = 0;
     int last = 0;
     int children = 0;
     QTreeViewItem *item = nullptr;
     for (int j = first; j < first + count; ++j) {
-        current = model->index(j - first, 0, parent);
+        const int row = j - first;
+        current = model->index(row, 0, parent);
         if (isRowHidden(current)) {
             ++hidden;
             last = j - hidden + children;
@@ -3473,25 +3784,33 @@ void QTreeViewPrivate::layout(int i, bool recursiveExpanding, bool afterIsUninit
             if (item)
                 item->hasMoreSiblings = true;
             item = &viewItems[last];
+            *item = child;
             item->index = current;
-            item->parentItem = i;
-            item->level = level;
-            item->height = 0;
-            item->spanning = q->isFirstColumnSpanned(current.row(), parent);
-            item->expanded = false;
-            item->total = 0;
-            item->hasMoreSiblings = false;
-            if ((recursiveExpanding && !(current.flags() & Qt::ItemNeverHasChildren)) || isIndexExpanded(current)) {
+            if (checkSpanning)
+                item->spanning = isPersistent(current) && spanningIndexes.contains(current);
+
+            bool expanded;
+            if (recursiveExpanding) {
+                expanded = !(current.flags() & Qt::ItemNeverHasChildren);
+            } else if (useExpandedRows) {
+                while (nextExpanded < expandedChildRows.size() && expandedChildRows.at(nextExpanded) < row)
+                    ++nextExpanded;
+                expanded = nextExpanded < expandedChildRows.size()
+                        && expandedChildRows.at(nextExpanded) == row
+                        && !(current.flags() & Qt::ItemNeverHasChildren);
+            } else {
+                expanded = isIndexExpanded(current);
+            }
+            if (expanded) {
                 if (recursiveExpanding && storeExpanded(current) && !q->signalsBlocked())
                     emit q->expanded(current);
                 item->expanded = true;
-                layout(last, recursiveExpanding, afterIsUninitialized);
+                item->pendingHasChildren = false;
+                layout(last, recursiveExpanding, afterIsUninitialized, expandedRows);
                 item = &viewItems[last];
                 children += item->total;
                 item->hasChildren = item->total > 0;
                 last = j - hidden + children;
-            } else {
-                item->hasChildren = hasVisibleChildren(current);
             }
         }
     }
@@ -3691,42 +4010,76 @@ int QTreeViewPrivate::viewIndex(const QModelIndex &_index) const
     if (!_index.isValid() || viewItems.isEmpty())
         return -1;
 
-    const int totalCount = viewItems.size();
     const QModelIndex index = _index.sibling(_index.row(), 0);
-    const int row = index.row();
-    const quintptr internalId = index.internalId();
-
-    // We start nearest to the lastViewedItem
-    int localCount = qMin(lastViewedItem - 1, totalCount - lastViewedItem);
-    for (int i = 0; i < localCount; ++i) {
-        const QModelIndex &idx1 = viewItems.at(lastViewedItem + i).index;
-        if (idx1.row() == row && idx1.internalId() == internalId) {
-            lastViewedItem = lastViewedItem + i;
+    if (lastViewedItem >= 0 && lastViewedItem < viewItems.size()) {
+        const QModelIndex &idx = viewItems.at(lastViewedItem).index;
+        if (idx.row() == index.row() && idx.internalId() == index.internalId())
             return lastViewedItem;
-        }
-        const QModelIndex &idx2 = viewItems.at(lastViewedItem - i - 1).index;
-        if (idx2.row() == row && idx2.internalId() == internalId) {
-            lastViewedItem = lastViewedItem - i - 1;
-            return lastViewedItem;
-        }
     }
 
-    for (int j = qMax(0, lastViewedItem + localCount); j < totalCount; ++j) {
-        const QModelIndex &idx = viewItems.at(j).index;
-        if (idx.row() == row && idx.internalId() == internalId) {
-            lastViewedItem = j;
-            return j;
-        }
+    // Find the ancestors of the index from the root down, each one among the
+    // children of the view item found for the previous one.
+    QVarLengthArray<QModelIndex, 16> ancestors;
+    for (QModelIndex ancestor = index; ancestor != root; ancestor = ancestor.parent()) {
+        if (!ancestor.isValid())
+            return -1;
+        ancestors.append(ancestor);
     }
-    for (int j = qMin(totalCount, lastViewedItem - localCount) - 1; j >= 0; --j) {
-        const QModelIndex &idx = viewItems.at(j).index;
-        if (idx.row() == row && idx.internalId() == internalId) {
-            lastViewedItem = j;
-            return j;
-        }
+
+    int item = -1;
+    for (qsizetype i = ancestors.size() - 1; i >= 0; --i) {
+        item = childViewIndex(item, ancestors.at(i));
+        if (item < 0)
+            return -1;
     }
+    lastViewedItem = item;
+    return item;
+}
 
-    // nothing found
+/*!
+  \internal
+  Returns the view item of \a child among the children of the view item
+  \a parentItem, or of the root if \a parentItem is -1, or -1 if the child
+  is not shown.
+
+  The children of an item follow it in the order of their rows, each one
+  followed by its visible descendants, so they are found with a binary
+  search that skips over the descendants.
+*/
+int QTreeViewPrivate::childViewIndex(int parentItem, const QModelIndex &child) const
+{
+    const int row = child.row();
+    const quintptr internalId = child.internalId();
+    const auto matches = [&](int item) {
+        const QModelIndex &idx = viewItems.at(item).index;
+        return idx.row() == row && idx.internalId() == internalId;
+    };
+
+    int first = parentItem + 1;
+    int last = parentItem < 0 ? int(viewItems.size()) - 1
+                              : parentItem + int(viewItems.at(parentItem).total);
+
+    // Without hidden rows or expanded siblings above it, the child is
+    // where its row says.
+    const int guess = first + row;
+    if (guess <= last && viewItems.at(guess).parentItem == parentItem && matches(guess))
+        return guess;
+
+    while (first <= last) {
+        const int middle = first + (last - first) / 2;
+        int sibling = middle;
+        while (viewItems.at(sibling).parentItem > parentItem)
+            sibling = viewItems.at(sibling).parentItem;
+        if (viewItems.at(sibling).parentItem != parentItem)
+            return -1;
+        const int siblingRow = viewItems.at(sibling).index.row();
+        if (siblingRow == row)
+            return matches(sibling) ? sibling : -1;
+        if (siblingRow < row)
+            first = middle + 1;
+        else
+            last = sibling - 1;
+    }
     return -1;
 }
 
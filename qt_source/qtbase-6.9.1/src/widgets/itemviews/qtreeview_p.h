@@ -20,6 +20,7 @@
 #include "private/qabstractitemview_p.h"
 #include <QtCore/qabstractitemmodel.h>
 #include <QtCore/qbasictimer.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #if QT_CONFIG(animation)
 #include <QtCore/qvariantanimation.h>
@@ -34,7 +35,8 @@ QT_BEGIN_NAMESPACE
 struct QTreeViewItem
 {
     QTreeViewItem() : parentItem(-1), expanded(false), spanning(false), hasChildren(false),
-                      hasMoreSiblings(false), total(0), level(0), height(0) {}
+                      hasMoreSiblings(false), total(0), level(0), pendingHasChildren(false),
+                      height(0) {}
     QModelIndex index; // we remove items whenever the indexes are invalidated
     int parentItem; // parent item index in viewItems
     uint expanded : 1;
@@ -42,12 +44,71 @@ struct QTreeViewItem
     uint hasChildren : 1; // if the item has visible children (even if collapsed)
     uint hasMoreSiblings : 1;
     uint total : 28; // total number of children visible
-    uint level : 16; // indentation
+    uint level : 15; // indentation
+    uint pendingHasChildren : 1; // hasChildren not known yet, see QTreeViewPrivate::itemHasChildren()
     int height : 16; // row height
 };
 
 Q_DECLARE_TYPEINFO(QTreeViewItem, Q_RELOCATABLE_TYPE);
 
+// The rows shown by the view, in view order. Besides blocks of items, it
+// holds runs of collapsed sibling rows that need nothing but their model
+// index; those are turned into QTreeViewItems a window at a time when they
+// are accessed. Accessing a row never invalidates references to others,
+// inserting and removing rows does.
+class Q_WIDGETS_EXPORT QTreeViewItems
+{
+public:
+    struct Run
+    {
+        QModelIndex parent;
+        const QAbstractItemModel *model;
+        int parentItem;
+        int level;
+        int firstRow;
+        int rowCount; // of the parent
+    };
+
+    qsizetype size() const { return m_size; }
+    qsizetype count() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    void clear();
+
+    const QTreeViewItem &at(qsizetype i) const { return item(i); }
+    QTreeViewItem &operator[](qsizetype i) { return item(i); }
+    const QTreeViewItem &constFirst() const { return item(0); }
+    const QTreeViewItem &constLast() const { return item(m_size - 1); }
+    QTreeViewItem &last() { return item(m_size - 1); }
+
+    bool isMaterialized(qsizetype i) const { return !m_blocks.at(findBlock(i)).isRun(); }
+    int levelAt(qsizetype i) const;
+
+    void insert(qsizetype pos, qsizetype count, const QTreeViewItem &item);
+    void insertRun(qsizetype pos, qsizetype count, const Run &run);
+    void remove(qsizetype pos, qsizetype count);
+    void resize(qsizetype size);
+    void shiftParentItems(qsizetype from, int threshold, int delta);
+
+private:
+    struct Block
+    {
+        qsizetype start;
+        qsizetype count;
+        QList<QTreeViewItem> items; // empty for a run
+        Run run;
+        bool isRun() const { return items.isEmpty(); }
+    };
+
+    QTreeViewItem &item(qsizetype i) const;
+    qsizetype findBlock(qsizetype i) const;
+    qsizetype split(qsizetype i);
+    void moveStarts(qsizetype block, qsizetype delta);
+
+    mutable QList<Block> m_blocks;
+    mutable qsizetype m_lastBlock = 0;
+    qsizetype m_size = 0;
+};
+
 class Q_WIDGETS_EXPORT QTreeViewPrivate : public QAbstractItemViewPrivate
 {
     Q_DECLARE_PUBLIC(QTreeView)
@@ -106,7 +167,15 @@ public:
     void modelDestroyed() override;
     QRect intersectedRect(const QRect rect, const QModelIndex &topLeft, const QModelIndex &bottomRight) const override;
 
-    void layout(int item, bool recusiveExpanding = false, bool afterIsUninitialized = false);
+    // The expanded rows of each parent, sorted, collected from
+    // expandedIndexes once per layout() pass
+    struct ExpandedRows
+    {
+        QHash<QModelIndex, QList<int>> byParent;
+        bool collected = false;
+    };
+    void layout(int item, bool recusiveExpanding = false, bool afterIsUninitialized = false,
+                ExpandedRows *expandedRows = nullptr);
 
     int pageUp(int item) const;
     int pageDown(int item) const;
@@ -119,9 +188,11 @@ public:
     int itemAtCoordinate(int coordinate) const;
 
     int viewIndex(const QModelIndex &index) const;
+    int childViewIndex(int parentItem, const QModelIndex &child) const;
     QModelIndex modelIndex(int i, int column = 0) const;
 
     void insertViewItems(int pos, int count, const QTreeViewItem &viewItem);
+    void insertViewRun(int pos, int count, const QTreeViewItems::Run &run);
     void removeViewItems(int pos, int count);
 #if 0
     bool checkViewItems() const;
@@ -131,6 +202,16 @@ public:
     int lastVisibleItem(int firstVisual = -1, int offset = -1) const;
     int columnAt(int x) const;
     bool hasVisibleChildren( const QModelIndex& parent) const;
+    // layout() does not ask the model whether the rows it creates have
+    // children; that is done once a row is painted or queried.
+    inline bool itemHasChildren(int i) const {
+        QTreeViewItem &item = viewItems[i];
+        if (item.pendingHasChildren) {
+            item.hasChildren = hasVisibleChildren(item.index);
+            item.pendingHasChildren = false;
+        }
+        return item.hasChildren;
+    }
 
     bool expandOrCollapseItemAtPos(const QPoint &pos);
 
@@ -173,7 +254,7 @@ public:
     QHeaderView *header;
     int indent;
 
-    mutable QList<QTreeViewItem> viewItems;
+    mutable QTreeViewItems viewItems;
     mutable int lastViewedItem;
     int defaultItemHeight; // this is just a number; contentsHeight() / numItems
     bool uniformRowHeights; // used when all rows have the same height
@@ -227,7 +308,7 @@ public:
     inline int below(int item) const
         { int i = item; while (isItemHiddenOrDisabled(++item)){} return item >= viewItems.size() ? i : item; }
     inline void invalidateHeightCache(int item) const
-        { viewItems[item].height = 0; }
+        { if (viewItems.isMaterialized(item)) viewItems[item].height = 0; }
 
     inline int accessibleTable2Index(const QModelIndex &index) const {
         return (viewIndex(index) + (header ? 1 : 0)) * model->columnCount()+index.column();